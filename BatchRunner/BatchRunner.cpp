@@ -0,0 +1,735 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <unordered_set>
+#include "../Core/stdafx.h"
+#include "../Core/BatchRunner.h"
+#include "../Core/CodeDataLogger.h"
+#include "../Core/Disassembler.h"
+#include "../Core/ExpressionEvaluator.h"
+#include "../Core/TraceLogFile.h"
+#include "../Core/TraceLogFormatter.h"
+#include "../Utilities/FolderUtilities.h"
+#include "../Utilities/PaletteExpander.h"
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/Timer.h"
+
+using std::string;
+using std::vector;
+
+static const vector<string> _movieExtensions = { ".mmo", ".bk2", ".fm2" };
+
+string FindMatchingMovie(string romFile)
+{
+	string folder = FolderUtilities::GetFolderName(romFile);
+	string name = FolderUtilities::GetFilename(romFile, false);
+	for(const string &extension : _movieExtensions) {
+		string movieFile = FolderUtilities::CombinePath(folder, name + extension);
+		if(std::ifstream(movieFile).good()) {
+			return movieFile;
+		}
+	}
+	return "";
+}
+
+struct RenderOptions
+{
+	string Folder;
+	VideoCodec Codec = VideoCodec::ZMBV;
+	uint32_t CompressionLevel = 6;
+};
+
+struct FilterBenchmarkOptions
+{
+	bool Enabled = false;
+	uint32_t Rotation = 0;
+};
+
+struct TraceOptions
+{
+	string Folder;
+	bool TextOutput = false;
+
+	//Binary to text conversion
+	string InputFile;
+	string OutputFile;
+	string Format = TraceLogFormatter::DefaultFormat;
+	uint64_t StartCycle = 0;
+	uint64_t EndCycle = UINT64_MAX;
+};
+
+struct CdlOptions
+{
+	string Folder;
+
+	//Merge mode: ROM, output file and CDL files to merge into it
+	string RomFile;
+	string OutputFile;
+	vector<string> InputFiles;
+};
+
+void AddJob(BatchRunner &runner, string filepath, uint32_t frameBudget, bool benchmark, bool batchPpu, RenderOptions &render, FilterBenchmarkOptions &filterBenchmark, TraceOptions &trace, CdlOptions &cdl, size_t &jobCount)
+{
+	BatchJob job;
+	job.RomFile = filepath;
+	job.FrameBudget = frameBudget;
+	job.BatchPpuRendering = batchPpu;
+	job.BenchmarkVideoFilters = filterBenchmark.Enabled;
+	job.ScreenRotation = filterBenchmark.Rotation;
+
+	if(!render.Folder.empty()) {
+		//Render the job's output to a video file with the same name as the rom/test
+		string extension = render.Codec == VideoCodec::GIF ? ".gif" : ".avi";
+		job.VideoFile = FolderUtilities::CombinePath(render.Folder, FolderUtilities::GetFilename(filepath, false) + extension);
+		job.Codec = render.Codec;
+		job.CompressionLevel = render.CompressionLevel;
+	}
+
+	if(!trace.Folder.empty()) {
+		job.TraceFile = FolderUtilities::CombinePath(trace.Folder, FolderUtilities::GetFilename(filepath, false) + (trace.TextOutput ? ".txt" : ".mtl"));
+	}
+
+	if(!cdl.Folder.empty()) {
+		job.CdlFile = FolderUtilities::CombinePath(cdl.Folder, FolderUtilities::GetFilename(filepath, false) + ".cdl");
+	}
+
+	string lcFilepath = filepath;
+	std::transform(lcFilepath.begin(), lcFilepath.end(), lcFilepath.begin(), ::tolower);
+	if(lcFilepath.size() < 4 || lcFilepath.substr(lcFilepath.size() - 4) != ".mtp") {
+		//Regular ROM, play back the movie with the same name, if there is one
+		job.MovieFile = FindMatchingMovie(filepath);
+	}
+
+	if(benchmark) {
+		//Run the job a first time with the memory access fast path, APU scheduling, PPU batching and batched audio mixing disabled, for comparison
+		BatchJob slowJob = job;
+		slowJob.BenchmarkVideoFilters = false;
+		slowJob.DisableMemoryFastPath = true;
+		slowJob.DisableApuScheduling = true;
+		slowJob.BatchPpuRendering = false;
+		slowJob.DisableBatchMixing = true;
+		slowJob.TraceFile.clear();
+		slowJob.CdlFile.clear();
+		runner.AddJob(slowJob);
+		jobCount++;
+	}
+
+	runner.AddJob(job);
+	jobCount++;
+}
+
+void PrintBenchmarkResults(vector<BatchJobResult> &results)
+{
+	std::cout << std::endl;
+	std::cout << "------------" << std::endl;
+	std::cout << "Benchmark (fps reference/optimized)" << std::endl;
+	std::cout << "------------" << std::endl;
+
+	double slowTime = 0;
+	double fastTime = 0;
+	for(size_t i = 0; i + 1 < results.size(); i += 2) {
+		BatchJobResult &slow = results[i];
+		BatchJobResult &fast = results[i + 1];
+		slowTime += slow.ElapsedMs;
+		fastTime += fast.ElapsedMs;
+
+		std::cout << fast.Name << ": " << std::fixed << std::setprecision(1) << slow.Fps << " -> " << fast.Fps << " fps";
+		if(slow.Fps > 0 && fast.Fps > 0) {
+			std::cout << " (x" << std::setprecision(2) << fast.Fps / slow.Fps << ", " << std::setprecision(3) << 1000 / slow.Fps - 1000 / fast.Fps << " ms/frame saved)";
+		}
+		if(slow.OutputHash != fast.OutputHash || slow.AudioHash != fast.AudioHash || slow.FrameCount != fast.FrameCount) {
+			std::cout << " - OUTPUT MISMATCH";
+		}
+		std::cout << std::endl;
+	}
+
+	if(fastTime > 0) {
+		std::cout << "Overall speedup: x" << std::fixed << std::setprecision(2) << slowTime / fastTime << std::endl;
+	}
+}
+
+void PrintFilterBenchmarkResults(vector<BatchJobResult> &results)
+{
+	//Average the results of all jobs, for each filter
+	vector<VideoFilterTiming> timings;
+	for(VideoFilterType filter : VideoFilterBenchmark::GetFilterTypes()) {
+		VideoFilterTiming timing;
+		timing.Filter = filter;
+		uint32_t jobCount = 0;
+		for(BatchJobResult &result : results) {
+			for(VideoFilterTiming &jobTiming : result.FilterTimings) {
+				if(jobTiming.Filter == filter) {
+					timing.AverageMs += jobTiming.AverageMs;
+					timing.MaxMs = std::max(timing.MaxMs, jobTiming.MaxMs);
+					jobCount++;
+				}
+			}
+		}
+		if(jobCount > 0) {
+			timing.AverageMs /= jobCount;
+			timings.push_back(timing);
+		}
+	}
+
+	if(timings.empty()) {
+		return;
+	}
+
+	//NTSC frame period
+	double framePeriod = 1000.0 / 60.098812;
+
+	std::cout << std::endl;
+	std::cout << "------------" << std::endl;
+	std::cout << "Video filter benchmark (decode time per frame, average/max)" << std::endl;
+	std::cout << "------------" << std::endl;
+	for(VideoFilterTiming &timing : timings) {
+		std::cout << std::left << std::setw(24) << VideoFilterBenchmark::GetFilterName(timing.Filter) << std::right;
+		std::cout << std::fixed << std::setprecision(3) << std::setw(9) << timing.AverageMs << " ms" << std::setw(9) << timing.MaxMs << " ms";
+		if(timing.AverageMs > framePeriod) {
+			std::cout << " - too slow for 60 fps";
+		}
+		std::cout << std::endl;
+	}
+
+	//Used by the video decoder to skip filters that are too slow for this machine (when the filter fallback option is enabled)
+	VideoFilterBenchmark::SaveResults(timings);
+}
+
+int ConvertTraceLog(TraceOptions &options)
+{
+	TraceLogFile traceLog;
+	if(!traceLog.Open(options.InputFile)) {
+		std::cout << "Invalid binary trace log: " << options.InputFile << std::endl;
+		return 1;
+	}
+
+	ofstream output(options.OutputFile, std::ios::out | std::ios::binary);
+	if(!output) {
+		std::cout << "Could not open output file: " << options.OutputFile << std::endl;
+		return 1;
+	}
+
+	//The opcode tables are normally built by the debugger
+	Disassembler::BuildOpCodeTables(false);
+
+	TraceLoggerOptions formatOptions = {};
+	formatOptions.ShowExtraInfo = true;
+	strncpy(formatOptions.Format, options.Format.c_str(), sizeof(formatOptions.Format) - 1);
+
+	//Labels are not stored in binary logs
+	TraceLogFormatter formatter(formatOptions, nullptr);
+
+	size_t recordCount = traceLog.GetRecordCount();
+	size_t start = traceLog.FindCycle(options.StartCycle);
+	size_t end = options.EndCycle == UINT64_MAX ? recordCount : traceLog.FindCycle(options.EndCycle + 1);
+
+	string buffer;
+	for(size_t i = start; i < end; i++) {
+		TraceLogRecord record = traceLog.GetRecord(i);
+		formatter.GetTraceRow(buffer, record);
+		if(buffer.size() > 65536) {
+			output << buffer;
+			buffer.clear();
+		}
+	}
+	output << buffer;
+
+	std::cout << "Converted " << (end - start) << " of " << recordCount << " records to " << options.OutputFile << std::endl;
+	return 0;
+}
+
+int BenchmarkExpressions(uint32_t iterations)
+{
+	//Typical breakpoint/trace logger conditions (labels and memory reads need a debugger, so they are not included)
+	vector<string> expressions = {
+		"a == $10 && x > 3",
+		"scanline == 100 || (cycle >= 250 && cycle <= 260)",
+		"(a & $80) != 0 && isread && address >= $2000 && address <= $2007",
+		"x + y * 2 == $40 || sp < $10",
+		"value == $FF && pc >= $8000 + $100 * 4",
+		"frame % 60 == 0 && !(pscarry || pszero)",
+		"irq || nmi || scanline / (x + 1) > 100",
+	};
+
+	//Pseudo-random CPU/PPU states and memory operations
+	vector<DebugState> states(1024);
+	vector<OperationInfo> operations(states.size());
+	uint32_t seed = 0x12345678;
+	auto nextRandom = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	};
+	for(size_t i = 0; i < states.size(); i++) {
+		DebugState state = {};
+		state.CPU.A = (uint8_t)nextRandom();
+		state.CPU.X = (uint8_t)nextRandom() & 0x0F;
+		state.CPU.Y = (uint8_t)nextRandom() & 0x1F;
+		state.CPU.SP = (uint8_t)nextRandom();
+		state.CPU.PS = (uint8_t)nextRandom();
+		state.CPU.PC = (uint16_t)nextRandom();
+		state.CPU.NMIFlag = (nextRandom() & 0x3F) == 0;
+		state.CPU.IRQFlag = (nextRandom() & 0x3F) == 0;
+		state.PPU.Scanline = (int32_t)(nextRandom() % 262) - 1;
+		state.PPU.Cycle = nextRandom() % 341;
+		state.PPU.FrameCount = nextRandom();
+		states[i] = state;
+
+		OperationInfo &operation = operations[i];
+		operation.Address = (nextRandom() & 1) ? 0x2000 + (nextRandom() & 0x0F) : (uint16_t)nextRandom();
+		operation.Value = (uint8_t)nextRandom();
+		operation.OperationType = (nextRandom() & 1) ? MemoryOperationType::Read : MemoryOperationType::Write;
+	}
+
+	ExpressionEvaluator evaluator(nullptr);
+	bool mismatch = false;
+	double totalRpnTime = 0;
+	double totalCompiledTime = 0;
+
+	std::cout << "Expression benchmark (" << iterations << " evaluations per expression, ms)" << std::endl;
+	std::cout << std::left << std::setw(68) << "Expression" << std::right << std::setw(10) << "RPN" << std::setw(10) << "Compiled" << std::setw(10) << "Speedup" << std::endl;
+	for(string &expression : expressions) {
+		bool success;
+		ExpressionData data = evaluator.GetRpnList(expression, success);
+		if(!success) {
+			std::cout << "Invalid expression: " << expression << std::endl;
+			return 1;
+		}
+
+		//Check that both versions return the same results before timing them
+		for(size_t i = 0; i < states.size(); i++) {
+			EvalResultType rpnType, compiledType;
+			int32_t rpnResult = evaluator.EvaluateRpn(data, states[i], rpnType, operations[i]);
+			int32_t compiledResult = evaluator.Evaluate(data, states[i], compiledType, operations[i]);
+			if(rpnResult != compiledResult || rpnType != compiledType) {
+				std::cout << "Result mismatch: " << expression << " (RPN: " << rpnResult << "/" << rpnType << ", compiled: " << compiledResult << "/" << compiledType << ")" << std::endl;
+				mismatch = true;
+				break;
+			}
+		}
+
+		EvalResultType resultType;
+		int64_t rpnSum = 0;
+		int64_t compiledSum = 0;
+		Timer timer;
+		for(uint32_t i = 0; i < iterations; i++) {
+			size_t index = i & (states.size() - 1);
+			rpnSum += evaluator.EvaluateRpn(data, states[index], resultType, operations[index]);
+		}
+		double rpnTime = timer.GetElapsedMS();
+
+		timer.Reset();
+		for(uint32_t i = 0; i < iterations; i++) {
+			size_t index = i & (states.size() - 1);
+			compiledSum += evaluator.Evaluate(data, states[index], resultType, operations[index]);
+		}
+		double compiledTime = timer.GetElapsedMS();
+
+		if(rpnSum != compiledSum) {
+			mismatch = true;
+		}
+
+		totalRpnTime += rpnTime;
+		totalCompiledTime += compiledTime;
+		std::cout << std::left << std::setw(68) << expression << std::right << std::fixed << std::setprecision(1);
+		std::cout << std::setw(10) << rpnTime << std::setw(10) << compiledTime << std::setw(9) << (rpnTime / compiledTime) << "x" << std::endl;
+	}
+
+	std::cout << std::left << std::setw(68) << "Total" << std::right << std::fixed << std::setprecision(1);
+	std::cout << std::setw(10) << totalRpnTime << std::setw(10) << totalCompiledTime << std::setw(9) << (totalRpnTime / totalCompiledTime) << "x" << std::endl;
+
+	if(mismatch) {
+		std::cout << "The compiled expressions' results do not match the RPN evaluation's results." << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+int BenchmarkPaletteExpansion(uint32_t frameCount)
+{
+	uint32_t seed = 0x12345678;
+	auto nextRandom = [&seed]() {
+		seed = seed * 1103515245 + 12345;
+		return seed >> 16;
+	};
+
+	//Pseudo-random palette, and its darkened copy for scanlines (same formula as DefaultVideoFilter's, 25% intensity)
+	//The output is also checked with a palette that has random alpha values (DefaultVideoFilter's palettes are opaque)
+	uint32_t palette[512];
+	uint32_t scanlinePalette[512];
+	uint32_t alphaPalette[512];
+	for(int i = 0; i < 512; i++) {
+		palette[i] = 0xFF000000 | ((nextRandom() << 16 | nextRandom()) & 0xFFFFFF);
+		alphaPalette[i] = nextRandom() << 16 | nextRandom();
+		uint8_t r = ((palette[i] >> 16) & 0xFF) * 0xBF / 255;
+		uint8_t g = ((palette[i] >> 8) & 0xFF) * 0xBF / 255;
+		uint8_t b = (palette[i] & 0xFF) * 0xBF / 255;
+		scanlinePalette[i] = 0xFF000000 | (r << 16) | (g << 8) | b;
+	}
+
+	//PPU frames: 8x8 tiles (half of them flat), random colors (no flat areas), and random colors + emphasis bits (worst case for the
+	//SIMD kernels, which fall back to scalar lookups when the emphasis bits change - on real frames, they change at most a few times per frame)
+	vector<string> frameNames = { "Tiles", "Random colors", "Random emphasis" };
+	vector<vector<uint16_t>> frames(frameNames.size(), vector<uint16_t>(256 * 240));
+	for(uint32_t tile = 0; tile < 32 * 30; tile++) {
+		bool flatTile = (nextRandom() & 1) != 0;
+		uint16_t colors[4] = { 0x0F, (uint16_t)(nextRandom() & 0x3F), (uint16_t)(nextRandom() & 0x3F), (uint16_t)(nextRandom() & 0x3F) };
+		for(uint32_t y = 0; y < 8; y++) {
+			for(uint32_t x = 0; x < 8; x++) {
+				frames[0][((tile / 32) * 8 + y) * 256 + (tile % 32) * 8 + x] = flatTile ? colors[0] : colors[nextRandom() & 0x03];
+			}
+		}
+	}
+	for(uint32_t i = 0; i < 256 * 240; i++) {
+		frames[1][i] = nextRandom() & 0x3F;
+		frames[2][i] = nextRandom() & 0x1FF;
+	}
+
+	//Decode the frames the same way DefaultVideoFilter does: 8 pixels of overscan cropped on each side, scanlines on every other row
+	auto decodeFrame = [](PaletteExpander &expander, PaletteExpander &scanlineExpander, uint16_t* ppuBuffer, uint32_t* out) {
+		for(uint32_t i = 8; i < 232; i++) {
+			PaletteExpander &rowExpander = (i & 0x01) ? expander : scanlineExpander;
+			rowExpander.ExpandRow(ppuBuffer + i * 256 + 8, out, 240);
+			out += 240;
+		}
+	};
+
+	PaletteExpander expander;
+	PaletteExpander scanlineExpander;
+	PaletteExpander alphaExpander;
+	expander.SetPalette(palette);
+	scanlineExpander.SetPalette(scanlinePalette);
+	alphaExpander.SetPalette(alphaPalette);
+
+	vector<PaletteExpander::Kernel> kernels;
+	for(PaletteExpander::Kernel kernel : { PaletteExpander::Kernel::Scalar, PaletteExpander::Kernel::Ssse3, PaletteExpander::Kernel::Avx2 }) {
+		if(PaletteExpander::IsSupported(kernel)) {
+			kernels.push_back(kernel);
+		}
+	}
+
+	std::cout << "Palette expansion benchmark (" << frameCount << " frames of 240x224 pixels per frame type, best of 5 runs, ms)" << std::endl;
+	std::cout << std::left << std::setw(20) << "Frames" << std::right;
+	for(PaletteExpander::Kernel kernel : kernels) {
+		std::cout << std::setw(kernel == PaletteExpander::Kernel::Scalar ? 10 : 18) << PaletteExpander::GetKernelName(kernel);
+	}
+	std::cout << std::endl;
+
+	bool mismatch = false;
+	vector<uint32_t> reference(240 * 224);
+	vector<uint32_t> alphaReference(240 * 224);
+	vector<uint32_t> output(240 * 224);
+	vector<uint32_t> alphaOutput(240 * 224);
+	for(size_t i = 0; i < frames.size(); i++) {
+		std::cout << std::left << std::setw(20) << frameNames[i] << std::right << std::fixed << std::setprecision(1);
+
+		double scalarTime = 0;
+		for(PaletteExpander::Kernel kernel : kernels) {
+			expander.SetKernel(kernel);
+			scanlineExpander.SetKernel(kernel);
+			alphaExpander.SetKernel(kernel);
+
+			//Check that the output is identical to the scalar kernel's before timing it
+			decodeFrame(expander, scanlineExpander, frames[i].data(), output.data());
+			decodeFrame(alphaExpander, scanlineExpander, frames[i].data(), alphaOutput.data());
+			if(kernel == PaletteExpander::Kernel::Scalar) {
+				reference = output;
+				alphaReference = alphaOutput;
+			} else if(reference != output || alphaReference != alphaOutput) {
+				std::cout << std::endl << PaletteExpander::GetKernelName(kernel) << " output does not match the scalar kernel's output (" << frameNames[i] << ")" << std::endl;
+				mismatch = true;
+			}
+
+			//Best of 5 runs, to filter out the noise from other processes
+			double time = 0;
+			for(int run = 0; run < 5; run++) {
+				Timer timer;
+				for(uint32_t frame = 0; frame < frameCount; frame++) {
+					decodeFrame(expander, scanlineExpander, frames[i].data(), output.data());
+				}
+				double runTime = timer.GetElapsedMS();
+				time = run == 0 ? runTime : std::min(time, runTime);
+			}
+			if(kernel == PaletteExpander::Kernel::Scalar) {
+				scalarTime = time;
+				std::cout << std::setw(10) << time;
+			} else {
+				std::stringstream speedup;
+				speedup << std::fixed << std::setprecision(1) << time << " (" << std::setprecision(2) << scalarTime / time << "x)";
+				std::cout << std::setw(18) << speedup.str();
+			}
+		}
+		std::cout << std::endl;
+	}
+
+	if(mismatch) {
+		std::cout << "The SIMD kernels' output does not match the scalar kernel's output." << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+int MergeCdlFiles(CdlOptions &options)
+{
+	CdlMergeResult result;
+	if(!BatchRunner::MergeCdlFiles(options.RomFile, options.OutputFile, options.InputFiles, result)) {
+		std::cout << "Could not load ROM: " << options.RomFile << std::endl;
+		return 1;
+	}
+
+	if(result.OutputRejected) {
+		std::cout << "Could not open " << options.OutputFile << " (CDL file for a different ROM) - the file was not modified" << std::endl;
+		return 1;
+	}
+
+	for(string &file : result.FailedFiles) {
+		std::cout << "Could not merge " << file << " (missing file, or CDL file for a different ROM)" << std::endl;
+	}
+
+	std::cout << "Merged " << options.InputFiles.size() - result.FailedFiles.size() << " of " << options.InputFiles.size() << " CDL files into " << options.OutputFile << std::endl;
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << "PRG: " << result.Ratios.PrgRatio * 100 << "% (code: " << result.Ratios.CodeRatio * 100 << "%, data: " << result.Ratios.DataRatio * 100 << "%)";
+	if(result.Ratios.ChrRatio >= 0) {
+		std::cout << ", CHR: " << result.Ratios.ChrRatio * 100 << "%";
+	}
+	std::cout << std::endl;
+
+	std::cout << "------------" << std::endl;
+	std::cout << "PRG banks (" << CodeDataLogger::PrgBankSize / 1024 << " KB, code/data/unused)" << std::endl;
+	std::cout << "------------" << std::endl;
+	for(size_t i = 0; i < result.PrgBankStats.size(); i++) {
+		CdlBankStats &bank = result.PrgBankStats[i];
+		uint32_t unused = CodeDataLogger::PrgBankSize - bank.CodeSize - bank.DataSize;
+		std::cout << "$" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << i << std::dec << std::setfill(' ') << ": ";
+		std::cout << bank.CodeSize * 100.0 / CodeDataLogger::PrgBankSize << "% / " << bank.DataSize * 100.0 / CodeDataLogger::PrgBankSize << "% / " << unused * 100.0 / CodeDataLogger::PrgBankSize << "%" << std::endl;
+	}
+
+	return result.FailedFiles.empty() ? 0 : 1;
+}
+
+void PrintUsage()
+{
+	std::cout << "Usage: batchrunner [-threads N] [-frames N] [-home folder] [-benchmark] [-batchppu] [-render folder [-codec name] [-compression N]] [-filterbenchmark [-rotation N]] [-trace folder [-tracetext]] [-cdl folder] <file or folder> [...]" << std::endl;
+	std::cout << "       batchrunner -traceconvert input.mtl output.txt [-traceformat format] [-fromcycle N] [-tocycle N]" << std::endl;
+	std::cout << "       batchrunner -exprbenchmark [N]" << std::endl;
+	std::cout << "       batchrunner -palettebenchmark [N]" << std::endl;
+	std::cout << "       batchrunner -cdlmerge rom output.cdl input.cdl [...]" << std::endl;
+	std::cout << "  .mtp files are run as recorded tests (pass/fail)" << std::endl;
+	std::cout << "  .nsf/.nsfe files play their default track, with every expansion audio chip listed in their header - use -benchmark on them to compare audio mixing speeds" << std::endl;
+	std::cout << "  Other ROMs play back the movie with the same name (.mmo/.bk2/.fm2) if one exists, and report an output hash" << std::endl;
+	std::cout << "  -threads N: number of emulation workers (default: number of cores)" << std::endl;
+	std::cout << "  -frames N: frame budget for each job (default: until the movie/test ends, or 3600 frames for ROMs without a movie)" << std::endl;
+	std::cout << "  -benchmark: run each job a second time without the CPU memory access fast path/APU scheduling/PPU batching/batched audio mixing and compare speeds and output (default: 1 thread)" << std::endl;
+	std::cout << "  -batchppu: run the PPU in scanline-sized batches (compare with -benchmark to check that the output is identical)" << std::endl;
+	std::cout << "  -render folder: render each job to a video file in the given folder, as fast as possible (no frames are dropped)" << std::endl;
+	std::cout << "  -codec name: video codec used by -render: zmbv (default), cscd, gif or none (uncompressed)" << std::endl;
+	std::cout << "  -compression N: compression level used by -render (1 to 9, default: 6)" << std::endl;
+	std::cout << "  -filterbenchmark: measure the decode time of every video filter on frames sampled from each job, and save the results in the home folder for this machine (default: 1 thread)" << std::endl;
+	std::cout << "  -rotation N: screen rotation used by -filterbenchmark (0, 90, 180 or 270)" << std::endl;
+	std::cout << "  -trace folder: log every instruction executed by each job to a binary trace log (.mtl) in the given folder" << std::endl;
+	std::cout << "  -tracetext: write the trace logs as text instead (formatted like the debugger's trace logger)" << std::endl;
+	std::cout << "  -traceconvert: convert a binary trace log to text, optionally only the instructions executed between the given CPU cycles" << std::endl;
+	std::cout << "  -traceformat format: row format used by -traceconvert, same syntax as the trace logger's (default: \"" << TraceLogFormatter::DefaultFormat << "\")" << std::endl;
+	std::cout << "  -cdl folder: record the code/data log of each job to a CDL file in the given folder (flags from previous runs are kept, so runs accumulate)" << std::endl;
+	std::cout << "  -cdlmerge: merge CDL files recorded for the same ROM into the output file, and print the PRG coverage of each bank" << std::endl;
+	std::cout << "  -exprbenchmark [N]: compare the speed of the compiled breakpoint conditions with the RPN evaluation, over N evaluations per condition (default: 10000000)" << std::endl;
+	std::cout << "  -palettebenchmark [N]: compare the speed and output of the palette expansion kernels (scalar/SSSE3/AVX2) used by the default video filter, over N frames of each type (default: 2000)" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t workerCount = 0;
+	uint32_t frameBudget = 0;
+	string homeFolder = "BatchRunnerHome";
+	bool benchmark = false;
+	bool batchPpu = false;
+	RenderOptions render;
+	FilterBenchmarkOptions filterBenchmark;
+	TraceOptions trace;
+	CdlOptions cdl;
+	uint32_t exprBenchmarkIterations = 0;
+	uint32_t paletteBenchmarkFrames = 0;
+	vector<string> inputs;
+
+	for(int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if(arg == "-threads" && i + 1 < argc) {
+			workerCount = (uint32_t)std::stoul(argv[++i]);
+		} else if(arg == "-frames" && i + 1 < argc) {
+			frameBudget = (uint32_t)std::stoul(argv[++i]);
+		} else if(arg == "-home" && i + 1 < argc) {
+			homeFolder = argv[++i];
+		} else if(arg == "-benchmark") {
+			benchmark = true;
+		} else if(arg == "-batchppu") {
+			batchPpu = true;
+		} else if(arg == "-render" && i + 1 < argc) {
+			render.Folder = argv[++i];
+		} else if(arg == "-codec" && i + 1 < argc) {
+			string codec = argv[++i];
+			if(codec == "cscd") {
+				render.Codec = VideoCodec::CSCD;
+			} else if(codec == "gif") {
+				render.Codec = VideoCodec::GIF;
+			} else if(codec == "none") {
+				render.Codec = VideoCodec::None;
+			} else if(codec == "zmbv") {
+				render.Codec = VideoCodec::ZMBV;
+			} else {
+				std::cout << "Unknown codec: " << codec << " (valid codecs: zmbv, cscd, gif, none)" << std::endl;
+				return 1;
+			}
+		} else if(arg == "-compression" && i + 1 < argc) {
+			render.CompressionLevel = std::max(1u, std::min(9u, (uint32_t)std::stoul(argv[++i])));
+		} else if(arg == "-filterbenchmark") {
+			filterBenchmark.Enabled = true;
+		} else if(arg == "-rotation" && i + 1 < argc) {
+			filterBenchmark.Rotation = (uint32_t)std::stoul(argv[++i]) % 360 / 90 * 90;
+		} else if(arg == "-trace" && i + 1 < argc) {
+			trace.Folder = argv[++i];
+		} else if(arg == "-tracetext") {
+			trace.TextOutput = true;
+		} else if(arg == "-traceconvert" && i + 2 < argc) {
+			trace.InputFile = argv[++i];
+			trace.OutputFile = argv[++i];
+		} else if(arg == "-traceformat" && i + 1 < argc) {
+			trace.Format = argv[++i];
+		} else if(arg == "-fromcycle" && i + 1 < argc) {
+			trace.StartCycle = std::stoull(argv[++i]);
+		} else if(arg == "-tocycle" && i + 1 < argc) {
+			trace.EndCycle = std::stoull(argv[++i]);
+		} else if(arg == "-cdl" && i + 1 < argc) {
+			cdl.Folder = argv[++i];
+		} else if(arg == "-cdlmerge" && i + 3 < argc) {
+			cdl.RomFile = argv[++i];
+			cdl.OutputFile = argv[++i];
+			while(i + 1 < argc) {
+				cdl.InputFiles.push_back(argv[++i]);
+			}
+		} else if(arg == "-exprbenchmark") {
+			exprBenchmarkIterations = 10000000;
+			if(i + 1 < argc && std::isdigit(argv[i + 1][0])) {
+				exprBenchmarkIterations = (uint32_t)std::stoul(argv[++i]);
+			}
+		} else if(arg == "-palettebenchmark") {
+			paletteBenchmarkFrames = 2000;
+			if(i + 1 < argc && std::isdigit(argv[i + 1][0])) {
+				paletteBenchmarkFrames = (uint32_t)std::stoul(argv[++i]);
+			}
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+
+	if(!trace.InputFile.empty()) {
+		return ConvertTraceLog(trace);
+	}
+
+	if(exprBenchmarkIterations > 0) {
+		return BenchmarkExpressions(exprBenchmarkIterations);
+	}
+
+	if(paletteBenchmarkFrames > 0) {
+		return BenchmarkPaletteExpansion(paletteBenchmarkFrames);
+	}
+
+	if(!cdl.OutputFile.empty()) {
+		FolderUtilities::SetHomeFolder(homeFolder);
+		return MergeCdlFiles(cdl);
+	}
+
+	if(inputs.empty()) {
+		PrintUsage();
+		return 0;
+	}
+
+	FolderUtilities::SetHomeFolder(homeFolder);
+	if(!render.Folder.empty()) {
+		FolderUtilities::CreateFolder(render.Folder);
+	}
+	if(!trace.Folder.empty()) {
+		FolderUtilities::CreateFolder(trace.Folder);
+	}
+	if(!cdl.Folder.empty()) {
+		FolderUtilities::CreateFolder(cdl.Folder);
+	}
+
+	if((benchmark || filterBenchmark.Enabled) && workerCount == 0) {
+		//Run jobs one at a time to get comparable timings
+		workerCount = 1;
+	}
+
+	BatchRunner runner;
+	size_t jobCount = 0;
+	for(string &input : inputs) {
+		vector<string> files = FolderUtilities::GetFilesInFolder(input, { ".mtp", ".nes", ".fds", ".unf", ".unif", ".nsf", ".nsfe" }, true);
+		if(files.empty()) {
+			AddJob(runner, input, frameBudget, benchmark, batchPpu, render, filterBenchmark, trace, cdl, jobCount);
+		} else {
+			for(string &file : files) {
+				AddJob(runner, file, frameBudget, benchmark, batchPpu, render, filterBenchmark, trace, cdl, jobCount);
+			}
+		}
+	}
+
+	SimpleLock outputLock;
+	size_t doneCount = 0;
+	Timer timer;
+	vector<BatchJobResult> results = runner.Run(workerCount, [&](const BatchJobResult &result) {
+		auto lock = outputLock.AcquireSafe();
+		doneCount++;
+		std::cout << "[" << doneCount << "/" << jobCount << "] " << result.Name << ": ";
+		std::cout << (result.Passed ? "OK" : "FAILED (" + std::to_string(result.ErrorCode) + ")");
+		std::cout << " - " << result.FrameCount << " frames, " << std::fixed << std::setprecision(1) << result.Fps << " fps";
+		if(!result.OutputHash.empty()) {
+			std::cout << ", hash: " << result.OutputHash;
+		}
+		if(!result.AudioHash.empty()) {
+			std::cout << ", audio: " << result.AudioHash;
+		}
+		if(result.VideoFrameCount > 0) {
+			std::cout << ", " << result.VideoFrameCount << " frames rendered to video";
+		}
+		if(result.CdlPrgRatio >= 0) {
+			std::cout << ", PRG coverage: " << result.CdlPrgRatio * 100 << "%";
+		}
+		std::cout << std::endl;
+	});
+	double elapsedSeconds = timer.GetElapsedMS() / 1000;
+
+	uint64_t totalFrames = 0;
+	vector<BatchJobResult> failedJobs;
+	for(BatchJobResult &result : results) {
+		totalFrames += result.FrameCount;
+		if(!result.Passed) {
+			failedJobs.push_back(result);
+		}
+	}
+
+	if(benchmark) {
+		PrintBenchmarkResults(results);
+	}
+
+	if(filterBenchmark.Enabled) {
+		PrintFilterBenchmarkResults(results);
+	}
+
+	std::cout << std::endl;
+	if(!failedJobs.empty()) {
+		std::cout << "------------" << std::endl;
+		std::cout << "Failed jobs" << std::endl;
+		std::cout << "------------" << std::endl;
+		for(BatchJobResult &result : failedJobs) {
+			std::cout << result.Name << " (" << result.ErrorCode << ")" << std::endl;
+		}
+		std::cout << std::endl << failedJobs.size() << " of " << results.size() << " jobs failed." << std::endl;
+	} else {
+		std::cout << "All " << results.size() << " jobs passed." << std::endl;
+	}
+
+	std::cout << "Elapsed time: " << std::fixed << std::setprecision(1) << elapsedSeconds << " seconds, ";
+	std::cout << totalFrames << " frames (" << (elapsedSeconds > 0 ? totalFrames / elapsedSeconds : 0) << " fps overall)" << std::endl;
+
+	return (int)std::min<size_t>(failedJobs.size(), 255);
+}
@@ -15,6 +15,8 @@ APU::APU(shared_ptr<Console> console)
 	_nesModel = NesModel::Auto;
 	_apuEnabled = true;
 	_needToRun = false;
+	_nextRunCycle = 0;
+	_runSchedulingDisabled = false;
 
 	_console = console;
 	_mixer = _console->GetSoundMixer();
@@ -162,11 +164,33 @@ void APU::Run()
 		_triangleChannel->Run(_previousCycle);
 		_deltaModulationChannel->Run(_previousCycle);
 	}
+
+	//Register writes always run the APU before changing its state, recalculate the next deadline on the next cycle
+	_nextRunCycle = 0;
 }
 
 void APU::SetNeedToRun()
 {
 	_needToRun = true;
+	_nextRunCycle = 0;
+}
+
+void APU::DisableRunScheduling(bool disabled)
+{
+	_runSchedulingDisabled = disabled;
+	_nextRunCycle = 0;
+}
+
+void APU::UpdateNextRunCycle()
+{
+	if(_needToRun || _runSchedulingDisabled) {
+		_nextRunCycle = 0;
+		return;
+	}
+
+	//Both deadlines are relative to _previousCycle (all channels and the frame counter are in sync with it after each run)
+	uint32_t deadline = std::min(_frameCounter->GetRunDeadline(), _deltaModulationChannel->GetRunDeadline());
+	_nextRunCycle = _previousCycle + std::min<uint32_t>(deadline, SoundMixer::CycleLength);
 }
 
 bool APU::NeedToRun(uint32_t currentCycle)
@@ -187,8 +211,11 @@ void APU::Exec()
 	_currentCycle++;
 	if(_currentCycle == SoundMixer::CycleLength - 1) {
 		EndFrame();
-	} else if(NeedToRun(_currentCycle)) {
-		Run();
+	} else if(_currentCycle >= _nextRunCycle) {
+		if(NeedToRun(_currentCycle)) {
+			Run();
+		}
+		UpdateNextRunCycle();
 	}
 }
 
@@ -219,6 +246,7 @@ void APU::Reset(bool softReset)
 	_apuEnabled = true;
 	_currentCycle = 0;
 	_previousCycle = 0;
+	_nextRunCycle = 0;
 	_squareChannel[0]->Reset(softReset);
 	_squareChannel[1]->Reset(softReset);
 	_triangleChannel->Reset(softReset);
@@ -235,6 +263,7 @@ void APU::StreamState(bool saving)
 	} else {
 		_previousCycle = 0;
 		_currentCycle = 0;
+		_nextRunCycle = 0;
 	}
 
 	SnapshotInfo squareChannel0{ _squareChannel[0].get() };
@@ -273,6 +302,8 @@ uint16_t APU::GetDmcReadAddress()
 
 void APU::SetDmcReadBuffer(uint8_t value)
 {
+	//Catch up first - the DMC may have emptied its output buffer while the DMA was in progress
+	Run();
 	_deltaModulationChannel->SetDmcReadBuffer(value);
 }
 
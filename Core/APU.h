@@ -28,6 +28,10 @@ class APU : public Snapshotable, public IMemoryHandler
 		uint32_t _previousCycle;
 		uint32_t _currentCycle;
 
+		//The APU only checks if it needs to run once this cycle is reached (frame counter step, DMC transfer/IRQ) - 0 when it must check on every cycle
+		uint32_t _nextRunCycle;
+		bool _runSchedulingDisabled;
+
 		unique_ptr<SquareChannel> _squareChannel[2];
 		unique_ptr<TriangleChannel> _triangleChannel;
 		unique_ptr<NoiseChannel> _noiseChannel;
@@ -42,6 +46,7 @@ class APU : public Snapshotable, public IMemoryHandler
 
 	private:
 		__forceinline bool NeedToRun(uint32_t currentCycle);
+		void UpdateNextRunCycle();
 
 		void FrameCounterTick(FrameType type);
 		uint8_t GetStatus();
@@ -74,4 +79,7 @@ class APU : public Snapshotable, public IMemoryHandler
 		uint16_t GetDmcReadAddress();
 		void SetDmcReadBuffer(uint8_t value);
 		void SetNeedToRun();
+
+		//Checks if the APU needs to run on every cycle, like the scheduling above was not there (used by benchmarks)
+		void DisableRunScheduling(bool disabled);
 };
\ No newline at end of file
@@ -167,6 +167,15 @@ public:
 		return _newValue >= 0 || _blockFrameCounterTick > 0 || (_previousCycle + (int32_t)cyclesToRun >= _stepCycles[_stepMode][_currentStep] - 1);
 	}
 
+	//Returns the smallest number of cycles for which NeedToRun returns true (0 = NeedToRun must be checked on every cycle)
+	uint32_t GetRunDeadline()
+	{
+		if(_newValue >= 0 || _blockFrameCounterTick > 0) {
+			return 0;
+		}
+		return (uint32_t)std::max(0, _stepCycles[_stepMode][_currentStep] - 1 - _previousCycle);
+	}
+
 	void GetMemoryRanges(MemoryRanges &ranges) override
 	{
 		ranges.AddHandler(MemoryOperation::Write, 0x4017);
@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "AudioPostProcessor.h"
+
+AudioPostProcessor::AudioPostProcessor(uint32_t bufferSize)
+{
+	for(AudioFrame& frame : _frames) {
+		frame.Samples.resize(bufferSize);
+		frame.ExtraSamples.resize(bufferSize);
+	}
+	_workerBusy = false;
+	_stopFlag = false;
+}
+
+AudioPostProcessor::~AudioPostProcessor()
+{
+	if(_workerThread.joinable()) {
+		WaitForWorker();
+		_stopFlag = true;
+		_startEvent.Signal();
+		_workerThread.join();
+	}
+}
+
+AudioFrame& AudioPostProcessor::GetInputFrame()
+{
+	return _frames[_inputIndex];
+}
+
+uint32_t AudioPostProcessor::ProcessFrame(bool useWorker, AudioFrame* readyFrames[2])
+{
+	//The frame sent on the previous call is usually done by now, since the worker had a whole frame to process it
+	WaitForWorker();
+
+	uint32_t readyCount = 0;
+	AudioFrame& frame = _frames[_inputIndex];
+	AudioFrame& pendingFrame = _frames[_inputIndex ^ 1];
+	if(_hasPendingFrame) {
+		readyFrames[readyCount++] = &pendingFrame;
+	}
+
+	if(useWorker) {
+		if(!_workerThread.joinable()) {
+			_workerThread = std::thread(&AudioPostProcessor::WorkerThread, this);
+		}
+
+		_workerFrame = &frame;
+		_workerBusy = true;
+		_startEvent.Signal();
+		_hasPendingFrame = true;
+
+		//The pending frame is played while the worker processes this frame, and is reused as the input for the next frame
+		_inputIndex ^= 1;
+	} else {
+		ApplyEffects(frame);
+		readyFrames[readyCount++] = &frame;
+		_hasPendingFrame = false;
+	}
+
+	return readyCount;
+}
+
+void AudioPostProcessor::WorkerThread()
+{
+	while(true) {
+		_startEvent.Wait();
+		if(_stopFlag) {
+			break;
+		}
+
+		ApplyEffects(*_workerFrame);
+
+		_workerBusy = false;
+		_doneEvent.Signal();
+	}
+}
+
+void AudioPostProcessor::WaitForWorker()
+{
+	while(_workerBusy) {
+		_doneEvent.Wait();
+	}
+}
+
+bool AudioPostProcessor::IsEqualizerEnabled()
+{
+	return _equalizer.IsEnabled();
+}
+
+void AudioPostProcessor::SetEqualizer(orfanidis_eq::eq1* equalizer, bool gainsOnly)
+{
+	WaitForWorker();
+	if(gainsOnly) {
+		_equalizer.SetBandGains(equalizer);
+	} else {
+		_equalizer.SetFilters(equalizer);
+	}
+}
+
+void AudioPostProcessor::ApplyEffects(AudioFrame& frame)
+{
+	int16_t* samples = frame.Samples.data();
+	size_t sampleCount = frame.SampleCount;
+	AudioEffectSettings& settings = frame.Settings;
+
+	_equalizer.ApplyFilter(samples, sampleCount, settings.Stereo);
+
+	if(!settings.Stereo) {
+		//Copy left channel to right channel (optimization - when no panning is used)
+		for(size_t i = 0; i < sampleCount * 2; i += 2) {
+			samples[i + 1] = samples[i];
+		}
+	}
+
+	int16_t* extraSamples = frame.ExtraSamples.data();
+	for(size_t i = 0; i < sampleCount * 2; i++) {
+		samples[i] += extraSamples[i];
+	}
+
+	if(settings.Volume != 1.0) {
+		_lowPassFilter.ApplyFilter(samples, sampleCount, 0, settings.Volume);
+	}
+
+	AudioFilterSettings& filterSettings = settings.Filters;
+	if(filterSettings.ReverbStrength > 0) {
+		_reverbFilter.ApplyFilter(samples, sampleCount, settings.SampleRate, filterSettings.ReverbStrength, filterSettings.ReverbDelay);
+	} else {
+		_reverbFilter.ResetFilter();
+	}
+
+	switch(filterSettings.Filter) {
+		case StereoFilter::None: break;
+		case StereoFilter::Delay: _stereoDelay.ApplyFilter(samples, sampleCount, settings.SampleRate, filterSettings.Delay); break;
+		case StereoFilter::Panning: _stereoPanning.ApplyFilter(samples, sampleCount, filterSettings.Angle); break;
+		case StereoFilter::CombFilter: _stereoCombFilter.ApplyFilter(samples, sampleCount, settings.SampleRate, filterSettings.Delay, filterSettings.Strength); break;
+	}
+
+	if(filterSettings.CrossFadeRatio > 0) {
+		_crossFeedFilter.ApplyFilter(samples, sampleCount, filterSettings.CrossFadeRatio);
+	}
+}
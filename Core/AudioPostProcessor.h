@@ -0,0 +1,93 @@
+#pragma once
+#include "stdafx.h"
+#include <thread>
+#include "EmulationSettings.h"
+#include "../Utilities/LowPassFilter.h"
+#include "../Utilities/AutoResetEvent.h"
+#include "EqualizerFilter.h"
+#include "StereoPanningFilter.h"
+#include "StereoDelayFilter.h"
+#include "StereoCombFilter.h"
+#include "ReverbFilter.h"
+#include "CrossFeedFilter.h"
+
+namespace orfanidis_eq {
+	class eq1;
+}
+
+//Settings captured on the emulation thread when the frame is mixed
+struct AudioEffectSettings
+{
+	uint32_t SampleRate = 0;
+
+	//When false, only the left channel was mixed (it is copied to the right channel after the equalizer)
+	bool Stereo = false;
+
+	//Volume reduction (e.g when muted, fast forwarding or in the background)
+	double Volume = 1.0;
+
+	AudioFilterSettings Filters;
+
+	bool HasEffects()
+	{
+		return Filters.ReverbStrength > 0 || Filters.Filter != StereoFilter::None || Filters.CrossFadeRatio > 0;
+	}
+};
+
+struct AudioFrame
+{
+	vector<int16_t> Samples;
+
+	//Samples that are added to the output after the equalizer (e.g mapper audio and HD pack music)
+	vector<int16_t> ExtraSamples;
+
+	size_t SampleCount = 0;
+	bool IsRunAheadFrame = false;
+	AudioEffectSettings Settings;
+};
+
+//Applies the equalizer and audio effects to each frame's audio, either directly on the emulation thread,
+//or on a worker thread while the emulation thread runs the next frame (which delays the output by a frame)
+class AudioPostProcessor
+{
+private:
+	AudioFrame _frames[2];
+	uint32_t _inputIndex = 0;
+	bool _hasPendingFrame = false;
+
+	std::thread _workerThread;
+	AudioFrame* _workerFrame = nullptr;
+	AutoResetEvent _startEvent;
+	AutoResetEvent _doneEvent;
+	atomic<bool> _workerBusy;
+	atomic<bool> _stopFlag;
+
+	EqualizerFilter _equalizer;
+	LowPassFilter _lowPassFilter;
+	StereoPanningFilter _stereoPanning;
+	StereoDelayFilter _stereoDelay;
+	StereoCombFilter _stereoCombFilter;
+	ReverbFilter _reverbFilter;
+	CrossFeedFilter _crossFeedFilter;
+
+	void WorkerThread();
+	void ApplyEffects(AudioFrame& frame);
+
+public:
+	AudioPostProcessor(uint32_t bufferSize);
+	~AudioPostProcessor();
+
+	//The frame the emulation thread mixes the next frame's audio into
+	AudioFrame& GetInputFrame();
+
+	//Processes the input frame - on the worker thread (when useWorker is true) or immediately.
+	//Returns the number of frames that are ready to be played, in order: frames processed by the worker are returned by the next call
+	uint32_t ProcessFrame(bool useWorker, AudioFrame* readyFrames[2]);
+
+	bool IsEqualizerEnabled();
+
+	//Updates the equalizer's filters (or disables it when equalizer is null), or only its band gains
+	void SetEqualizer(orfanidis_eq::eq1* equalizer, bool gainsOnly);
+
+	void WaitForWorker();
+};
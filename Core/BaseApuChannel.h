@@ -25,6 +25,10 @@ protected:
 		return _channel;
 	}
 
+	//Channels can advance their state by several clocks at once when doing so has no effect on their output
+	//Returns false when the clocks must be run one by one
+	virtual bool SkipClocks(uint32_t clockCount) { return false; }
+
 public:
 	virtual void Clock() = 0;
 	virtual bool GetStatus() = 0;
@@ -78,6 +82,15 @@ public:
 	void Run(uint32_t targetCycle)
 	{
 		int32_t cyclesToRun = targetCycle - _previousCycle;
+		if(cyclesToRun > _timer) {
+			//The timer clocks the channel after _timer + 1 cycles, and then every _period + 1 cycles
+			uint32_t clockCount = (cyclesToRun - _timer - 1) / (_period + 1) + 1;
+			if(clockCount > 1 && SkipClocks(clockCount)) {
+				cyclesToRun -= _timer + 1 + (clockCount - 1) * (_period + 1);
+				_timer = _period;
+			}
+		}
+
 		while(cyclesToRun > _timer) {
 			cyclesToRun -= _timer + 1;
 			_previousCycle += _timer + 1;
@@ -153,6 +153,17 @@ void BaseMapper::SetCpuMemoryMapping(uint16_t startAddr, uint16_t endAddr, uint8
 
 		source += 0x100;
 	}
+
+	UpdatePrgDirectReadPages(startAddr, endAddr);
+}
+
+void BaseMapper::UpdatePrgDirectReadPages(uint16_t startPage, uint16_t endPage)
+{
+	bool allowDirectRead = AllowDirectPrgRead();
+	for(uint16_t i = startPage; i <= endPage; i++) {
+		bool directRead = allowDirectRead && _prgPages[i] && (_prgMemoryAccess[i] & MemoryAccessType::Read) && !(_allowRegisterRead && _hasReadRegister[i]);
+		_prgDirectReadPages[i] = directRead ? _prgPages[i] : nullptr;
+	}
 }
 
 void BaseMapper::RemoveCpuMemoryMapping(uint16_t startAddr, uint16_t endAddr)
@@ -478,6 +489,12 @@ void BaseMapper::AddRegisterRange(uint16_t startAddr, uint16_t endAddr, MemoryOp
 			_isWriteRegisterAddr[i] = true;
 		}
 	}
+	if((int)operation & (int)MemoryOperation::Read) {
+		for(int i = startAddr >> 8; i <= endAddr >> 8; i++) {
+			_hasReadRegister[i] = true;
+		}
+		UpdatePrgDirectReadPages(startAddr >> 8, endAddr >> 8);
+	}
 }
 
 void BaseMapper::RemoveRegisterRange(uint16_t startAddr, uint16_t endAddr, MemoryOperation operation)
@@ -490,6 +507,19 @@ void BaseMapper::RemoveRegisterRange(uint16_t startAddr, uint16_t endAddr, Memor
 			_isWriteRegisterAddr[i] = false;
 		}
 	}
+	if((int)operation & (int)MemoryOperation::Read) {
+		for(int i = startAddr >> 8; i <= endAddr >> 8; i++) {
+			//The rest of the page may still contain registers
+			_hasReadRegister[i] = false;
+			for(int j = i << 8, end = j + 0x100; j < end; j++) {
+				if(_isReadRegisterAddr[j]) {
+					_hasReadRegister[i] = true;
+					break;
+				}
+			}
+		}
+		UpdatePrgDirectReadPages(startAddr >> 8, endAddr >> 8);
+	}
 }
 
 void BaseMapper::StreamState(bool saving)
@@ -559,6 +589,9 @@ void BaseMapper::Initialize(RomData &romData)
 
 	memset(_isReadRegisterAddr, 0, sizeof(_isReadRegisterAddr));
 	memset(_isWriteRegisterAddr, 0, sizeof(_isWriteRegisterAddr));
+	memset(_hasReadRegister, 0, sizeof(_hasReadRegister));
+	memset(_prgPages, 0, sizeof(_prgPages));
+	memset(_prgDirectReadPages, 0, sizeof(_prgDirectReadPages));
 	AddRegisterRange(RegisterStartAddress(), RegisterEndAddress(), MemoryOperation::Any);
 
 	_prgSize = (uint32_t)romData.PrgRom.size();
@@ -598,6 +631,7 @@ void BaseMapper::Initialize(RomData &romData)
 	for(int i = 0; i < 0x100; i++) {
 		//Allow us to map a different page every 256 bytes
 		_prgPages[i] = nullptr;
+		_prgDirectReadPages[i] = nullptr;
 		_prgMemoryOffset[i] = -1;
 		_prgMemoryType[i] = PrgMemoryType::PrgRom;
 		_prgMemoryAccess[i] = MemoryAccessType::NoAccess;
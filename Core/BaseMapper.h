@@ -24,6 +24,7 @@ private:
 	uint16_t InternalGetChrPageSize();
 	uint16_t InternalGetChrRamPageSize();
 	bool ValidateAddressRange(uint16_t startAddr, uint16_t endAddr);
+	void UpdatePrgDirectReadPages(uint16_t startPage, uint16_t endPage);
 
 	uint8_t *_nametableRam = nullptr;
 	uint8_t _nametableCount = 2;
@@ -38,6 +39,10 @@ private:
 	MemoryAccessType _prgMemoryAccess[0x100];
 	uint8_t* _prgPages[0x100];
 
+	//Readable PRG pages that have no read registers (nullptr otherwise) - MemoryManager reads these directly, without calling ReadRAM
+	uint8_t* _prgDirectReadPages[0x100];
+	bool _hasReadRegister[0x100];
+
 	MemoryAccessType _chrMemoryAccess[0x100];
 	uint8_t* _chrPages[0x100];
 
@@ -178,6 +183,13 @@ public:
 
 	virtual void ApplySamples(int16_t* buffer, size_t sampleCount, double volume) {}
 
+	//Mappers that override ReadRAM must return false, to prevent the CPU from reading PRG pages directly
+	virtual bool AllowDirectPrgRead() { return true; }
+	uint8_t** GetPrgDirectReadPages() { return _prgDirectReadPages; }
+
+	//Mappers that watch the PPU (bus address changes, CHR reads) or switch CHR banks on their own must return false, the PPU needs to run in lockstep with the CPU for them
+	virtual bool AllowPpuBatching() { return true; }
+
 	uint8_t ReadRAM(uint16_t addr) override;
 	uint8_t PeekRAM(uint16_t addr) override;
 	uint8_t DebugReadRAM(uint16_t addr);
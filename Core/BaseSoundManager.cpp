@@ -11,7 +11,12 @@ void BaseSoundManager::ProcessLatency(uint32_t readPosition, uint32_t writePosit
 		cursorGap = writePosition - readPosition;
 	}
 
-	_cursorGaps[_cursorGapIndex] = cursorGap;
+	ProcessFillLevel(cursorGap);
+}
+
+void BaseSoundManager::ProcessFillLevel(uint32_t queuedBytes)
+{
+	_cursorGaps[_cursorGapIndex] = queuedBytes;
 	_cursorGapIndex = (_cursorGapIndex + 1) % 60;
 	if(_cursorGapIndex == 0) {
 		_cursorGapFilled = true;
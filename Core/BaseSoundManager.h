@@ -5,6 +5,7 @@ class BaseSoundManager : public IAudioDevice
 {
 public:
 	void ProcessLatency(uint32_t readPosition, uint32_t writePosition);
+	void ProcessFillLevel(uint32_t queuedBytes);
 	AudioStatistics GetStatistics() override;
 
 protected:
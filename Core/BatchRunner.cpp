@@ -0,0 +1,462 @@
+#include "stdafx.h"
+#include <thread>
+#include "BatchRunner.h"
+#include "Console.h"
+#include "EmulationSettings.h"
+#include "MovieManager.h"
+#include "NotificationManager.h"
+#include "RecordedRomTest.h"
+#include "VirtualFile.h"
+#include "PPU.h"
+#include "APU.h"
+#include "VideoRenderer.h"
+#include "SoundMixer.h"
+#include "IAudioDevice.h"
+#include "Debugger.h"
+#include "TraceLogger.h"
+#include "CodeDataLogger.h"
+#include "../Utilities/FolderUtilities.h"
+#include "../Utilities/HexUtilities.h"
+#include "../Utilities/ZipReader.h"
+#include "../Utilities/Timer.h"
+#include "../Utilities/md5.h"
+
+static string GetMd5Hex(MD5_CTX md5)
+{
+	uint8_t result[16];
+	MD5_Final(result, &md5);
+	vector<uint8_t> hash(result, result + 16);
+	return HexUtilities::ToHex(hash);
+}
+
+class BatchFrameValidator : public INotificationListener
+{
+private:
+	struct ExpectedHash
+	{
+		uint8_t RepeatCount;
+		uint8_t Hash[16];
+	};
+
+	MD5_CTX _md5;
+	vector<ExpectedHash> _expectedHashes;
+	size_t _hashIndex = 0;
+	uint8_t _remainingCount = 0;
+	uint32_t _badFrameCount = 0;
+	uint32_t _frameCount = 0;
+	bool _validateFrames = false;
+	bool _done = false;
+
+	void ValidateFrame(uint16_t* ppuFrameBuffer)
+	{
+		if(_remainingCount == 0 && _hashIndex + 1 < _expectedHashes.size()) {
+			_hashIndex++;
+			_remainingCount = _expectedHashes[_hashIndex].RepeatCount;
+		}
+		if(_remainingCount > 0) {
+			_remainingCount--;
+		}
+
+		uint8_t md5Hash[16];
+		GetMd5Sum(md5Hash, ppuFrameBuffer, PPU::PixelCount * sizeof(uint16_t));
+		if(memcmp(_expectedHashes[_hashIndex].Hash, md5Hash, 16) != 0) {
+			_badFrameCount++;
+		}
+
+		if(_remainingCount == 0 && _hashIndex + 1 >= _expectedHashes.size()) {
+			//End of test
+			_done = true;
+		}
+	}
+
+public:
+	BatchFrameValidator()
+	{
+		MD5_Init(&_md5);
+	}
+
+	bool LoadTestData(string filename)
+	{
+		ZipReader zipReader;
+		zipReader.LoadArchive(filename);
+
+		stringstream testData;
+		if(!zipReader.GetStream("TestData.mrt", testData)) {
+			return false;
+		}
+
+		char header[3];
+		testData.read((char*)&header, 3);
+		if(memcmp((char*)&header, "MRT", 3) != 0) {
+			return false;
+		}
+
+		uint32_t hashCount = 0;
+		testData.read((char*)&hashCount, sizeof(uint32_t));
+		for(uint32_t i = 0; i < hashCount && testData; i++) {
+			ExpectedHash entry;
+			testData.read((char*)&entry.RepeatCount, sizeof(uint8_t));
+			testData.read((char*)entry.Hash, 16);
+			_expectedHashes.push_back(entry);
+		}
+
+		if(!testData || _expectedHashes.empty()) {
+			return false;
+		}
+
+		_hashIndex = 0;
+		_remainingCount = _expectedHashes[0].RepeatCount;
+		_validateFrames = true;
+		return true;
+	}
+
+	void ProcessNotification(ConsoleNotificationType type, void* parameter) override
+	{
+		switch(type) {
+			case ConsoleNotificationType::PpuFrameDone:
+				if(!_done) {
+					_frameCount++;
+					MD5_Update(&_md5, parameter, PPU::PixelCount * sizeof(uint16_t));
+					if(_validateFrames) {
+						ValidateFrame((uint16_t*)parameter);
+					}
+				}
+				break;
+
+			case ConsoleNotificationType::MovieEnded:
+				if(!_validateFrames) {
+					_done = true;
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	bool IsDone() { return _done; }
+	uint32_t GetFrameCount() { return _frameCount; }
+	uint32_t GetBadFrameCount() { return _badFrameCount; }
+
+	string GetOutputHash()
+	{
+		return GetMd5Hex(_md5);
+	}
+};
+
+//Keeps a copy of some of the job's frames, to benchmark the video filters on them once the job is done
+class BatchFrameRecorder : public INotificationListener
+{
+private:
+	vector<vector<uint16_t>> _frames;
+	uint32_t _frameCount = 0;
+
+public:
+	void ProcessNotification(ConsoleNotificationType type, void* parameter) override
+	{
+		if(type == ConsoleNotificationType::PpuFrameDone) {
+			if(_frameCount % BatchRunner::BenchmarkFrameInterval == 0 && _frames.size() < BatchRunner::MaxBenchmarkFrames) {
+				uint16_t* ppuFrameBuffer = (uint16_t*)parameter;
+				_frames.push_back(vector<uint16_t>(ppuFrameBuffer, ppuFrameBuffer + PPU::PixelCount));
+			}
+			_frameCount++;
+		}
+	}
+
+	vector<vector<uint16_t>>& GetFrames()
+	{
+		return _frames;
+	}
+};
+
+//Audio device that hashes the sound mixer's output instead of playing it
+class BatchAudioHasher : public IAudioDevice
+{
+private:
+	MD5_CTX _md5;
+
+public:
+	BatchAudioHasher()
+	{
+		MD5_Init(&_md5);
+	}
+
+	void PlayBuffer(int16_t *soundBuffer, uint32_t bufferSize, uint32_t sampleRate, bool isStereo) override
+	{
+		MD5_Update(&_md5, soundBuffer, bufferSize * (isStereo ? 2 : 1) * sizeof(int16_t));
+	}
+
+	void Stop() override { }
+	void Pause() override { }
+	void ProcessEndOfFrame() override { }
+	void UpdateSoundSettings() override { }
+	string GetAvailableDevices() override { return ""; }
+	void SetAudioDevice(string deviceName) override { }
+	AudioStatistics GetStatistics() override { return AudioStatistics(); }
+
+	string GetOutputHash()
+	{
+		return GetMd5Hex(_md5);
+	}
+};
+
+void BatchRunner::AddJob(BatchJob job)
+{
+	_jobs.push_back(job);
+}
+
+bool BatchRunner::PopJob(uint32_t workerIndex, size_t &jobIndex)
+{
+	//Take jobs from the front of our own queue first
+	{
+		WorkerQueue &queue = *_queues[workerIndex];
+		auto lock = queue.Lock.AcquireSafe();
+		if(!queue.Jobs.empty()) {
+			jobIndex = queue.Jobs.front();
+			queue.Jobs.pop_front();
+			return true;
+		}
+	}
+
+	//Our queue is empty, steal from the back of another worker's queue
+	for(size_t i = 1; i < _queues.size(); i++) {
+		WorkerQueue &queue = *_queues[(workerIndex + i) % _queues.size()];
+		auto lock = queue.Lock.AcquireSafe();
+		if(!queue.Jobs.empty()) {
+			jobIndex = queue.Jobs.back();
+			queue.Jobs.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+BatchJobResult BatchRunner::RunJob(BatchJob &job)
+{
+	BatchJobResult result;
+	result.Name = FolderUtilities::GetFilename(job.RomFile, true);
+
+	string extension = job.RomFile.size() > 4 ? job.RomFile.substr(job.RomFile.size() - 4) : "";
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	bool isRecordedTest = extension == ".mtp";
+
+	shared_ptr<BatchFrameValidator> validator(new BatchFrameValidator());
+	if(isRecordedTest && !validator->LoadTestData(job.RomFile)) {
+		//Invalid test file
+		result.ErrorCode = -1;
+		return result;
+	}
+
+	//Declared before the console, which keeps a pointer to it until it is released
+	BatchAudioHasher audioHasher;
+
+	shared_ptr<Console> console;
+	shared_ptr<IMovie> movie;
+	bool loaded = false;
+	{
+		auto lock = _loadLock.AcquireSafe();
+
+		console.reset(new Console());
+		console->Init();
+
+		EmulationSettings* settings = console->GetSettings();
+		settings->SetFlags(EmulationFlags::ConsoleMode | EmulationFlags::HeadlessMode);
+		if(job.BatchPpuRendering) {
+			settings->SetFlags(EmulationFlags::BatchPpuRendering);
+		}
+		if(job.BenchmarkVideoFilters) {
+			settings->SetScreenRotation(job.ScreenRotation);
+		}
+		console->DisableMemoryFastPath(job.DisableMemoryFastPath);
+
+		VirtualFile romFile = isRecordedTest ? VirtualFile(job.RomFile, "TestRom.nes") : VirtualFile(job.RomFile);
+		VirtualFile movieFile = isRecordedTest ? VirtualFile(job.RomFile, "TestMovie.mmo") : VirtualFile(job.MovieFile);
+		if(isRecordedTest) {
+			RecordedRomTest::ApplyTestSettings(settings, job.RomFile);
+		}
+
+		if(console->Initialize(romFile)) {
+			console->GetApu()->DisableRunScheduling(job.DisableApuScheduling);
+			console->GetSoundMixer()->DisableBatchMixing(job.DisableBatchMixing);
+			console->GetSoundMixer()->RegisterAudioDevice(&audioHasher);
+			if(isRecordedTest || !job.MovieFile.empty()) {
+				movie = MovieManager::LoadMovie(movieFile, console);
+				loaded = movie != nullptr;
+			} else {
+				loaded = true;
+			}
+
+			if(loaded && !job.VideoFile.empty()) {
+				console->GetVideoRenderer()->StartRecording(job.VideoFile, job.Codec, job.CompressionLevel);
+				loaded = console->GetVideoRenderer()->IsRecording();
+			}
+		}
+	}
+
+	if(loaded) {
+		console->GetNotificationManager()->RegisterNotificationListener(validator);
+
+		shared_ptr<BatchFrameRecorder> frameRecorder;
+		if(job.BenchmarkVideoFilters) {
+			frameRecorder.reset(new BatchFrameRecorder());
+			console->GetNotificationManager()->RegisterNotificationListener(frameRecorder);
+		}
+
+		shared_ptr<TraceLogger> traceLogger;
+		if(!job.TraceFile.empty()) {
+			TraceLoggerOptions options = {};
+			options.ShowExtraInfo = true;
+			strncpy(options.Format, TraceLogFormatter::DefaultFormat, sizeof(options.Format) - 1);
+
+			//Only instrument what the trace logger needs (the CDL job below adds its own feature)
+			shared_ptr<Debugger> debugger = console->GetDebugger(true);
+			debugger->SetEnabledFeatures((uint32_t)DebuggerFeatures::TraceLogger);
+			traceLogger = debugger->GetTraceLogger();
+			traceLogger->SetOptions(options);
+			traceLogger->StartLogging(job.TraceFile);
+		}
+
+		shared_ptr<CodeDataLogger> codeDataLogger;
+		if(!job.CdlFile.empty()) {
+			shared_ptr<Debugger> debugger = console->GetDebugger(true);
+			debugger->SetEnabledFeatures((uint32_t)DebuggerFeatures::CodeDataLogger | (traceLogger ? (uint32_t)DebuggerFeatures::TraceLogger : 0));
+			debugger->OpenCdlFile(job.CdlFile);
+			codeDataLogger = debugger->GetCodeDataLogger();
+			if(codeDataLogger->IsFileRejected()) {
+				//The job still runs, but its flags can't be saved to the file
+				result.ErrorCode = -5;
+			}
+		}
+
+		uint32_t frameBudget = job.FrameBudget;
+		if(frameBudget == 0) {
+			frameBudget = movie ? BatchRunner::MaxFrameBudget : BatchRunner::DefaultFrameBudget;
+		}
+
+		Timer timer;
+		try {
+			while(!validator->IsDone() && validator->GetFrameCount() < frameBudget) {
+				console->RunSingleFrame();
+			}
+		} catch(const std::runtime_error &) {
+			//Game crashed
+			result.ErrorCode = -3;
+		}
+		if(traceLogger) {
+			//Wait for the trace log to be written to the disk - this is part of the job's time
+			traceLogger->StopLogging();
+		}
+		if(!job.VideoFile.empty()) {
+			//Wait for the encoders to finish - the time spent doing so is part of the job's rendering time
+			result.VideoFrameCount = console->GetVideoRenderer()->StopRecording().WrittenFrames;
+		}
+		result.ElapsedMs = timer.GetElapsedMS();
+
+		if(frameRecorder) {
+			result.FilterTimings = VideoFilterBenchmark::Run(console, frameRecorder->GetFrames());
+		}
+
+		result.FrameCount = validator->GetFrameCount();
+		result.Fps = result.ElapsedMs > 0 ? result.FrameCount * 1000.0 / result.ElapsedMs : 0;
+		result.OutputHash = validator->GetOutputHash();
+		result.AudioHash = audioHasher.GetOutputHash();
+		if(codeDataLogger) {
+			result.CdlPrgRatio = codeDataLogger->GetRatios().PrgRatio;
+		}
+		if(result.ErrorCode == 0) {
+			if(isRecordedTest) {
+				result.ErrorCode = validator->IsDone() ? validator->GetBadFrameCount() : -4;
+			}
+			result.Passed = result.ErrorCode == 0;
+		}
+	} else {
+		//Something went wrong when loading the rom or movie
+		result.ErrorCode = -2;
+	}
+
+	{
+		auto lock = _loadLock.AcquireSafe();
+		movie.reset();
+		console->Release(true);
+		console.reset();
+	}
+
+	return result;
+}
+
+bool BatchRunner::MergeCdlFiles(string romFile, string outputFile, vector<string> &inputFiles, CdlMergeResult &result)
+{
+	shared_ptr<Console> console(new Console());
+	console->Init();
+	console->GetSettings()->SetFlags(EmulationFlags::ConsoleMode | EmulationFlags::HeadlessMode);
+
+	bool loaded = console->Initialize(VirtualFile(romFile));
+	if(loaded) {
+		shared_ptr<Debugger> debugger = console->GetDebugger(true);
+		debugger->SetEnabledFeatures((uint32_t)DebuggerFeatures::None);
+		debugger->OpenCdlFile(outputFile);
+		result.OutputRejected = debugger->GetCodeDataLogger()->IsFileRejected();
+		for(string &inputFile : inputFiles) {
+			if(!debugger->MergeCdlFile(inputFile)) {
+				result.FailedFiles.push_back(inputFile);
+			}
+		}
+
+		shared_ptr<CodeDataLogger> codeDataLogger = debugger->GetCodeDataLogger();
+		result.Ratios = codeDataLogger->GetRatios();
+		for(uint32_t i = 0, count = codeDataLogger->GetPrgBankCount(); i < count; i++) {
+			result.PrgBankStats.push_back(codeDataLogger->GetPrgBankStats(i));
+		}
+	}
+
+	console->Release(true);
+	return loaded;
+}
+
+void BatchRunner::WorkerThread(uint32_t workerIndex)
+{
+	size_t jobIndex;
+	while(PopJob(workerIndex, jobIndex)) {
+		BatchJobResult result = RunJob(_jobs[jobIndex]);
+
+		auto lock = _resultLock.AcquireSafe();
+		_results[jobIndex] = result;
+		if(_onJobDone) {
+			_onJobDone(result);
+		}
+	}
+}
+
+vector<BatchJobResult> BatchRunner::Run(uint32_t workerCount, std::function<void(const BatchJobResult&)> onJobDone)
+{
+	if(workerCount == 0) {
+		workerCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	workerCount = std::min(workerCount, std::max(1u, (uint32_t)_jobs.size()));
+
+	_onJobDone = onJobDone;
+	_results.clear();
+	_results.resize(_jobs.size());
+
+	//Distribute the jobs round-robin, idle workers will steal from the others
+	_queues.clear();
+	for(uint32_t i = 0; i < workerCount; i++) {
+		_queues.push_back(unique_ptr<WorkerQueue>(new WorkerQueue()));
+	}
+	for(size_t i = 0; i < _jobs.size(); i++) {
+		_queues[i % workerCount]->Jobs.push_back(i);
+	}
+
+	vector<std::thread> workers;
+	for(uint32_t i = 0; i < workerCount; i++) {
+		workers.push_back(std::thread(&BatchRunner::WorkerThread, this, i));
+	}
+	for(std::thread &worker : workers) {
+		worker.join();
+	}
+
+	_queues.clear();
+	_onJobDone = nullptr;
+	return _results;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "stdafx.h"
+#include <functional>
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/AviWriter.h"
+#include "VideoFilterBenchmark.h"
+#include "CodeDataLogger.h"
+
+class Console;
+
+struct BatchJob
+{
+	//ROM to load - for recorded tests (.mtp), this is the test file itself
+	string RomFile;
+
+	//Optional movie to play back after loading the ROM
+	string MovieFile;
+
+	//Maximum number of frames to run (0 = run until the movie/test ends, or DefaultFrameBudget for ROM-only jobs)
+	uint32_t FrameBudget = 0;
+
+	//Forces all CPU memory accesses through the cheat/debugger hooks (used to benchmark the fast path)
+	bool DisableMemoryFastPath = false;
+
+	//Makes the APU check if it needs to run on every CPU cycle, instead of only at its next deadline (used to benchmark the APU's scheduling)
+	bool DisableApuScheduling = false;
+
+	//Runs the PPU in scanline-sized batches (EmulationFlags::BatchPpuRendering)
+	bool BatchPpuRendering = false;
+
+	//Makes the sound mixer process each change in the channels' output one at a time, without batching (used to benchmark the batched mixer)
+	bool DisableBatchMixing = false;
+
+	//Optional video file to render the job's output to (offline rendering: every frame and sound sample is recorded, at the emulation's own pace)
+	string VideoFile;
+	VideoCodec Codec = VideoCodec::ZMBV;
+	uint32_t CompressionLevel = 6;
+
+	//Optional trace log of every instruction executed by the job (.mtl files are logged in binary format, other files as text)
+	string TraceFile;
+
+	//Optional Code/Data Logger file - the job's CDL flags are recorded directly in the file (flags already in the file are kept)
+	string CdlFile;
+
+	//Benchmarks every video filter on a sample of the job's frames once the job is done (with the given screen rotation)
+	bool BenchmarkVideoFilters = false;
+	uint32_t ScreenRotation = 0;
+};
+
+struct BatchJobResult
+{
+	string Name;
+	bool Passed = false;
+
+	//Number of mismatching frames for recorded tests, negative values indicate a load error (-5: the CDL file was recorded for another ROM)
+	int32_t ErrorCode = 0;
+
+	uint32_t FrameCount = 0;
+	double ElapsedMs = 0;
+	double Fps = 0;
+
+	//MD5 of every frame produced by the job (in order)
+	string OutputHash;
+
+	//MD5 of the job's audio output (all samples, in order)
+	string AudioHash;
+
+	//Number of frames written to the video file, when rendering the job to a video
+	uint32_t VideoFrameCount = 0;
+
+	//Decode time of each video filter, when benchmarking them
+	vector<VideoFilterTiming> FilterTimings;
+
+	//Ratio of the PRG ROM flagged as code or data once the job is done, when recording a CDL file (-1 otherwise)
+	float CdlPrgRatio = -1;
+};
+
+struct CdlMergeResult
+{
+	//Input files that could not be merged (missing, or recorded for a ROM of a different size)
+	vector<string> FailedFiles;
+
+	//The output file was recorded for a ROM of a different size - it is left untouched, nothing is saved
+	bool OutputRejected = false;
+
+	CdlRatios Ratios = {};
+	vector<CdlBankStats> PrgBankStats;
+};
+
+class BatchRunner
+{
+private:
+	struct WorkerQueue
+	{
+		SimpleLock Lock;
+		deque<size_t> Jobs;
+	};
+
+	vector<BatchJob> _jobs;
+	vector<BatchJobResult> _results;
+	vector<unique_ptr<WorkerQueue>> _queues;
+
+	//Loading ROMs/movies touches process-wide state (known game folders, movie manager, etc.), so it is serialized across workers
+	SimpleLock _loadLock;
+	SimpleLock _resultLock;
+	std::function<void(const BatchJobResult&)> _onJobDone;
+
+	bool PopJob(uint32_t workerIndex, size_t &jobIndex);
+	void WorkerThread(uint32_t workerIndex);
+	BatchJobResult RunJob(BatchJob &job);
+
+public:
+	static constexpr uint32_t DefaultFrameBudget = 60 * 60;
+	static constexpr uint32_t MaxFrameBudget = 60 * 60 * 60 * 10;
+
+	//Every Nth frame of the job is kept to benchmark the video filters, up to MaxBenchmarkFrames frames
+	static constexpr uint32_t BenchmarkFrameInterval = 30;
+	static constexpr uint32_t MaxBenchmarkFrames = 120;
+
+	void AddJob(BatchJob job);
+	vector<BatchJobResult> Run(uint32_t workerCount, std::function<void(const BatchJobResult&)> onJobDone = nullptr);
+
+	//Merges CDL files recorded for the same ROM (in separate sessions/jobs) into the output file (its existing flags are kept)
+	static bool MergeCdlFiles(string romFile, string outputFile, vector<string> &inputFiles, CdlMergeResult &result);
+};
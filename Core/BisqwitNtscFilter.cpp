@@ -8,11 +8,9 @@
 #include "EmulationSettings.h"
 #include "Console.h"
 
-BisqwitNtscFilter::BisqwitNtscFilter(shared_ptr<Console> console, int resDivider) : BaseVideoFilter(console)
+BisqwitNtscFilter::BisqwitNtscFilter(shared_ptr<Console> console, int resDivider, int32_t threadCount) : BaseVideoFilter(console), _workerPool(threadCount)
 {
 	_resDivider = resDivider;
-	_stopThread = false;
-	_workDone = false;
 
 	const int8_t signalLumaLow[4] = { -29, -15, 22, 71 };
 	const int8_t signalLumaHigh[4] = { 32, 66, 105, 105 };
@@ -31,46 +29,43 @@ BisqwitNtscFilter::BisqwitNtscFilter(shared_ptr<Console> console, int resDivider
 		_signalLow[i] = m;
 		_signalHigh[i] = q;
 	}
-
-	_extraThread = std::thread([=]() {
-		//Worker thread to improve decode speed
-		while(!_stopThread) {
-			_waitWork.Wait();
-			if(_stopThread) {
-				break;
-			}
-
-			uint32_t* outputBuffer = GetOutputBuffer();
-
-			//Adjust outputbuffer to start at the middle of the picture
-			if(_keepVerticalRes) {
-				outputBuffer += GetOverscan().GetScreenWidth() * 8 / _resDivider * (120 - GetOverscan().Top);
-			} else {
-				outputBuffer += GetOverscan().GetScreenWidth() * 64 / _resDivider / _resDivider * (120 - GetOverscan().Top);
-			}
-
-			DecodeFrame(120, 239 - GetOverscan().Bottom, _ppuOutputBuffer, outputBuffer, (IsOddFrame() ? 8 : 0) + 327360); 
-
-			_workDone = true;
-		}
-	});
 }
 
 BisqwitNtscFilter::~BisqwitNtscFilter()
 {
-	_stopThread = true;
-	_waitWork.Signal();
-	_extraThread.join();
 }
 
 void BisqwitNtscFilter::ApplyFilter(uint16_t *ppuOutputBuffer)
 {
 	_ppuOutputBuffer = ppuOutputBuffer;
 
-	_workDone = false;
-	_waitWork.Signal();
-	DecodeFrame(GetOverscan().Top, 120, ppuOutputBuffer, GetOutputBuffer(), (IsOddFrame() ? 8 : 0) + GetOverscan().Top*341*8);
-	while(!_workDone) {}
+	int firstRow = GetOverscan().Top;
+	int lastRow = 239 - GetOverscan().Bottom;
+	uint32_t rowCount = lastRow - firstRow + 1;
+	uint32_t bandCount = std::max(1u, std::min(_workerPool.GetParallelism(), rowCount / _minBandHeight));
+	uint32_t rowPixelGap = GetRowPixelGap();
+	uint32_t* outputBuffer = GetOutputBuffer();
+	int startPhase = IsOddFrame() ? 8 : 0;
+
+	auto getBandRows = [=](uint32_t band, int &startRow, int &endRow) {
+		startRow = firstRow + rowCount * band / bandCount;
+		endRow = firstRow + rowCount * (band + 1) / bandCount - 1;
+	};
+
+	_workerPool.Run(bandCount, [=](uint32_t band) {
+		int startRow, endRow;
+		getBandRows(band, startRow, endRow);
+		DecodeFrame(startRow, endRow, ppuOutputBuffer, outputBuffer + (startRow - firstRow) * rowPixelGap, startPhase + startRow * 341 * _signalsPerPixel);
+	});
+
+	if(!_keepVerticalRes) {
+		//Blending a row uses the next row's output, so this can only start once every band has been decoded
+		_workerPool.Run(bandCount, [=](uint32_t band) {
+			int startRow, endRow;
+			getBandRows(band, startRow, endRow);
+			BlendFrame(startRow, endRow, outputBuffer + (startRow - firstRow) * rowPixelGap);
+		});
+	}
 }
 
 FrameInfo BisqwitNtscFilter::GetFrameInfo()
@@ -97,9 +92,9 @@ void BisqwitNtscFilter::OnBeforeApplyFilter()
 		_sinetable[i] = (int8_t)(8 * std::sin(i * 2 * pi / 12 + pictureSettings.Hue * pi));
 	}
 
-	_yWidth = (int)(12 + ntscSettings.YFilterLength * 22);
-	_iWidth = (int)(12 + ntscSettings.IFilterLength * 22);
-	_qWidth = (int)(12 + ntscSettings.QFilterLength * 22);
+	_yWidth = std::max(1, std::min(_maxFilterWidth, (int)(12 + ntscSettings.YFilterLength * 22)));
+	_iWidth = std::max(1, std::min(_maxFilterWidth, (int)(12 + ntscSettings.IFilterLength * 22)));
+	_qWidth = std::max(1, std::min(_maxFilterWidth, (int)(12 + ntscSettings.QFilterLength * 22)));
 
 	_y = contrast / _yWidth;
 
@@ -111,6 +106,15 @@ void BisqwitNtscFilter::OnBeforeApplyFilter()
 
 	_ib = (int)(contrast * -1.012984e-6 * saturation / _iWidth);
 	_qb = (int)(contrast * 1.667217e-6 * saturation / _qWidth);
+
+	_brightness = (int)(pictureSettings.Brightness * 750);
+
+	for(int phase = 0; phase < 12; phase++) {
+		for(int s = 0; s < _lineSignalCount; s++) {
+			_cosTable[phase][s] = _sinetable[s % 12 + phase];
+			_sinTable[phase][s] = _sinetable[s % 12 + 3 + phase];
+		}
+	}
 }
 
 void BisqwitNtscFilter::RecursiveBlend(int iterationCount, uint64_t *output, uint64_t *currentLine, uint64_t *nextLine, int pixelsPerCycle, bool verticalBlend)
@@ -192,18 +196,21 @@ void BisqwitNtscFilter::GenerateNtscSignal(int8_t *ntscSignal, int &phase, int r
 	phase += (341 - 256 - _paddingSize * 2) * _signalsPerPixel;
 }
 
-void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint16_t *ppuOutputBuffer, uint32_t* outputBuffer, int startPhase)
+uint32_t BisqwitNtscFilter::GetRowPixelGap()
 {
 	int pixelsPerCycle = 8 / _resDivider;
-	int phase = startPhase;
-	constexpr int lineWidth = 256 + _paddingSize * 2;
-	int8_t rowSignal[lineWidth * _signalsPerPixel];
 	uint32_t rowPixelGap = GetOverscan().GetScreenWidth() * pixelsPerCycle;
 	if(!_keepVerticalRes) {
 		rowPixelGap *= pixelsPerCycle;
 	}
-	
-	uint32_t* orgBuffer = outputBuffer;
+	return rowPixelGap;
+}
+
+void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint16_t *ppuOutputBuffer, uint32_t* outputBuffer, int startPhase)
+{
+	int phase = startPhase;
+	int8_t rowSignal[_lineSignalCount];
+	uint32_t rowPixelGap = GetRowPixelGap();
 
 	for(int y = startRow; y <= endRow; y++) {
 		int startCycle = phase % 12;
@@ -212,25 +219,27 @@ void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint16_t *ppuOutpu
 		GenerateNtscSignal(rowSignal, phase, y);
 
 		//Convert the NTSC signal to RGB
-		NtscDecodeLine(lineWidth * _signalsPerPixel, rowSignal, outputBuffer, (startCycle + 7) % 12);
+		NtscDecodeLine(_lineSignalCount, rowSignal, outputBuffer, (startCycle + 7) % 12);
 
 		outputBuffer += rowPixelGap;
 	}
+}
 
-	if(!_keepVerticalRes) {
-		//Generate the missing vertical lines
-		outputBuffer = orgBuffer;
-		int lastRow = 239 - GetOverscan().Bottom;
-		bool verticalBlend = _console->GetSettings()->GetNtscFilterSettings().VerticalBlend;
-		for(int y = startRow; y <= endRow; y++) {
-			uint64_t* currentLine = (uint64_t*)outputBuffer;
-			uint64_t* nextLine = y == lastRow ? currentLine : (uint64_t*)(outputBuffer + rowPixelGap);
-			uint64_t* buffer = (uint64_t*)(outputBuffer + rowPixelGap / 2);
-
-			RecursiveBlend(4 / _resDivider, buffer, currentLine, nextLine, pixelsPerCycle, verticalBlend);
-
-			outputBuffer += rowPixelGap;
-		}
+void BisqwitNtscFilter::BlendFrame(int startRow, int endRow, uint32_t* outputBuffer)
+{
+	//Generate the missing vertical lines
+	int pixelsPerCycle = 8 / _resDivider;
+	uint32_t rowPixelGap = GetRowPixelGap();
+	int lastRow = 239 - GetOverscan().Bottom;
+	bool verticalBlend = _console->GetSettings()->GetNtscFilterSettings().VerticalBlend;
+	for(int y = startRow; y <= endRow; y++) {
+		uint64_t* currentLine = (uint64_t*)outputBuffer;
+		uint64_t* nextLine = y == lastRow ? currentLine : (uint64_t*)(outputBuffer + rowPixelGap);
+		uint64_t* buffer = (uint64_t*)(outputBuffer + rowPixelGap / 2);
+
+		RecursiveBlend(4 / _resDivider, buffer, currentLine, nextLine, pixelsPerCycle, verticalBlend);
+
+		outputBuffer += rowPixelGap;
 	}
 }
 
@@ -266,28 +275,54 @@ void BisqwitNtscFilter::DecodeFrame(int startRow, int endRow, uint16_t *ppuOutpu
 */
 void BisqwitNtscFilter::NtscDecodeLine(int width, const int8_t* signal, uint32_t* target, int phase0)
 {
-	auto Read = [=](int pos) -> char { return pos >= 0 ? signal[pos] : 0; };
-	auto Cos = [=](int pos) -> char { return _sinetable[(pos + 36) % 12 + phase0]; };
-	auto Sin = [=](int pos) -> char { return _sinetable[(pos + 36) % 12 + 3 + phase0]; };
+	//Modulate the signal with the color subcarrier first: unlike the running sums below, there are no dependencies
+	//between samples in these loops, which lets the compiler vectorize them (SSE2/NEON).
+	//The first _maxFilterWidth entries stay at 0 - they are the samples before the start of the line.
+	int16_t ySignal[_maxFilterWidth + _lineSignalCount] = {};
+	int16_t iSignal[_maxFilterWidth + _lineSignalCount] = {};
+	int16_t qSignal[_maxFilterWidth + _lineSignalCount] = {};
+	int16_t* ys = ySignal + _maxFilterWidth;
+	int16_t* is = iSignal + _maxFilterWidth;
+	int16_t* qs = qSignal + _maxFilterWidth;
+	const int8_t* cosTable = _cosTable[phase0];
+	const int8_t* sinTable = _sinTable[phase0];
+
+	for(int s = 0; s < width; s++) {
+		ys[s] = signal[s];
+		is[s] = signal[s] * cosTable[s];
+		qs[s] = signal[s] * sinTable[s];
+	}
 
-	int brightness = (int)(_console->GetSettings()->GetPictureSettings().Brightness * 750);
-	int ysum = brightness, isum = 0, qsum = 0;
 	int offset = _resDivider + 4;
 	int leftOverscan = (GetOverscan().Left + _paddingSize) * 8 + offset;
 	int rightOverscan = width - (GetOverscan().Right + _paddingSize) * 8 + offset;
 
+	//Running sums over the filter windows - only the values for the output pixels are kept
+	int ysums[_lineSignalCount];
+	int isums[_lineSignalCount];
+	int qsums[_lineSignalCount];
+	int ysum = _brightness, isum = 0, qsum = 0;
+	int pixelCount = 0;
 	for(int s = 0; s < rightOverscan; s++) {
-		ysum += Read(s) - Read(s - _yWidth);
-		isum += Read(s) * Cos(s) - Read(s - _iWidth) * Cos(s - _iWidth);
-		qsum += Read(s) * Sin(s) - Read(s - _qWidth) * Sin(s - _qWidth);
+		ysum += ys[s] - ys[s - _yWidth];
+		isum += is[s] - is[s - _iWidth];
+		qsum += qs[s] - qs[s - _qWidth];
 
 		if(!(s % _resDivider) && s >= leftOverscan) {
-			int r = std::min(255, std::max(0, (ysum*_y + isum*_ir + qsum*_qr) / 65536));
-			int g = std::min(255, std::max(0, (ysum*_y + isum*_ig + qsum*_qg) / 65536));
-			int b = std::min(255, std::max(0, (ysum*_y + isum*_ib + qsum*_qb) / 65536));
-
-			*target = 0xFF000000 | (r << 16) | (g << 8) | b;
-			target++;
+			ysums[pixelCount] = ysum;
+			isums[pixelCount] = isum;
+			qsums[pixelCount] = qsum;
+			pixelCount++;
 		}
 	}
+
+	//Convert YIQ to RGB (vectorized)
+	for(int i = 0; i < pixelCount; i++) {
+		int y = ysums[i] * _y;
+		int r = std::min(255, std::max(0, (y + isums[i] * _ir + qsums[i] * _qr) / 65536));
+		int g = std::min(255, std::max(0, (y + isums[i] * _ig + qsums[i] * _qg) / 65536));
+		int b = std::min(255, std::max(0, (y + isums[i] * _ib + qsums[i] * _qb) / 65536));
+
+		target[i] = 0xFF000000 | (r << 16) | (g << 8) | b;
+	}
 }
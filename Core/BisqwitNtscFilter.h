@@ -4,7 +4,7 @@
 #pragma once
 #include "stdafx.h"
 #include "BaseVideoFilter.h"
-#include "../Utilities/AutoResetEvent.h"
+#include "../Utilities/WorkerPool.h"
 
 class BisqwitNtscFilter : public BaseVideoFilter
 {
@@ -13,11 +13,12 @@ private:
 	static constexpr int _paddingSize = 6;
 	static constexpr int _signalsPerPixel = 8;
 	static constexpr int _signalWidth = 258;
+	static constexpr int _lineSignalCount = (256 + _paddingSize * 2) * _signalsPerPixel;
+	static constexpr int _maxFilterWidth = 12 + 4 * 22;
+	static constexpr uint32_t _minBandHeight = 16;
 
-	std::thread _extraThread;
-	AutoResetEvent _waitWork;
-	atomic<bool> _stopThread;
-	atomic<bool> _workDone;
+	//Bands of rows are decoded in parallel (the calling thread processes one of the bands)
+	WorkerPool _workerPool;
 
 	bool _keepVerticalRes = false;
 
@@ -35,22 +36,30 @@ private:
 	int _y;
 	int _ir, _ig, _ib;
 	int _qr, _qg, _qb;
+	int _brightness;
 
 	//To finetune hue, you would have to recalculate sinetable[]. (Coarse changes can be made with Phase0.)
 	int8_t _sinetable[27]; // 8*sin(x*2pi/12)
 	int8_t _signalLow[0x40];
 	int8_t _signalHigh[0x40];
 
+	//Color subcarrier (cos/sin) for each sample of a line, for each of the 12 possible starting phases
+	int8_t _cosTable[12][_lineSignalCount];
+	int8_t _sinTable[12][_lineSignalCount];
+
 	void RecursiveBlend(int iterationCount, uint64_t *output, uint64_t *currentLine, uint64_t *nextLine, int pixelsPerCycle, bool verticalBlend);
 	
 	void NtscDecodeLine(int width, const int8_t* signal, uint32_t* target, int phase0);
 	
 	void GenerateNtscSignal(int8_t *ntscSignal, int &phase, int rowNumber);
 	void DecodeFrame(int startRow, int endRow, uint16_t *ppuOutputBuffer, uint32_t* outputBuffer, int startPhase);
+	void BlendFrame(int startRow, int endRow, uint32_t* outputBuffer);
+	uint32_t GetRowPixelGap();
 	void OnBeforeApplyFilter();
 
 public:
-	BisqwitNtscFilter(shared_ptr<Console> console, int resDivider);
+	//threadCount: number of extra worker threads, -1 = one per core
+	BisqwitNtscFilter(shared_ptr<Console> console, int resDivider, int32_t threadCount = -1);
 	virtual ~BisqwitNtscFilter();
 
 	virtual void ApplyFilter(uint16_t *ppuOutputBuffer);
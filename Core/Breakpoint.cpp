@@ -100,6 +100,21 @@ uint32_t Breakpoint::GetId()
 	return _id;
 }
 
+DebugMemoryType Breakpoint::GetMemoryType()
+{
+	return _memoryType;
+}
+
+int32_t Breakpoint::GetStartAddress()
+{
+	return _startAddr;
+}
+
+int32_t Breakpoint::GetEndAddress()
+{
+	return _endAddr;
+}
+
 bool Breakpoint::IsEnabled()
 {
 	return _enabled;
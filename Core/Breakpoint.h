@@ -27,6 +27,9 @@ public:
 	void ClearCondition();
 
 	uint32_t GetId();
+	DebugMemoryType GetMemoryType();
+	int32_t GetStartAddress();
+	int32_t GetEndAddress();
 	bool IsEnabled();
 	bool IsMarked();
 	
@@ -0,0 +1,143 @@
+#include "stdafx.h"
+#include "BreakpointIndex.h"
+#include "Breakpoint.h"
+
+BreakpointIndex::BreakpointIndex()
+{
+	memset(_addressBitmap, 0, sizeof(_addressBitmap));
+}
+
+void BreakpointIndex::Build(vector<Breakpoint> &breakpoints, bool isPpuBreakpoint)
+{
+	memset(_addressBitmap, 0, sizeof(_addressBitmap));
+	_allAddressBreakpoints.clear();
+	_allBreakpoints.clear();
+	_hasAbsoluteBreakpoints = false;
+
+	vector<Interval> relativeIntervals;
+	vector<Interval> absoluteIntervals;
+	for(size_t i = 0; i < breakpoints.size(); i++) {
+		_allBreakpoints.push_back((uint32_t)i);
+
+		Breakpoint &bp = breakpoints[i];
+		int32_t start = bp.GetStartAddress();
+		int32_t end = bp.GetEndAddress() == -1 ? start : bp.GetEndAddress();
+
+		switch(bp.GetMemoryType()) {
+			case DebugMemoryType::CpuMemory:
+			case DebugMemoryType::PpuMemory:
+				if((bp.GetMemoryType() == DebugMemoryType::PpuMemory) != isPpuBreakpoint) {
+					//Can never match
+					break;
+				}
+
+				if(start == -1) {
+					_allAddressBreakpoints.push_back((uint32_t)i);
+					memset(_addressBitmap, 0xFF, sizeof(_addressBitmap));
+				} else {
+					relativeIntervals.push_back({ start, end, (uint32_t)i });
+					for(int32_t addr = std::max(start, 0), last = std::min(end, (int32_t)BreakpointIndex::AddressCount - 1); addr <= last; addr++) {
+						_addressBitmap[addr >> 6] |= (uint64_t)1 << (addr & 0x3F);
+					}
+				}
+				break;
+
+			case DebugMemoryType::PrgRom:
+			case DebugMemoryType::WorkRam:
+			case DebugMemoryType::SaveRam:
+			case DebugMemoryType::ChrRom:
+			case DebugMemoryType::ChrRam:
+			case DebugMemoryType::PaletteMemory:
+			case DebugMemoryType::NametableRam:
+				if(start == -1) {
+					//Breakpoints on the whole memory type match any address of that type
+					_allAddressBreakpoints.push_back((uint32_t)i);
+					_hasAbsoluteBreakpoints = true;
+				} else {
+					absoluteIntervals.push_back({ start, end, (uint32_t)i });
+				}
+				break;
+
+			default:
+				//Other memory types are never matched by Breakpoint::Matches
+				break;
+		}
+	}
+
+	_relativeBreakpoints.Build(relativeIntervals);
+	_absoluteBreakpoints.Build(absoluteIntervals);
+	_hasAbsoluteBreakpoints |= !_absoluteBreakpoints.IsEmpty();
+}
+
+void BreakpointIndex::GetCandidates(uint32_t relativeAddress, int32_t absoluteAddress, vector<uint32_t> &candidates)
+{
+	candidates.clear();
+	candidates.insert(candidates.end(), _allAddressBreakpoints.begin(), _allAddressBreakpoints.end());
+	_relativeBreakpoints.GetMatches((int32_t)relativeAddress, candidates);
+	if(absoluteAddress >= 0) {
+		_absoluteBreakpoints.GetMatches(absoluteAddress, candidates);
+	}
+
+	//Breakpoints are processed in the same order as the breakpoint list (the first matching breakpoints' ids are reported)
+	std::sort(candidates.begin(), candidates.end());
+}
+
+void BreakpointIndex::IntervalTree::Build(vector<Interval> &intervals)
+{
+	_intervals = intervals;
+	std::sort(_intervals.begin(), _intervals.end(), [](const Interval &a, const Interval &b) { return a.Start < b.Start; });
+	_maxEnd = vector<int32_t>(_intervals.size(), -1);
+	Build(0, _intervals.size());
+}
+
+int32_t BreakpointIndex::IntervalTree::Build(size_t start, size_t end)
+{
+	if(start >= end) {
+		return -1;
+	}
+
+	size_t middle = start + (end - start) / 2;
+	int32_t maxEnd = std::max(_intervals[middle].End, std::max(Build(start, middle), Build(middle + 1, end)));
+	_maxEnd[middle] = maxEnd;
+	return maxEnd;
+}
+
+void BreakpointIndex::IntervalTree::GetMatches(int32_t address, vector<uint32_t> &matches)
+{
+	GetMatches(0, _intervals.size(), address, matches);
+}
+
+void BreakpointIndex::IntervalTree::GetMatches(size_t start, size_t end, int32_t address, vector<uint32_t> &matches)
+{
+	while(start < end) {
+		size_t middle = start + (end - start) / 2;
+		if(_maxEnd[middle] < address) {
+			//No interval in this sub-array ends at or after the address
+			return;
+		}
+
+		GetMatches(start, middle, address, matches);
+
+		if(_intervals[middle].Start > address) {
+			//This interval, and all the ones after it, start after the address
+			return;
+		}
+
+		if(_intervals[middle].End >= address) {
+			matches.push_back(_intervals[middle].Index);
+		}
+
+		//Process the right half without recursion
+		start = middle + 1;
+	}
+}
+
+vector<uint32_t>& BreakpointIndex::GetAllBreakpoints()
+{
+	return _allBreakpoints;
+}
+
+bool BreakpointIndex::IntervalTree::IsEmpty()
+{
+	return _intervals.empty();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "stdafx.h"
+
+class Breakpoint;
+
+//Address index for a list of breakpoints, used to find the breakpoints that can match a memory access without testing all of them
+//Breakpoints on CPU/PPU addresses are kept in a bitmap (one bit per address) and an interval tree, breakpoints on absolute addresses
+//(PRG ROM, work/save RAM, CHR, palette, nametables) are kept in a second interval tree, since they can only be checked once the absolute address is known.
+class BreakpointIndex
+{
+private:
+	struct Interval
+	{
+		int32_t Start;
+		int32_t End;
+		uint32_t Index;
+	};
+
+	//Static interval tree - intervals are sorted by start address, and each node (the middle of a sub-array) keeps the largest end address of its sub-array
+	class IntervalTree
+	{
+	private:
+		vector<Interval> _intervals;
+		vector<int32_t> _maxEnd;
+
+		int32_t Build(size_t start, size_t end);
+		void GetMatches(size_t start, size_t end, int32_t address, vector<uint32_t> &matches);
+
+	public:
+		void Build(vector<Interval> &intervals);
+		void GetMatches(int32_t address, vector<uint32_t> &matches);
+		bool IsEmpty();
+	};
+
+	static constexpr uint32_t AddressCount = 0x10000;
+
+	uint64_t _addressBitmap[BreakpointIndex::AddressCount / 64];
+	IntervalTree _relativeBreakpoints;
+	IntervalTree _absoluteBreakpoints;
+	vector<uint32_t> _allAddressBreakpoints;
+	vector<uint32_t> _allBreakpoints;
+	bool _hasAbsoluteBreakpoints = false;
+
+public:
+	BreakpointIndex();
+
+	void Build(vector<Breakpoint> &breakpoints, bool isPpuBreakpoint);
+
+	//Returns false when none of the breakpoints can match an access to this CPU/PPU address (no need to calculate the absolute address)
+	bool MayMatch(uint32_t relativeAddress)
+	{
+		return _hasAbsoluteBreakpoints || (_addressBitmap[(relativeAddress & (BreakpointIndex::AddressCount - 1)) >> 6] & ((uint64_t)1 << (relativeAddress & 0x3F))) != 0;
+	}
+
+	//Returns the (sorted) indexes of the breakpoints whose address range contains the access's relative or absolute address
+	//The breakpoints' memory type still needs to be checked (Breakpoint::Matches)
+	void GetCandidates(uint32_t relativeAddress, int32_t absoluteAddress, vector<uint32_t> &candidates);
+
+	//Indexes of all the breakpoints (used for global breakpoints, which have no address)
+	vector<uint32_t>& GetAllBreakpoints();
+};
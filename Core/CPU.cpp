@@ -87,6 +87,7 @@ void CPU::Reset(bool softReset, NesModel model)
 	_needHalt = false;
 	_dmcDmaRunning = false;
 	_lastCrashWarning = 0;
+	_ppuBatching = false;
 
 	//Used by NSF code to disable Frame Counter & DMC interrupts
 	_irqMask = 0xFF;
@@ -160,6 +161,13 @@ void CPU::Reset(bool softReset, NesModel model)
 
 void CPU::Exec()
 {
+	//Skip the cheat/debugger hooks on memory accesses when none are active
+	_fastMemoryAccess = !_console->HasMemoryHooks();
+	_ppuBatching = _fastMemoryAccess && _console->IsPpuBatchingAllowed();
+	if(_ppuBatching) {
+		_ppuSyncClock = _console->GetPpu()->GetNextSyncClock();
+	}
+
 	uint8_t opCode = GetOPCode();
 	_instAddrMode = _addrMode[opCode];
 	_operand = FetchOperand();
@@ -245,7 +253,14 @@ void CPU::MemoryWrite(uint16_t addr, uint8_t value, MemoryOperationType operatio
 #else
 	_cpuWrite = true;
 	StartCpuCycle(false);
-	_memoryManager->Write(addr, value, operationType);
+	if(_ppuBatching && !_memoryManager->IsDirectWrite(addr)) {
+		SyncPpu();
+	}
+	if(_fastMemoryAccess) {
+		_memoryManager->FastWrite(addr, value);
+	} else {
+		_memoryManager->Write(addr, value, operationType);
+	}
 	EndCpuCycle(false);
 	_cpuWrite = false;
 #endif
@@ -265,7 +280,10 @@ uint8_t CPU::MemoryRead(uint16_t addr, MemoryOperationType operationType) {
 	ProcessPendingDma(addr);
 
 	StartCpuCycle(true);
-	uint8_t value = _memoryManager->Read(addr, operationType);
+	if(_ppuBatching && !_memoryManager->IsDirectRead(addr)) {
+		SyncPpu();
+	}
+	uint8_t value = _fastMemoryAccess ? _memoryManager->FastRead(addr) : _memoryManager->Read(addr, operationType);
 	EndCpuCycle(true);
 	return value;
 #endif
@@ -319,7 +337,7 @@ uint16_t CPU::FetchOperand()
 void CPU::EndCpuCycle(bool forRead)
 {
 	_masterClock += forRead ? (_endClockCount + 1) : (_endClockCount - 1);
-	_console->GetPpu()->Run(_masterClock - _ppuOffset);
+	RunPpu();
 
 	//"The internal signal goes high during φ1 of the cycle that follows the one where the edge is detected,
 	//and stays high until the NMI has been handled. "
@@ -343,16 +361,36 @@ void CPU::StartCpuCycle(bool forRead)
 {
 	_masterClock += forRead ? (_startClockCount - 1) : (_startClockCount + 1);
 	_cycleCount++;
-	_console->GetPpu()->Run(_masterClock - _ppuOffset);
+	RunPpu();
 	_console->ProcessCpuClock();
 }
 
+void CPU::RunPpu()
+{
+	if(!_ppuBatching || _masterClock - _ppuOffset >= _ppuSyncClock) {
+		SyncPpu();
+	}
+}
+
+void CPU::SyncPpu()
+{
+	PPU* ppu = _console->GetPpu();
+	ppu->Run(_masterClock - _ppuOffset);
+	if(_ppuBatching) {
+		_ppuSyncClock = ppu->GetNextSyncClock();
+	}
+}
+
 void CPU::ProcessPendingDma(uint16_t readAddress)
 {
 	if(!_needHalt) {
 		return;
 	}
 
+	//DMA accesses bypass the sync checks done in MemoryRead/Write, stop batching until the next instruction
+	SyncPpu();
+	_ppuBatching = false;
+
 	//"If this cycle is a read, hijack the read, discard the value, and prevent all other actions that occur on this cycle (PC not incremented, etc)"
 	StartCpuCycle(true);
 	_memoryManager->Read(readAddress, MemoryOperationType::DummyRead);
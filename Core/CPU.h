@@ -55,6 +55,11 @@ private:
 	State _state;
 	shared_ptr<Console> _console;
 	MemoryManager* _memoryManager;
+	bool _fastMemoryAccess = false;
+
+	//When batching, the PPU runs behind the CPU and only catches up at sync points (next scanline/NMI event, or any access that can reach the PPU or mapper)
+	bool _ppuBatching = false;
+	uint64_t _ppuSyncClock = 0;
 
 	bool _prevRunIrq = false;
 	bool _runIrq = false;
@@ -81,6 +86,8 @@ private:
 	__forceinline void ProcessPendingDma(uint16_t readAddress);
 	__forceinline uint16_t FetchOperand();
 	__forceinline void EndCpuCycle(bool forRead);
+	__forceinline void RunPpu();
+	void SyncPpu();
 	void IRQ();
 
 	uint8_t GetOPCode()
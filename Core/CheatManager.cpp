@@ -100,6 +100,7 @@ void CheatManager::AddCode(CodeInfo &code)
 		_absoluteCheatCodes.push_back(code);
 	}
 	_hasCode = true;
+	_console->UpdateMemoryHooks();
 	_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::CheatAdded);
 }
 
@@ -140,6 +141,7 @@ void CheatManager::ClearCodes()
 	cheatRemoved |= _absoluteCheatCodes.size() > 0;
 	_absoluteCheatCodes.clear();
 	_hasCode = false;
+	_console->UpdateMemoryHooks();
 
 	if(cheatRemoved) {
 		_console->GetNotificationManager()->SendNotification(ConsoleNotificationType::CheatRemoved);
@@ -57,5 +57,6 @@ public:
 	void SetCheats(vector<CodeInfo> &cheats);
 	void SetCheats(CheatInfo cheats[], uint32_t length);
 
+	bool HasCodes() { return _hasCode; }
 	void ApplyCodes(uint16_t addr, uint8_t &value);
 };
\ No newline at end of file
@@ -2,19 +2,30 @@
 #include "CodeDataLogger.h"
 #include "Debugger.h"
 #include "LabelManager.h"
+#include "MessageManager.h"
+#include "../Utilities/FolderUtilities.h"
 
 CodeDataLogger::CodeDataLogger(Debugger *debugger, uint32_t prgSize, uint32_t chrSize)
 {
 	_debugger = debugger;
 	_prgSize = prgSize;
 	_chrSize = chrSize;
-	_cdlData = new uint8_t[prgSize+chrSize];
+	_prgBankStats = vector<CdlBankStats>((prgSize + CodeDataLogger::PrgBankSize - 1) / CodeDataLogger::PrgBankSize, CdlBankStats { 0, 0 });
+	UseMemoryData();
 	Reset();
 }
 
 CodeDataLogger::~CodeDataLogger()
 {
-	delete[] _cdlData;
+	_mappedFile.Close();
+}
+
+void CodeDataLogger::UseMemoryData()
+{
+	_mappedFile.Close();
+	_mappedFilepath = "";
+	_memoryData = vector<uint8_t>(_prgSize + _chrSize, 0);
+	_cdlData = _memoryData.data();
 }
 
 void CodeDataLogger::Reset()
@@ -24,11 +35,18 @@ void CodeDataLogger::Reset()
 	_usedChrSize = 0;
 	_drawnChrSize = 0;
 	_readChrSize = 0;
+	std::fill(_prgBankStats.begin(), _prgBankStats.end(), CdlBankStats { 0, 0 });
 	memset(_cdlData, 0, _prgSize + _chrSize);
 }
 
 bool CodeDataLogger::LoadCdlFile(string cdlFilepath)
 {
+	if(_mappedFile.GetWritableData() && FolderUtilities::IsSameFile(cdlFilepath, _mappedFilepath)) {
+		//The data is already this file's content (reading it would overwrite the mapping with itself, after Reset cleared it)
+		CalculateStats();
+		return true;
+	}
+
 	ifstream cdlFile(cdlFilepath, ios::in | ios::binary);
 	if(cdlFile) {
 		cdlFile.seekg(0, std::ios::end);
@@ -49,6 +67,87 @@ bool CodeDataLogger::LoadCdlFile(string cdlFilepath)
 	return false;
 }
 
+bool CodeDataLogger::OpenCdlFile(string cdlFilepath)
+{
+	bool created = false;
+	_fileRejected = false;
+	if(_mappedFile.OpenWritable(cdlFilepath, _prgSize + _chrSize, created)) {
+		_memoryData = vector<uint8_t>();
+		_cdlData = _mappedFile.GetWritableData();
+		_mappedFilepath = cdlFilepath;
+		_cdlFilepath = "";
+		if(created) {
+			Reset();
+		} else {
+			CalculateStats();
+		}
+		return !created;
+	} else {
+		UseMemoryData();
+		if(LoadCdlFile(cdlFilepath)) {
+			_cdlFilepath = cdlFilepath;
+			return true;
+		}
+		Reset();
+
+		if(ifstream(cdlFilepath, ios::in | ios::binary)) {
+			//The file exists but its size doesn't match the ROM's (e.g another version of the game): don't overwrite it
+			MessageManager::Log("[Debugger] CDL file size does not match the ROM, the file will not be modified: " + cdlFilepath);
+			_cdlFilepath = "";
+			_fileRejected = true;
+		} else {
+			_cdlFilepath = cdlFilepath;
+		}
+		return false;
+	}
+}
+
+bool CodeDataLogger::IsFileRejected()
+{
+	return _fileRejected;
+}
+
+void CodeDataLogger::FlushCdlFile()
+{
+	if(_mappedFile.GetWritableData()) {
+		_mappedFile.Flush();
+	} else if(!_cdlFilepath.empty()) {
+		SaveCdlFile(_cdlFilepath);
+	}
+}
+
+bool CodeDataLogger::MergeCdlFile(string cdlFilepath)
+{
+	MemoryMappedFile cdlFile;
+	if(!cdlFile.Open(cdlFilepath) || cdlFile.GetSize() != _prgSize + _chrSize) {
+		return false;
+	}
+
+	const uint8_t* cdlData = cdlFile.GetData();
+	for(uint32_t i = 0; i < _prgSize; i++) {
+		uint8_t oldValue = _cdlData[i];
+		uint8_t newValue = oldValue | cdlData[i];
+		if(newValue & (uint8_t)CdlPrgFlags::Code) {
+			//Bytes that were executed in any of the sessions are code (same as SetFlag)
+			newValue &= ~(uint8_t)CdlPrgFlags::Data;
+		}
+		if(newValue != oldValue) {
+			_cdlData[i] = newValue;
+			UpdatePrgStats(i, oldValue, newValue);
+		}
+	}
+
+	for(uint32_t i = _prgSize; i < _prgSize + _chrSize; i++) {
+		uint8_t oldValue = _cdlData[i];
+		uint8_t newValue = oldValue | cdlData[i];
+		if(newValue != oldValue) {
+			_cdlData[i] = newValue;
+			UpdateChrStats(oldValue, newValue);
+		}
+	}
+	return true;
+}
+
 void CodeDataLogger::CalculateStats()
 {
 	_codeSize = 0;
@@ -56,12 +155,15 @@ void CodeDataLogger::CalculateStats()
 	_usedChrSize = 0;
 	_drawnChrSize = 0;
 	_readChrSize = 0;
+	std::fill(_prgBankStats.begin(), _prgBankStats.end(), CdlBankStats { 0, 0 });
 
 	for(int i = 0, len = _prgSize; i < len; i++) {
 		if(IsCode(i)) {
 			_codeSize++;
+			_prgBankStats[i / CodeDataLogger::PrgBankSize].CodeSize++;
 		} else if(IsData(i)) {
 			_dataSize++;
+			_prgBankStats[i / CodeDataLogger::PrgBankSize].DataSize++;
 		}
 	}
 
@@ -79,35 +181,73 @@ void CodeDataLogger::CalculateStats()
 
 bool CodeDataLogger::SaveCdlFile(string cdlFilepath)
 {
-	ofstream cdlFile(cdlFilepath, ios::out | ios::binary);
+	if(_mappedFile.GetWritableData() && FolderUtilities::IsSameFile(cdlFilepath, _mappedFilepath)) {
+		//The data is already in this file - rewriting it would truncate the file while it is mapped
+		_mappedFile.Flush();
+		return true;
+	}
+
+	//Write to a temporary file first, the existing file is only replaced once all the data has been written
+	string tmpFilepath = cdlFilepath + ".tmp";
+	ofstream cdlFile(tmpFilepath, ios::out | ios::binary);
 	if(cdlFile) {
-		cdlFile.write((char*)_cdlData, _prgSize+_chrSize);
+		cdlFile.write((char*)_cdlData, _prgSize + _chrSize);
 		cdlFile.close();
-		return true;
+		if(!cdlFile.fail() && FolderUtilities::RenameFile(tmpFilepath, cdlFilepath)) {
+			return true;
+		}
+		std::remove(tmpFilepath.c_str());
 	}
 	return false;
 }
 
+void CodeDataLogger::UpdatePrgStats(uint32_t absoluteAddr, uint8_t oldValue, uint8_t newValue)
+{
+	//Bytes flagged as both code and data are counted as code (same as CalculateStats)
+	int32_t codeDelta = (int32_t)(newValue & (uint8_t)CdlPrgFlags::Code) - (int32_t)(oldValue & (uint8_t)CdlPrgFlags::Code);
+	int32_t dataDelta = (int32_t)((newValue & 0x03) == (uint8_t)CdlPrgFlags::Data) - (int32_t)((oldValue & 0x03) == (uint8_t)CdlPrgFlags::Data);
+
+	CdlBankStats &bankStats = _prgBankStats[absoluteAddr / CodeDataLogger::PrgBankSize];
+	_codeSize += codeDelta;
+	_dataSize += dataDelta;
+	bankStats.CodeSize += codeDelta;
+	bankStats.DataSize += dataDelta;
+}
+
+void CodeDataLogger::UpdateChrStats(uint8_t oldValue, uint8_t newValue)
+{
+	//Bytes that were both drawn and read are counted as drawn (same as CalculateStats)
+	bool wasDrawn = (oldValue & (uint8_t)CdlChrFlags::Drawn) != 0;
+	bool wasRead = !wasDrawn && (oldValue & (uint8_t)CdlChrFlags::Read) != 0;
+	bool isDrawn = (newValue & (uint8_t)CdlChrFlags::Drawn) != 0;
+	bool isRead = !isDrawn && (newValue & (uint8_t)CdlChrFlags::Read) != 0;
+
+	_usedChrSize += (int32_t)(isDrawn || isRead) - (int32_t)(wasDrawn || wasRead);
+	_drawnChrSize += (int32_t)isDrawn - (int32_t)wasDrawn;
+	_readChrSize += (int32_t)isRead - (int32_t)wasRead;
+}
+
 void CodeDataLogger::SetFlag(int32_t absoluteAddr, CdlPrgFlags flag)
 {
 	if(absoluteAddr >= 0 && absoluteAddr < (int32_t)_prgSize) {
-		if((_cdlData[absoluteAddr] & (uint8_t)flag) != (uint8_t)flag) {
+		uint8_t oldValue = _cdlData[absoluteAddr];
+		if((oldValue & (uint8_t)flag) != (uint8_t)flag) {
+			uint8_t newValue;
 			if(flag == CdlPrgFlags::Code) {
-				if(IsData(absoluteAddr)) {
-					//Remove the data flag from bytes that we are flagging as code
-					_cdlData[absoluteAddr] &= ~(uint8_t)CdlPrgFlags::Data;
-					_dataSize--;
-				}
-				_cdlData[absoluteAddr] |= (uint8_t)flag;
-				_codeSize++;
+				//Remove the data flag from bytes that we are flagging as code
+				newValue = (oldValue & ~(uint8_t)CdlPrgFlags::Data) | (uint8_t)flag;
 			} else if(flag == CdlPrgFlags::Data) {
-				if(!IsCode(absoluteAddr)) {
-					_cdlData[absoluteAddr] |= (uint8_t)flag;
-					_dataSize++;
+				if(oldValue & (uint8_t)CdlPrgFlags::Code) {
+					return;
 				}
+				newValue = oldValue | (uint8_t)flag;
 			} else {
-				_cdlData[absoluteAddr] |= (uint8_t)flag;
+				//Other flags don't affect the stats
+				_cdlData[absoluteAddr] = oldValue | (uint8_t)flag;
+				return;
 			}
+			_cdlData[absoluteAddr] = newValue;
+			UpdatePrgStats(absoluteAddr, oldValue, newValue);
 		}
 	}
 }
@@ -115,14 +255,11 @@ void CodeDataLogger::SetFlag(int32_t absoluteAddr, CdlPrgFlags flag)
 void CodeDataLogger::SetFlag(int32_t chrAbsoluteAddr, CdlChrFlags flag)
 {
 	if(chrAbsoluteAddr >= 0 && chrAbsoluteAddr < (int32_t)_chrSize) {
-		if((_cdlData[_prgSize + chrAbsoluteAddr] & (uint8_t)flag) != (uint8_t)flag) {
-			_usedChrSize++;
-			if(flag == CdlChrFlags::Read) {
-				_readChrSize++;
-			} else if(flag == CdlChrFlags::Drawn) {
-				_drawnChrSize++;
-			}
-			_cdlData[_prgSize + chrAbsoluteAddr] |= (uint8_t)flag;
+		uint8_t oldValue = _cdlData[_prgSize + chrAbsoluteAddr];
+		if((oldValue & (uint8_t)flag) != (uint8_t)flag) {
+			uint8_t newValue = oldValue | (uint8_t)flag;
+			_cdlData[_prgSize + chrAbsoluteAddr] = newValue;
+			UpdateChrStats(oldValue, newValue);
 		}
 	}
 }
@@ -146,6 +283,16 @@ CdlRatios CodeDataLogger::GetRatios()
 	return ratios;
 }
 
+uint32_t CodeDataLogger::GetPrgBankCount()
+{
+	return (uint32_t)_prgBankStats.size();
+}
+
+CdlBankStats CodeDataLogger::GetPrgBankStats(uint32_t bankIndex)
+{
+	return bankIndex < _prgBankStats.size() ? _prgBankStats[bankIndex] : CdlBankStats { 0, 0 };
+}
+
 bool CodeDataLogger::IsCode(uint32_t absoluteAddr)
 {
 	return (_cdlData[absoluteAddr] & (uint8_t)CdlPrgFlags::Code) == (uint8_t)CdlPrgFlags::Code;
@@ -222,8 +369,10 @@ void CodeDataLogger::StripData(uint8_t *romBuffer, CdlStripFlag flag)
 
 void CodeDataLogger::MarkPrgBytesAs(uint32_t start, uint32_t end, CdlPrgFlags type)
 {
-	for(uint32_t i = start; i <= end; i++) {
-		_cdlData[i] = (_cdlData[i] & 0xFC) | (int)type;
+	for(uint32_t i = start; i <= end && i < _prgSize; i++) {
+		uint8_t oldValue = _cdlData[i];
+		_cdlData[i] = (oldValue & 0xFC) | (int)type;
+		UpdatePrgStats(i, oldValue, _cdlData[i]);
 	}
 	_debugger->UpdateCdlCache();
 }
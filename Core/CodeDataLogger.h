@@ -2,6 +2,7 @@
 
 #include "stdafx.h"
 #include "../Utilities/SimpleLock.h"
+#include "../Utilities/MemoryMappedFile.h"
 #include "DebuggerTypes.h"
 
 class Debugger;
@@ -48,6 +49,12 @@ struct CdlRatios
 	float ChrDrawnRatio;
 };
 
+struct CdlBankStats
+{
+	uint32_t CodeSize;
+	uint32_t DataSize;
+};
+
 class CodeDataLogger
 {
 private:
@@ -56,29 +63,55 @@ private:
 	uint32_t _prgSize = 0;
 	uint32_t _chrSize = 0;
 
+	//The CDL data is either kept in memory, or in a memory-mapped file (see OpenCdlFile)
+	vector<uint8_t> _memoryData;
+	MemoryMappedFile _mappedFile;
+	string _mappedFilepath;
+	string _cdlFilepath;
+	bool _fileRejected = false;
+
 	uint32_t _codeSize = 0;
 	uint32_t _dataSize = 0;
 	uint32_t _usedChrSize = 0;
 	uint32_t _readChrSize = 0;
 	uint32_t _drawnChrSize = 0;
+	vector<CdlBankStats> _prgBankStats;
 
 	SimpleLock _lock;
 	
 	void CalculateStats();
+	void UpdatePrgStats(uint32_t absoluteAddr, uint8_t oldValue, uint8_t newValue);
+	void UpdateChrStats(uint8_t oldValue, uint8_t newValue);
+	void UseMemoryData();
 
 public:
 	CodeDataLogger(Debugger *debugger, uint32_t prgSize, uint32_t chrSize);
 	~CodeDataLogger();
 
+	static constexpr uint32_t PrgBankSize = 0x2000;
+
 	void Reset();
 
 	bool LoadCdlFile(string cdlFilepath);
 	bool SaveCdlFile(string cdlFilepath);
 
+	//Uses the file as the storage for the CDL data - flags are written to the file as they are set (no need to save it, and they survive crashes)
+	//Returns true if the file already contained CDL data for this ROM (the file is created/cleared otherwise)
+	//When the file can't be mapped (e.g libretro), its content is loaded in memory instead and FlushCdlFile saves it back to the file.
+	//Existing files recorded for a ROM of a different size are never modified: the data is only kept in memory (see IsFileRejected)
+	bool OpenCdlFile(string cdlFilepath);
+	void FlushCdlFile();
+	bool IsFileRejected();
+
+	//Merges the flags from another CDL file for the same ROM (e.g recorded in a different session) into the current data
+	bool MergeCdlFile(string cdlFilepath);
+
 	void SetFlag(int32_t absoluteAddr, CdlPrgFlags flag);
 	void SetFlag(int32_t chrAbsoluteAddr, CdlChrFlags flag);
 
 	CdlRatios GetRatios();
+	uint32_t GetPrgBankCount();
+	CdlBankStats GetPrgBankStats(uint32_t bankIndex);
 
 	bool IsCode(uint32_t absoluteAddr);
 	bool IsJumpTarget(uint32_t absoluteAddr);
@@ -139,6 +139,8 @@ void Console::Release(bool forShutdown)
 	_mapper.reset();
 	_memoryManager.reset();
 	_controlManager.reset();
+
+	UpdateMemoryHooks();
 }
 
 shared_ptr<BatteryManager> Console::GetBatteryManager()
@@ -774,10 +776,9 @@ void Console::Run()
 	bool crashed = false;
 	try {
 		while(true) {
-			stringstream runAheadState;
 			bool useRunAhead = _settings->GetRunAheadFrames() > 0 && !_debugger && !IsNsf() && !_rewindManager->IsRewinding() && _settings->GetEmulationSpeed() > 0 && _settings->GetEmulationSpeed() <= 100;
 			if(useRunAhead) {
-				RunFrameWithRunAhead(runAheadState);
+				RunFrameWithRunAhead();
 			} else {
 				RunFrame();
 			}
@@ -840,7 +841,7 @@ void Console::Run()
 
 			if(useRunAhead) {
 				_settings->SetRunAheadFrameFlag(true);
-				LoadState(runAheadState);
+				LoadState(_runAheadState.data(), _runAheadStateSize);
 				_settings->SetRunAheadFrameFlag(false);
 			}
 
@@ -951,13 +952,18 @@ void Console::Run()
 	_notificationManager->SendNotification(ConsoleNotificationType::EmulationStopped);
 }
 
-void Console::RunFrameWithRunAhead(std::stringstream& runAheadState)
+void Console::RunFrameWithRunAhead()
 {
 	uint32_t runAheadFrames = _settings->GetRunAheadFrames();
 	_settings->SetRunAheadFrameFlag(true);
 	//Run a single frame and save the state (no audio/video)
 	RunFrame();
-	SaveState(runAheadState);
+	_runAheadStateSize = SaveState(_runAheadState.data(), (uint32_t)_runAheadState.size());
+	if(_runAheadStateSize > _runAheadState.size()) {
+		//First frame (or the state grew), allocate the slot and save again
+		_runAheadState.resize(_runAheadStateSize);
+		SerializeState(_runAheadState.data(), _runAheadStateSize);
+	}
 	while(runAheadFrames > 1) {
 		//Run extra frames if the requested run ahead frame count is higher than 1
 		runAheadFrames--;
@@ -1074,28 +1080,62 @@ double Console::GetFps()
 	}
 }
 
-void Console::SaveState(ostream &saveStream)
+uint32_t Console::SerializeState(uint8_t *buffer, uint32_t bufferSize)
+{
+	uint32_t position = 0;
+	auto saveComponent = [&](Snapshotable* component) {
+		if(position < bufferSize) {
+			position += component->SaveSnapshot(buffer + position, bufferSize - position);
+		} else {
+			position += component->SaveSnapshot(nullptr, 0);
+		}
+	};
+
+	saveComponent(_cpu.get());
+	saveComponent(_ppu.get());
+	saveComponent(_memoryManager.get());
+	saveComponent(_apu.get());
+	saveComponent(_controlManager.get());
+	saveComponent(_mapper.get());
+	if(_hdAudioDevice) {
+		saveComponent(_hdAudioDevice.get());
+	} else {
+		position += Snapshotable::WriteEmptyBlock(position < bufferSize ? buffer + position : nullptr, position < bufferSize ? bufferSize - position : 0);
+	}
+
+	if(_slave) {
+		//For VS Dualsystem, append the 2nd console's savestate
+		position += _slave->SerializeState(position < bufferSize ? buffer + position : nullptr, position < bufferSize ? bufferSize - position : 0);
+	}
+
+	return position;
+}
+
+uint32_t Console::SaveState(uint8_t *buffer, uint32_t bufferSize)
 {
 	if(_initialized) {
 		//Send any unprocessed sound to the SoundMixer - needed for rewind
 		_apu->EndFrame();
-
-		_cpu->SaveSnapshot(&saveStream);
-		_ppu->SaveSnapshot(&saveStream);
-		_memoryManager->SaveSnapshot(&saveStream);
-		_apu->SaveSnapshot(&saveStream);
-		_controlManager->SaveSnapshot(&saveStream);
-		_mapper->SaveSnapshot(&saveStream);
-		if(_hdAudioDevice) {
-			_hdAudioDevice->SaveSnapshot(&saveStream);
-		} else {
-			Snapshotable::WriteEmptyBlock(&saveStream);
+		if(_slave) {
+			_slave->_apu->EndFrame();
 		}
 
-		if(_slave) {
-			//For VS Dualsystem, append the 2nd console's savestate
-			_slave->SaveState(saveStream);
+		//Returns the size required - if it is larger than bufferSize, the state was not saved completely
+		return SerializeState(buffer, bufferSize);
+	}
+	return 0;
+}
+
+void Console::SaveState(ostream &saveStream)
+{
+	if(_initialized) {
+		uint32_t size = SaveState(_stateBuffer.data(), (uint32_t)_stateBuffer.size());
+		if(size > _stateBuffer.size()) {
+			//Buffer was too small, grow it and try again
+			_stateBuffer.resize(size);
+			SerializeState(_stateBuffer.data(), size);
 		}
+		saveStream.write((char*)_stateBuffer.data(), size);
 	}
 }
 
@@ -1106,25 +1146,39 @@ void Console::LoadState(istream &loadStream)
 
 void Console::LoadState(istream &loadStream, uint32_t stateVersion)
 {
+	if(_initialized) {
+		_stateBuffer.assign(std::istreambuf_iterator<char>(loadStream), std::istreambuf_iterator<char>());
+		LoadState(_stateBuffer.data(), (uint32_t)_stateBuffer.size(), stateVersion);
+	}
+}
+
+void Console::LoadState(const uint8_t *buffer, uint32_t bufferSize)
+{
+	LoadState(buffer, bufferSize, SaveStateManager::FileFormatVersion);
+}
+
+uint32_t Console::LoadState(const uint8_t *buffer, uint32_t bufferSize, uint32_t stateVersion)
+{
+	uint32_t position = 0;
 	if(_initialized) {
 		//Send any unprocessed sound to the SoundMixer - needed for rewind
 		_apu->EndFrame();
 
-		_cpu->LoadSnapshot(&loadStream, stateVersion);
-		_ppu->LoadSnapshot(&loadStream, stateVersion);
-		_memoryManager->LoadSnapshot(&loadStream, stateVersion);
-		_apu->LoadSnapshot(&loadStream, stateVersion);
-		_controlManager->LoadSnapshot(&loadStream, stateVersion);
-		_mapper->LoadSnapshot(&loadStream, stateVersion);
+		position += _cpu->LoadSnapshot(buffer + position, bufferSize - position, stateVersion);
+		position += _ppu->LoadSnapshot(buffer + position, bufferSize - position, stateVersion);
+		position += _memoryManager->LoadSnapshot(buffer + position, bufferSize - position, stateVersion);
+		position += _apu->LoadSnapshot(buffer + position, bufferSize - position, stateVersion);
+		position += _controlManager->LoadSnapshot(buffer + position, bufferSize - position, stateVersion);
+		position += _mapper->LoadSnapshot(buffer + position, bufferSize - position, stateVersion);
 		if(_hdAudioDevice) {
-			_hdAudioDevice->LoadSnapshot(&loadStream, stateVersion);
+			position += _hdAudioDevice->LoadSnapshot(buffer + position, bufferSize - position, stateVersion);
 		} else {
-			Snapshotable::SkipBlock(&loadStream);
+			position += Snapshotable::SkipBlock(buffer + position, bufferSize - position);
 		}
 
 		if(_slave) {
 			//For VS Dualsystem, the slave console's savestate is appended to the end of the file
-			_slave->LoadState(loadStream, stateVersion);
+			position += _slave->LoadState(buffer + position, bufferSize - position, stateVersion);
 		}
 		
 		shared_ptr<Debugger> debugger = _debugger;
@@ -1136,14 +1190,7 @@ void Console::LoadState(istream &loadStream, uint32_t stateVersion)
 		_notificationManager->SendNotification(ConsoleNotificationType::StateLoaded);
 		UpdateNesModel(false);
 	}
-}
-
-void Console::LoadState(uint8_t *buffer, uint32_t bufferSize)
-{
-	stringstream stream;
-	stream.write((char*)buffer, bufferSize);
-	stream.seekg(0, ios::beg);
-	LoadState(stream);
+	return position;
 }
 
 std::shared_ptr<Debugger> Console::GetDebugger(bool autoStart)
@@ -1156,6 +1203,7 @@ std::shared_ptr<Debugger> Console::GetDebugger(bool autoStart)
 		if(!debugger) {
 			debugger.reset(new Debugger(shared_from_this(), _cpu, _ppu, _apu, _memoryManager, _mapper));
 			_debugger = debugger;
+			UpdateMemoryHooks();
 		}
 	}
 	return debugger;
@@ -1167,6 +1215,7 @@ void Console::StopDebugger()
 		_debugger->ReleaseDebugger(_running);
 	}
 	_debugger.reset();
+	UpdateMemoryHooks();
 }
 
 std::thread::id Console::GetEmulationThreadId()
@@ -1191,6 +1240,28 @@ bool Console::IsDebuggerAttached()
 	return (bool)_debugger;
 }
 
+void Console::UpdateMemoryHooks()
+{
+	_memoryHooks = _memoryFastPathDisabled || _debugger || (_cheatManager && _cheatManager->HasCodes());
+}
+
+void Console::DisableMemoryFastPath(bool disabled)
+{
+	//Used by benchmarks to compare both memory access paths
+	_memoryFastPathDisabled = disabled;
+	UpdateMemoryHooks();
+}
+
+bool Console::IsPpuBatchingAllowed()
+{
+	//OAM decay depends on the CPU's cycle count when the PPU reads sprite RAM, so the PPU can't run behind the CPU when it's enabled
+	return (
+		_settings->CheckFlag(EmulationFlags::BatchPpuRendering) &&
+		!_settings->CheckFlag(EmulationFlags::EnableOamDecay) &&
+		_mapper->AllowPpuBatching()
+	);
+}
+
 void Console::SetNextFrameOverclockStatus(bool disabled)
 {
 	_disableOcNextFrame = disabled;
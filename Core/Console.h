@@ -97,10 +97,22 @@ private:
 
 	bool _disableOcNextFrame = false;
 
+	bool _memoryHooks = false;
+	bool _memoryFastPathDisabled = false;
+
 	bool _initialized = false;
 	std::thread::id _emulationThreadId;
 
-	void RunFrameWithRunAhead(std::stringstream& runAheadState);
+	//Reused by the stream-based save/load state functions to avoid reallocating on every call
+	vector<uint8_t> _stateBuffer;
+
+	//State slot used by run-ahead, saved/restored every frame (allocated once, grows if needed)
+	vector<uint8_t> _runAheadState;
+	uint32_t _runAheadStateSize = 0;
+
+	uint32_t SerializeState(uint8_t *buffer, uint32_t bufferSize);
+
+	void RunFrameWithRunAhead();
 
 	void LoadHdPack(VirtualFile &romFile, VirtualFile &patchFile);
 
@@ -196,9 +208,11 @@ public:
 	void StopDebugger();
 
 	void SaveState(ostream &saveStream);
+	uint32_t SaveState(uint8_t *buffer, uint32_t bufferSize);
 	void LoadState(istream &loadStream);
 	void LoadState(istream &loadStream, uint32_t stateVersion);
-	void LoadState(uint8_t *buffer, uint32_t bufferSize);
+	void LoadState(const uint8_t *buffer, uint32_t bufferSize);
+	uint32_t LoadState(const uint8_t *buffer, uint32_t bufferSize, uint32_t stateVersion);
 
 	VirtualFile GetRomPath();
 	VirtualFile GetPatchFile();
@@ -221,6 +235,12 @@ public:
 
 	bool IsDebuggerAttached();
 
+	//When false, CPU memory accesses skip the cheat/debugger hooks (see MemoryManager::FastRead)
+	bool HasMemoryHooks() { return _memoryHooks; }
+	void UpdateMemoryHooks();
+	void DisableMemoryFastPath(bool disabled);
+	bool IsPpuBatchingAllowed();
+
 	double GetFps();
 
 	void InitializeRam(void* data, uint32_t length);
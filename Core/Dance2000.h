@@ -29,6 +29,8 @@ protected:
 		Stream(_mode, _prgReg, _lastNt);
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		if(_mode & 0x02) {
@@ -98,6 +98,7 @@ Debugger::Debugger(shared_ptr<Console> console, shared_ptr<CPU> cpu, shared_ptr<
 	_ppuScrollY = 0;
 
 	_flags = 0;
+	_enabledFeatures = (uint32_t)DebuggerFeatures::All;
 
 	_runToCycle = -1;
 	_prevInstructionCycle = -1;
@@ -115,7 +116,10 @@ Debugger::Debugger(shared_ptr<Console> console, shared_ptr<CPU> cpu, shared_ptr<
 
 	_frozenAddresses.insert(_frozenAddresses.end(), 0x10000, 0);
 
-	if(!LoadCdlFile(FolderUtilities::CombinePath(FolderUtilities::GetDebuggerFolder(), FolderUtilities::GetFilename(_romName, false) + ".cdl"))) {
+	//Only the UI's debugger uses the game's default CDL file - debuggers started without the UI (batch jobs, tests) would overwrite it
+	//with their own data, they open their own CDL file when they need one
+	bool consoleMode = _console->GetSettings()->CheckFlag(EmulationFlags::ConsoleMode);
+	if(consoleMode || !OpenCdlFile(FolderUtilities::CombinePath(FolderUtilities::GetDebuggerFolder(), FolderUtilities::GetFilename(_romName, false) + ".cdl"))) {
 		_disassembler->Reset();
 	}
 
@@ -138,7 +142,7 @@ void Debugger::ReleaseDebugger(bool needPause)
 {
 	auto lock = _releaseLock.AcquireSafe();
 	if(!_released) {
-		_codeDataLogger->SaveCdlFile(FolderUtilities::CombinePath(FolderUtilities::GetDebuggerFolder(), FolderUtilities::GetFilename(_romName, false) + ".cdl"));
+		_codeDataLogger->FlushCdlFile();
 
 		_stopFlag = true;
 
@@ -210,23 +214,88 @@ bool Debugger::CheckFlag(DebuggerFlags flag)
 	return (_flags & (uint32_t)flag) == (uint32_t)flag;
 }
 
+void Debugger::SetEnabledFeatures(uint32_t features)
+{
+	DebugBreakHelper helper(this);
+
+	uint32_t enabledFeatures = features & ~_enabledFeatures;
+	_enabledFeatures = features;
+
+	if(enabledFeatures & (uint32_t)DebuggerFeatures::CodeDataLogger) {
+		//Code may have been written to RAM (or executed) while the disassembly cache was not being updated
+		UpdateCdlCache();
+	}
+	if(enabledFeatures & (uint32_t)DebuggerFeatures::MemoryAccessCounter) {
+		//Writes were not counted while the counters were disabled, reads can't be reported as uninitialized anymore
+		_enableBreakOnUninitRead = false;
+	}
+	if(enabledFeatures & (uint32_t)DebuggerFeatures::Profiler) {
+		//The profiler's call stack is out of sync with the code's
+		_profiler->Reset();
+	}
+
+	UpdateFeatures();
+}
+
+void Debugger::UpdateFeatures()
+{
+	bool breakpointsEnabled = CheckFeature(DebuggerFeatures::Breakpoints);
+	for(int i = 0; i < Debugger::BreakpointTypeCount; i++) {
+		_hasBreakpoint[i] = breakpointsEnabled && !_breakpoints[i].empty();
+	}
+
+	_hasScript = CheckFeature(DebuggerFeatures::Scripts) && !_scripts.empty();
+}
+
 bool Debugger::LoadCdlFile(string cdlFilepath)
 {
+	DebugBreakHelper helper(this);
 	if(_codeDataLogger->LoadCdlFile(cdlFilepath)) {
-		//Can't use DebugBreakHelper due to the fact this is called in the constructor
-		bool isEmulationThread = _console->GetEmulationThreadId() == std::this_thread::get_id();
-		if(!isEmulationThread) {
-			_console->Pause();
-		}
 		UpdateCdlCache();
-		if(!isEmulationThread) {
-			_console->Resume();
-		}
 		return true;
 	}
 	return false;
 }
 
+bool Debugger::SaveCdlFile(string cdlFilepath)
+{
+	DebugBreakHelper helper(this);
+	return _codeDataLogger->SaveCdlFile(cdlFilepath);
+}
+
+bool Debugger::OpenCdlFile(string cdlFilepath)
+{
+	if(_codeDataLogger->OpenCdlFile(cdlFilepath)) {
+		RefreshCdlCache();
+		return true;
+	}
+	return false;
+}
+
+bool Debugger::MergeCdlFile(string cdlFilepath)
+{
+	//The emulation thread must not set flags (and update the stats) while the data is being merged
+	DebugBreakHelper helper(this);
+	if(_codeDataLogger->MergeCdlFile(cdlFilepath)) {
+		UpdateCdlCache();
+		return true;
+	}
+	return false;
+}
+
+void Debugger::RefreshCdlCache()
+{
+	//Can't use DebugBreakHelper due to the fact this is called in the constructor
+	bool isEmulationThread = _console->GetEmulationThreadId() == std::this_thread::get_id();
+	if(!isEmulationThread) {
+		_console->Pause();
+	}
+	UpdateCdlCache();
+	if(!isEmulationThread) {
+		_console->Resume();
+	}
+}
+
 void Debugger::SetCdlData(uint8_t* cdlData, uint32_t length)
 {
 	DebugBreakHelper helper(this);
@@ -324,14 +393,25 @@ void Debugger::SetBreakpoints(Breakpoint breakpoints[], uint32_t length)
 					_bpDummyCpuRequired |= isReadWriteBp;
 				}
 
-				_hasBreakpoint[i] = true;
 			}
 		}
 	}
+
+	UpdateFeatures();
+
+	for(int i = 0; i < Debugger::BreakpointTypeCount; i++) {
+		bool isPpuBreakpoint = i == BreakpointType::ReadVram || i == BreakpointType::WriteVram;
+		_breakpointIndex[i].Build(_breakpoints[i], isPpuBreakpoint);
+	}
 }
 
 bool Debugger::ProcessBreakpoints(BreakpointType type, OperationInfo &operationInfo, bool allowBreak, bool allowMark)
 {
+	if(type != BreakpointType::Global && !_breakpointIndex[(int)type].MayMatch(operationInfo.Address)) {
+		//No breakpoint can match this address
+		return false;
+	}
+
 	//Disable breakpoints if debugger window is closed
 	allowBreak &= _console->GetSettings()->CheckFlag(EmulationFlags::DebuggerWindowEnabled);
 
@@ -385,7 +465,14 @@ bool Debugger::ProcessBreakpoints(BreakpointType type, OperationInfo &operationI
 		}
 	};
 
-	for(size_t i = 0, len = breakpoints.size(); i < len; i++) {
+	//Only the breakpoints whose address range contains the address need to be checked
+	BreakpointIndex &index = _breakpointIndex[(int)type];
+	if(type != BreakpointType::Global) {
+		index.GetCandidates(operationInfo.Address, isPpuBreakpoint ? ppuInfo.Address : info.Address, _breakpointCandidates);
+	}
+	vector<uint32_t> &candidates = type == BreakpointType::Global ? index.GetAllBreakpoints() : _breakpointCandidates;
+
+	for(uint32_t i : candidates) {
 		Breakpoint &breakpoint = breakpoints[i];
 
 		if(
@@ -438,7 +525,7 @@ void Debugger::ProcessAllBreakpoints(OperationInfo &operationInfo)
 		ProcessBreakpoints(BreakpointType::Execute, operationInfo, true, true);
 	}
 
-	bool checkUninitReads = _enableBreakOnUninitRead && CheckFlag(DebuggerFlags::BreakOnUninitMemoryRead);
+	bool checkUninitReads = _enableBreakOnUninitRead && CheckFlag(DebuggerFlags::BreakOnUninitMemoryRead) && CheckFeature(DebuggerFeatures::MemoryAccessCounter);
 
 	if(!checkUninitReads && !_bpDummyCpuRequired) {
 		//Nothing to do, no read/write breakpoints are active and don't need to check uninit reads
@@ -585,7 +672,9 @@ void Debugger::UpdateCallstack(uint8_t instruction, uint32_t addr)
 						for(int j = (int)_callstack.size() - i - 1; j >= 0; j--) {
 							_callstack.pop_back();
 							_subReturnAddresses.pop_back();
-							_profiler->UnstackFunction();
+							if(CheckFeature(DebuggerFeatures::Profiler)) {
+								_profiler->UnstackFunction();
+							}
 						}
 						break;
 					}
@@ -598,16 +687,20 @@ void Debugger::UpdateCallstack(uint8_t instruction, uint32_t addr)
 			}
 		}
 
-		_profiler->UnstackFunction();
+		if(CheckFeature(DebuggerFeatures::Profiler)) {
+			_profiler->UnstackFunction();
+		}
 	} else if(instruction == 0x20) {
 		//JSR
 		uint16_t targetAddr = _memoryManager->DebugRead(addr + 1) | (_memoryManager->DebugRead(addr + 2) << 8);
 		AddCallstackFrame(addr, targetAddr, StackFrameFlags::None);
 		_subReturnAddresses.push_back(addr + 3);
 		
-		AddressTypeInfo dest;
-		_mapper->GetAbsoluteAddressAndType(targetAddr, &dest);
-		_profiler->StackFunction(dest, StackFrameFlags::None);
+		if(CheckFeature(DebuggerFeatures::Profiler)) {
+			AddressTypeInfo dest;
+			_mapper->GetAbsoluteAddressAndType(targetAddr, &dest);
+			_profiler->StackFunction(dest, StackFrameFlags::None);
+		}
 	}
 }
 
@@ -636,9 +729,11 @@ void Debugger::ProcessInterrupt(uint16_t cpuAddr, uint16_t destCpuAddr, bool for
 	AddCallstackFrame(cpuAddr, destCpuAddr, forNmi ? StackFrameFlags::Nmi : StackFrameFlags::Irq);
 	_subReturnAddresses.push_back(cpuAddr);
 
-	AddressTypeInfo addressInfo;
-	_mapper->GetAbsoluteAddressAndType(destCpuAddr, &addressInfo);
-	_profiler->StackFunction(addressInfo, forNmi ? StackFrameFlags::Nmi : StackFrameFlags::Irq);
+	if(CheckFeature(DebuggerFeatures::Profiler)) {
+		AddressTypeInfo addressInfo;
+		_mapper->GetAbsoluteAddressAndType(destCpuAddr, &addressInfo);
+		_profiler->StackFunction(addressInfo, forNmi ? StackFrameFlags::Nmi : StackFrameFlags::Irq);
+	}
 
 	ProcessEvent(forNmi ? EventType::Nmi : EventType::Irq);
 }
@@ -706,7 +801,9 @@ bool Debugger::ProcessRamOperation(MemoryOperationType type, uint16_t &addr, uin
 		//Used to flag the data in the CDL file
 		isDmcRead = true;
 		type = MemoryOperationType::Read;
-		_eventManager->AddDebugEvent(DebugEventType::DmcDmaRead, addr, value);
+		if(CheckFeature(DebuggerFeatures::EventViewer)) {
+			_eventManager->AddDebugEvent(DebugEventType::DmcDmaRead, addr, value);
+		}
 	}
 
 	ProcessCpuOperation(addr, value, type);
@@ -764,10 +861,14 @@ bool Debugger::ProcessRamOperation(MemoryOperationType type, uint16_t &addr, uin
 
 	//Check if a breakpoint has been hit and freeze execution if one has
 	bool breakDone = false;
-	AddressTypeInfo addressInfo;
-	GetAbsoluteAddressAndType(addr, &addressInfo);
+	bool cdlEnabled = CheckFeature(DebuggerFeatures::CodeDataLogger);
+	AddressTypeInfo addressInfo { -1, AddressType::InternalRam };
+	if(_enabledFeatures & ((uint32_t)DebuggerFeatures::CodeDataLogger | (uint32_t)DebuggerFeatures::MemoryAccessCounter | (uint32_t)DebuggerFeatures::Profiler)) {
+		//The absolute address is only needed by these subsystems (breakpoints calculate it when an address matches)
+		GetAbsoluteAddressAndType(addr, &addressInfo);
+	}
 	int32_t absoluteAddr = addressInfo.Type == AddressType::PrgRom ? addressInfo.Address : -1;
-	if(addressInfo.Type == AddressType::PrgRom && addressInfo.Address >= 0 && type != MemoryOperationType::DummyRead && type != MemoryOperationType::DummyWrite && _runToCycle == -1) {
+	if(cdlEnabled && addressInfo.Type == AddressType::PrgRom && addressInfo.Address >= 0 && type != MemoryOperationType::DummyRead && type != MemoryOperationType::DummyWrite && _runToCycle == -1) {
 		if(type == MemoryOperationType::ExecOperand) {
 			_codeDataLogger->SetFlag(absoluteAddr, CdlPrgFlags::Code);
 		} else if(type == MemoryOperationType::Read) {
@@ -783,11 +884,11 @@ bool Debugger::ProcessRamOperation(MemoryOperationType type, uint16_t &addr, uin
 		_prevInstructionCycle = _curInstructionCycle;
 		_curInstructionCycle = (int64_t)_cpu->GetCycleCount();
 
-		if(absoluteAddr >= 0) {
+		if(cdlEnabled && absoluteAddr >= 0) {
 			_codeDataLogger->SetFlag(absoluteAddr, CdlPrgFlags::Code);
 		}
 
-		if(addressInfo.Address >= 0) {
+		if(cdlEnabled && addressInfo.Address >= 0) {
 			_disassembler->BuildCache(addressInfo, addr, false, true);
 
 			if(_disassembler->IsJump(value)) {
@@ -807,7 +908,9 @@ bool Debugger::ProcessRamOperation(MemoryOperationType type, uint16_t &addr, uin
 					}
 				}
 			}
+		}
 
+		if(CheckFeature(DebuggerFeatures::Profiler) && addressInfo.Address >= 0) {
 			_performanceTracker->ProcessCpuExec(addressInfo);
 		}
 
@@ -844,20 +947,24 @@ bool Debugger::ProcessRamOperation(MemoryOperationType type, uint16_t &addr, uin
 
 		GetState(&_debugState, false);
 
-		DisassemblyInfo disassemblyInfo;
-		if(_codeRunner && _codeRunner->IsRunning() && addr >= 0x3000 && addr < 0x4000) {
-			disassemblyInfo = _codeRunner->GetDisassemblyInfo(addr);
-		} else {
-			if(addressInfo.Address >= 0) {
-				disassemblyInfo = _disassembler->GetDisassemblyInfo(addressInfo);
+		if(CheckFeature(DebuggerFeatures::TraceLogger)) {
+			DisassemblyInfo disassemblyInfo;
+			if(_codeRunner && _codeRunner->IsRunning() && addr >= 0x3000 && addr < 0x4000) {
+				disassemblyInfo = _codeRunner->GetDisassemblyInfo(addr);
 			} else {
-				disassemblyInfo.Initialize(addr, _memoryManager.get(), false);
+				if(cdlEnabled && addressInfo.Address >= 0) {
+					disassemblyInfo = _disassembler->GetDisassemblyInfo(addressInfo);
+				} else {
+					disassemblyInfo.Initialize(addr, _memoryManager.get(), false);
+				}
 			}
+			_traceLogger->Log(_debugState, disassemblyInfo, operationInfo);
 		}
-		_traceLogger->Log(_debugState, disassemblyInfo, operationInfo);
 	} else {
 		_opCodeCycle++;
-		_traceLogger->LogNonExec(operationInfo);
+		if(CheckFeature(DebuggerFeatures::TraceLogger)) {
+			_traceLogger->LogNonExec(operationInfo);
+		}
 	}
 
 	if(!breakDone && _stepCycleCount > 0) {
@@ -897,43 +1004,49 @@ bool Debugger::ProcessRamOperation(MemoryOperationType type, uint16_t &addr, uin
 	_currentReadValue = nullptr;
 
 	if(type == MemoryOperationType::Write) {
-		if(_runToCycle == -1 && !CheckFlag(DebuggerFlags::IgnoreRedundantWrites) || _memoryManager->DebugRead(addr) != value) {
+		if(CheckFeature(DebuggerFeatures::MemoryAccessCounter) && (_runToCycle == -1 && !CheckFlag(DebuggerFlags::IgnoreRedundantWrites) || _memoryManager->DebugRead(addr) != value)) {
 			_memoryAccessCounter->ProcessMemoryWrite(addressInfo, _cpu->GetCycleCount());
 		}
 
-		_disassembler->InvalidateCache(addressInfo);
+		if(cdlEnabled) {
+			_disassembler->InvalidateCache(addressInfo);
+		}
 
-		if(addr >= 0x2000 && addr <= 0x3FFF) {
-			if((addr & 0x07) == 5 || (addr & 0x07) == 6) {
-				GetState(&_debugState, false);
-				_eventManager->AddDebugEvent(DebugEventType::PpuRegisterWrite, addr, value, -1, _debugState.PPU.State.WriteToggle ? 1 : 0);
-			} else {
-				_eventManager->AddDebugEvent(DebugEventType::PpuRegisterWrite, addr, value);
+		if(CheckFeature(DebuggerFeatures::EventViewer)) {
+			if(addr >= 0x2000 && addr <= 0x3FFF) {
+				if((addr & 0x07) == 5 || (addr & 0x07) == 6) {
+					GetState(&_debugState, false);
+					_eventManager->AddDebugEvent(DebugEventType::PpuRegisterWrite, addr, value, -1, _debugState.PPU.State.WriteToggle ? 1 : 0);
+				} else {
+					_eventManager->AddDebugEvent(DebugEventType::PpuRegisterWrite, addr, value);
+				}
+			} else if(addr >= 0x4018 && _mapper->IsWriteRegister(addr)) {
+				_eventManager->AddDebugEvent(DebugEventType::MapperRegisterWrite, addr, value);
+			} else if(addr >= 0x4000 && addr <= 0x4015 || addr == 0x4017) {
+				_eventManager->AddDebugEvent(DebugEventType::ApuRegisterWrite, addr, value);
+			} else if(addr == 0x4016) {
+				_eventManager->AddDebugEvent(DebugEventType::ControlRegisterWrite, addr, value);
 			}
-		} else if(addr >= 0x4018 && _mapper->IsWriteRegister(addr)) {
-			_eventManager->AddDebugEvent(DebugEventType::MapperRegisterWrite, addr, value);
-		} else if(addr >= 0x4000 && addr <= 0x4015 || addr == 0x4017) {
-			_eventManager->AddDebugEvent(DebugEventType::ApuRegisterWrite, addr, value);
-		} else if(addr == 0x4016) {
-			_eventManager->AddDebugEvent(DebugEventType::ControlRegisterWrite, addr, value);
 		}
 
 		if(_frozenAddresses[addr]) {
 			return false;
 		}
 	} else if(type == MemoryOperationType::Read) {
-		if(addr >= 0x2000 && addr <= 0x3FFF) {
-			_eventManager->AddDebugEvent(DebugEventType::PpuRegisterRead, addr, value);
-		} else if(addr >= 0x4018 && _mapper->IsReadRegister(addr)) {
-			_eventManager->AddDebugEvent(DebugEventType::MapperRegisterRead, addr, value);
-		} else if(addr >= 0x4000 && addr <= 0x4015) {
-			_eventManager->AddDebugEvent(DebugEventType::ApuRegisterRead, addr, value);
-		} else if(addr == 0x4016 || addr == 0x4017) {
-			_eventManager->AddDebugEvent(DebugEventType::ControlRegisterRead, addr, value);
+		if(CheckFeature(DebuggerFeatures::EventViewer)) {
+			if(addr >= 0x2000 && addr <= 0x3FFF) {
+				_eventManager->AddDebugEvent(DebugEventType::PpuRegisterRead, addr, value);
+			} else if(addr >= 0x4018 && _mapper->IsReadRegister(addr)) {
+				_eventManager->AddDebugEvent(DebugEventType::MapperRegisterRead, addr, value);
+			} else if(addr >= 0x4000 && addr <= 0x4015) {
+				_eventManager->AddDebugEvent(DebugEventType::ApuRegisterRead, addr, value);
+			} else if(addr == 0x4016 || addr == 0x4017) {
+				_eventManager->AddDebugEvent(DebugEventType::ControlRegisterRead, addr, value);
+			}
 		}
 
 		//Ignore dummy read/writes and do not change counters while using the step back feature
-		if(_runToCycle == -1 && _memoryAccessCounter->ProcessMemoryRead(addressInfo, _cpu->GetCycleCount())) {
+		if(_runToCycle == -1 && CheckFeature(DebuggerFeatures::MemoryAccessCounter) && _memoryAccessCounter->ProcessMemoryRead(addressInfo, _cpu->GetCycleCount())) {
 			if(!breakDone && !_breakOnFirstCycle && _enableBreakOnUninitRead && CheckFlag(DebuggerFlags::BreakOnUninitMemoryRead)) {
 				//Break on uninit memory read
 				Step(1);
@@ -941,7 +1054,7 @@ bool Debugger::ProcessRamOperation(MemoryOperationType type, uint16_t &addr, uin
 			}
 		}
 	} else {
-		if(_runToCycle == -1 && (type == MemoryOperationType::ExecOpCode || type == MemoryOperationType::ExecOperand)) {
+		if(_runToCycle == -1 && CheckFeature(DebuggerFeatures::MemoryAccessCounter) && (type == MemoryOperationType::ExecOpCode || type == MemoryOperationType::ExecOperand)) {
 			_memoryAccessCounter->ProcessMemoryExec(addressInfo, _cpu->GetCycleCount());
 		}
 		if(!_needRewind && type == MemoryOperationType::ExecOpCode) {
@@ -1015,28 +1128,38 @@ bool Debugger::SleepUntilResume(BreakSource source, uint32_t breakpointId, Break
 
 void Debugger::ProcessVramReadOperation(MemoryOperationType type, uint16_t addr, uint8_t &value)
 {
+	bool cdlEnabled = CheckFeature(DebuggerFeatures::CodeDataLogger);
+	bool countersEnabled = CheckFeature(DebuggerFeatures::MemoryAccessCounter);
+
 	PpuAddressTypeInfo addressInfo;
-	_mapper->GetPpuAbsoluteAddressAndType(addr, &addressInfo);
-	_codeDataLogger->SetFlag(addressInfo.Address, type == MemoryOperationType::Read ? CdlChrFlags::Read : CdlChrFlags::Drawn);
+	if(cdlEnabled || countersEnabled) {
+		_mapper->GetPpuAbsoluteAddressAndType(addr, &addressInfo);
+	}
+	if(cdlEnabled) {
+		_codeDataLogger->SetFlag(addressInfo.Address, type == MemoryOperationType::Read ? CdlChrFlags::Read : CdlChrFlags::Drawn);
+	}
 
 	if(_hasBreakpoint[BreakpointType::ReadVram]) {
 		OperationInfo operationInfo{ addr, value, type };
 		ProcessBreakpoints(BreakpointType::ReadVram, operationInfo, !_breakOnFirstCycle, true);
 	}
-	_memoryAccessCounter->ProcessPpuMemoryRead(addressInfo, _cpu->GetCycleCount());
+	if(countersEnabled) {
+		_memoryAccessCounter->ProcessPpuMemoryRead(addressInfo, _cpu->GetCycleCount());
+	}
 	ProcessPpuOperation(addr, value, MemoryOperationType::Read);
 }
 
 void Debugger::ProcessVramWriteOperation(uint16_t addr, uint8_t &value)
 {
-	PpuAddressTypeInfo addressInfo;
-	_mapper->GetPpuAbsoluteAddressAndType(addr, &addressInfo);
-
 	if(_hasBreakpoint[BreakpointType::WriteVram]) {
 		OperationInfo operationInfo{ addr, value, MemoryOperationType::Write };
 		ProcessBreakpoints(BreakpointType::WriteVram, operationInfo, !_breakOnFirstCycle, true);
 	}
-	_memoryAccessCounter->ProcessPpuMemoryWrite(addressInfo, _cpu->GetCycleCount());
+	if(CheckFeature(DebuggerFeatures::MemoryAccessCounter)) {
+		PpuAddressTypeInfo addressInfo;
+		_mapper->GetPpuAbsoluteAddressAndType(addr, &addressInfo);
+		_memoryAccessCounter->ProcessPpuMemoryWrite(addressInfo, _cpu->GetCycleCount());
+	}
 	ProcessPpuOperation(addr, value, MemoryOperationType::Write);
 }
 
@@ -1504,7 +1627,7 @@ int Debugger::LoadScript(string name, string content, int32_t scriptId)
 		shared_ptr<ScriptHost> script(new ScriptHost(_nextScriptId++));
 		script->LoadScript(name, content, this);
 		_scripts.push_back(script);
-		_hasScript = true;
+		UpdateFeatures();
 		return script->GetScriptId();
 	} else {
 		auto result = std::find_if(_scripts.begin(), _scripts.end(), [=](shared_ptr<ScriptHost> &script) {
@@ -1535,7 +1658,7 @@ void Debugger::RemoveScript(int32_t scriptId)
 		}
 		return false;
 	}), _scripts.end());
-	_hasScript = _scripts.size() > 0;
+	UpdateFeatures();
 }
 
 const char* Debugger::GetScriptLog(int32_t scriptId)
@@ -1627,7 +1750,9 @@ void Debugger::ProcessEvent(EventType type)
 			break;
 
 		case EventType::EndFrame:
-			_performanceTracker->ProcessEndOfFrame();
+			if(CheckFeature(DebuggerFeatures::Profiler)) {
+				_performanceTracker->ProcessEndOfFrame();
+			}
 			_memoryDumper->GatherChrPaletteInfo();
 			break;
 
@@ -1643,9 +1768,24 @@ void Debugger::ProcessEvent(EventType type)
 			_eventManager->ClearFrameEvents();
 			break;
 
-		case EventType::Nmi: _eventManager->AddDebugEvent(DebugEventType::Nmi); break;
-		case EventType::Irq: _eventManager->AddDebugEvent(DebugEventType::Irq); break;
-		case EventType::SpriteZeroHit: _eventManager->AddDebugEvent(DebugEventType::SpriteZeroHit); break;
+		case EventType::Nmi:
+			if(CheckFeature(DebuggerFeatures::EventViewer)) {
+				_eventManager->AddDebugEvent(DebugEventType::Nmi);
+			}
+			break;
+
+		case EventType::Irq:
+			if(CheckFeature(DebuggerFeatures::EventViewer)) {
+				_eventManager->AddDebugEvent(DebugEventType::Irq);
+			}
+			break;
+
+		case EventType::SpriteZeroHit:
+			if(CheckFeature(DebuggerFeatures::EventViewer)) {
+				_eventManager->AddDebugEvent(DebugEventType::SpriteZeroHit);
+			}
+			break;
+
 		case EventType::Reset: _enableBreakOnUninitRead = true; break;
 
 		case EventType::BusConflict: 
@@ -10,6 +10,7 @@ using std::unordered_set;
 
 #include "../Utilities/SimpleLock.h"
 #include "DebuggerTypes.h"
+#include "BreakpointIndex.h"
 
 class CPU;
 class APU;
@@ -79,6 +80,8 @@ private:
 	atomic<int32_t> _suspendCount;
 	vector<Breakpoint> _breakpoints[BreakpointTypeCount];
 	vector<ExpressionData> _breakpointRpnList[BreakpointTypeCount];
+	BreakpointIndex _breakpointIndex[BreakpointTypeCount];
+	vector<uint32_t> _breakpointCandidates;
 	bool _hasBreakpoint[BreakpointTypeCount] = {};
 
 	vector<uint8_t> _frozenAddresses;
@@ -106,6 +109,7 @@ private:
 	uint16_t _returnToAddress;
 
 	uint32_t _flags;
+	uint32_t _enabledFeatures;
 
 	string _romName;
 	atomic<int32_t> _stepCount;
@@ -154,6 +158,8 @@ private:
 
 	void UpdatePpuCyclesToProcess();
 	void ResetStepState();
+	void UpdateFeatures();
+	void RefreshCdlCache();
 
 public:
 	Debugger(shared_ptr<Console> console, shared_ptr<CPU> cpu, shared_ptr<PPU> ppu, shared_ptr<APU> apu, shared_ptr<MemoryManager> memoryManager, shared_ptr<BaseMapper> mapper);
@@ -166,6 +172,13 @@ public:
 
 	void SetFlags(uint32_t flags);
 	bool CheckFlag(DebuggerFlags flag);
+
+	//Only the subsystems in this mask instrument memory accesses (all of them are enabled by default)
+	void SetEnabledFeatures(uint32_t features);
+	bool CheckFeature(DebuggerFeatures feature)
+	{
+		return (_enabledFeatures & (uint32_t)feature) != 0;
+	}
 	
 	void SetBreakpoints(Breakpoint breakpoints[], uint32_t length);
 
@@ -199,6 +212,9 @@ public:
 	void BreakOnScanline(int16_t scanline);
 
 	bool LoadCdlFile(string cdlFilepath);
+	bool SaveCdlFile(string cdlFilepath);
+	bool OpenCdlFile(string cdlFilepath);
+	bool MergeCdlFile(string cdlFilepath);
 	void SetCdlData(uint8_t* cdlData, uint32_t length);
 	void ResetCdl();
 	void UpdateCdlCache();
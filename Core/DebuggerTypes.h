@@ -45,6 +45,21 @@ enum class DebuggerFlags
 	BreakOnBusConflict = 0x40000,
 };
 
+//Subsystems that instrument memory accesses - the ones that aren't enabled (because no tool uses them) are skipped entirely
+enum class DebuggerFeatures
+{
+	None = 0x00,
+	CodeDataLogger = 0x01, //CDL file, disassembly cache, function entry points
+	MemoryAccessCounter = 0x02, //Access counters/timestamps, uninitialized read detection
+	Breakpoints = 0x04,
+	TraceLogger = 0x08,
+	Scripts = 0x10,
+	Profiler = 0x20, //Profiler and performance tracker
+	EventViewer = 0x40,
+
+	All = 0x7F
+};
+
 enum class BreakSource
 {
 	Unspecified = -1,
@@ -10,6 +10,7 @@
 
 DefaultVideoFilter::DefaultVideoFilter(shared_ptr<Console> console) : BaseVideoFilter(console)
 {
+	memset(_sourcePalette, 0, sizeof(_sourcePalette));
 	InitConversionMatrix(_pictureSettings.Hue, _pictureSettings.Saturation);
 }
 
@@ -44,19 +45,47 @@ FrameInfo DefaultVideoFilter::GetFrameInfo()
 
 void DefaultVideoFilter::OnBeforeApplyFilter()
 {
+	//The palettes and the expander's lookup tables are only rebuilt when the palette or the picture settings change
 	PictureSettings currentSettings = _console->GetSettings()->GetPictureSettings();
 	if(_pictureSettings.Hue != currentSettings.Hue || _pictureSettings.Saturation != currentSettings.Saturation) {
 		InitConversionMatrix(currentSettings.Hue, currentSettings.Saturation);
+		_needPaletteUpdate = true;
+	}
+	if(_pictureSettings.Brightness != currentSettings.Brightness || _pictureSettings.Contrast != currentSettings.Contrast) {
+		_needPaletteUpdate = true;
 	}
 	_pictureSettings = currentSettings;
-	_needToProcess = _pictureSettings.Hue != 0 || _pictureSettings.Saturation != 0 || _pictureSettings.Brightness || _pictureSettings.Contrast;
 
-	if(_needToProcess) {
-		double y, i, q;
-		uint32_t* originalPalette = _console->GetSettings()->GetRgbPalette();
+	uint32_t* rgbPalette = _console->GetSettings()->GetRgbPalette();
+	if(memcmp(_sourcePalette, rgbPalette, sizeof(_sourcePalette)) != 0) {
+		memcpy(_sourcePalette, rgbPalette, sizeof(_sourcePalette));
+		_needPaletteUpdate = true;
+	}
 
+	bool paletteChanged = _needPaletteUpdate;
+	if(_needPaletteUpdate) {
+		UpdateCalculatedPalette();
+		_needPaletteUpdate = false;
+	}
+
+	//Scanlines are drawn with a darkened copy of the palette, so every row is decoded with a plain palette lookup
+	uint8_t scanlineIntensity = (uint8_t)((1.0 - _pictureSettings.ScanlineIntensity) * 255);
+	if(scanlineIntensity < 0xFF && (paletteChanged || scanlineIntensity != _scanlineIntensity)) {
 		for(int pal = 0; pal < 512; pal++) {
-			uint32_t pixelOutput = originalPalette[pal];
+			_scanlinePalette[pal] = ApplyScanlineEffect(pal, scanlineIntensity);
+		}
+		_scanlineExpander.SetPalette(_scanlinePalette);
+	}
+	_scanlineIntensity = scanlineIntensity;
+}
+
+void DefaultVideoFilter::UpdateCalculatedPalette()
+{
+	bool needToProcess = _pictureSettings.Hue != 0 || _pictureSettings.Saturation != 0 || _pictureSettings.Brightness || _pictureSettings.Contrast;
+	if(needToProcess) {
+		double y, i, q;
+		for(int pal = 0; pal < 512; pal++) {
+			uint32_t pixelOutput = _sourcePalette[pal];
 			double redChannel = ((pixelOutput & 0xFF0000) >> 16) / 255.0;
 			double greenChannel = ((pixelOutput & 0xFF00) >> 8) / 255.0;
 			double blueChannel = (pixelOutput & 0xFF) / 255.0;
@@ -74,27 +103,23 @@ void DefaultVideoFilter::OnBeforeApplyFilter()
 			_calculatedPalette[pal] = 0xFF000000 | (r << 16) | (g << 8) | b;
 		}
 	} else {
-		memcpy(_calculatedPalette, _console->GetSettings()->GetRgbPalette(), sizeof(_calculatedPalette));
+		memcpy(_calculatedPalette, _sourcePalette, sizeof(_calculatedPalette));
 	}
+	_paletteExpander.SetPalette(_calculatedPalette);
 }
 
 void DefaultVideoFilter::DecodePpuBuffer(uint16_t *ppuOutputBuffer, uint32_t* outputBuffer, bool displayScanlines)
 {
 	uint32_t* out = outputBuffer;
 	OverscanDimensions overscan = GetOverscan();
-	uint8_t scanlineIntensity = (uint8_t)((1.0 - _console->GetSettings()->GetPictureSettings().ScanlineIntensity) * 255);
+	uint32_t rowWidth = 256 - overscan.Left - overscan.Right;
+	displayScanlines &= _scanlineIntensity < 0xFF;
+	//The overscan is cropped by only expanding the visible part of each row (the expanders pick the fastest kernel the CPU supports)
 	for(uint32_t i = overscan.Top, iMax = 240 - overscan.Bottom; i < iMax; i++) {
-		if(displayScanlines && (i + overscan.Top) % 2 == 0) {
-			for(uint32_t j = overscan.Left, jMax = 256 - overscan.Right; j < jMax; j++) {
-				*out = ApplyScanlineEffect(ppuOutputBuffer[i * 256 + j], scanlineIntensity);
-				out++;
-			}
-		} else {
-			for(uint32_t j = overscan.Left, jMax = 256 - overscan.Right; j < jMax; j++) {
-				*out = _calculatedPalette[ppuOutputBuffer[i * 256 + j]];
-				out++;
-			}
-		}
+		bool isScanline = displayScanlines && (i + overscan.Top) % 2 == 0;
+		PaletteExpander &expander = isScanline ? _scanlineExpander : _paletteExpander;
+		expander.ExpandRow(ppuOutputBuffer + i * 256 + overscan.Left, out, rowWidth);
+		out += rowWidth;
 	}
 }
 
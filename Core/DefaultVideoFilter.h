@@ -2,20 +2,29 @@
 
 #include "stdafx.h"
 #include "BaseVideoFilter.h"
+#include "../Utilities/PaletteExpander.h"
 
 class DefaultVideoFilter : public BaseVideoFilter
 {
 private:
 	double _yiqToRgbMatrix[6];
+	uint32_t _sourcePalette[512];
 	uint32_t _calculatedPalette[512];
+	uint32_t _scanlinePalette[512];
+	uint8_t _scanlineIntensity = 0xFF;
 	PictureSettings _pictureSettings;
-	bool _needToProcess = false;
+	bool _needPaletteUpdate = true;
+
+	PaletteExpander _paletteExpander;
+	PaletteExpander _scanlineExpander;
 
 	void InitConversionMatrix(double hueShift, double saturationShift);
 
 	void RgbToYiq(double r, double g, double b, double &y, double &i, double &q);
 	void YiqToRgb(double y, double i, double q, double &r, double &g, double &b);
 
+	void UpdateCalculatedPalette();
+
 protected:
 	void DecodePpuBuffer(uint16_t *ppuOutputBuffer, uint32_t* outputBuffer, bool displayScanlines);
 	uint32_t ApplyScanlineEffect(uint16_t ppuPixel, uint8_t scanlineIntensity);
@@ -231,6 +231,28 @@ bool DeltaModulationChannel::NeedToRun()
 	return _needToRun;
 }
 
+uint32_t DeltaModulationChannel::GetRunDeadline()
+{
+	//Returns the number of cycles before the APU needs to run for the DMC (0 = NeedToRun must be checked on every cycle)
+	if(_needInit > 0) {
+		return 0;
+	}
+
+	uint32_t deadline = UINT32_MAX;
+	if(_needToRun && !_bufferEmpty && _bytesRemaining > 0) {
+		//The next DMA transfer starts when the output unit finishes the current byte and empties the read buffer
+		//The timer clocks the channel after _timer + 1 cycles, and then every _period + 1 cycles
+		deadline = _timer + 1 + (_bitsRemaining - 1) * (_period + 1);
+	}
+
+	if(_irqEnabled && _bytesRemaining > 0) {
+		//Matches IrqPending()
+		deadline = std::min(deadline, (_bitsRemaining + (_bytesRemaining - 1) * 8) * (uint32_t)_period);
+	}
+
+	return deadline;
+}
+
 ApuDmcState DeltaModulationChannel::GetState()
 {
 	ApuDmcState state;
@@ -38,7 +38,7 @@ public:
 	Disassembler(MemoryManager* memoryManager, BaseMapper* mapper, Debugger* debugger);
 	~Disassembler();
 
-	void BuildOpCodeTables(bool useLowerCase);
+	static void BuildOpCodeTables(bool useLowerCase);
 	void Reset();
 	
 	uint32_t BuildCache(AddressTypeInfo &info, uint16_t memoryAddr, bool isSubEntryPoint, bool processJumps, bool forceDisassemble = false);
@@ -229,11 +229,17 @@ uint16_t DisassemblyInfo::GetIndirectJumpDestination(MemoryManager* memoryManage
 }
 
 void DisassemblyInfo::GetEffectiveAddressString(string &out, State& cpuState, MemoryManager* memoryManager, LabelManager* labelManager)
+{
+	if(_opMode > AddrMode::Abs) {
+		GetEffectiveAddressString(out, GetEffectiveAddress(cpuState, memoryManager), labelManager);
+	}
+}
+
+void DisassemblyInfo::GetEffectiveAddressString(string &out, int32_t effectiveAddress, LabelManager* labelManager)
 {
 	if(_opMode <= AddrMode::Abs) {
 		return;
 	} else {
-		int32_t effectiveAddress = GetEffectiveAddress(cpuState, memoryManager);
 		char buffer[500];
 
 		int length = 0;
@@ -328,6 +334,11 @@ void DisassemblyInfo::GetByteCode(string &out)
 	out.append(byteCode, pos);
 }
 
+void DisassemblyInfo::GetByteCode(uint8_t byteCode[3])
+{
+	memcpy(byteCode, _byteCode, sizeof(_byteCode));
+}
+
 uint32_t DisassemblyInfo::GetSize()
 {
 	return _opSize;
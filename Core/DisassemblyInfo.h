@@ -33,11 +33,13 @@ public:
 	int32_t GetEffectiveAddress(State& cpuState, MemoryManager* memoryManager);
 	
 	void GetEffectiveAddressString(string &out, State& cpuState, MemoryManager* memoryManager, LabelManager* labelManager);
+	void GetEffectiveAddressString(string &out, int32_t effectiveAddress, LabelManager* labelManager);
 	int32_t GetMemoryValue(State& cpuState, MemoryManager* memoryManager);
 	uint16_t GetJumpDestination(uint16_t pc, MemoryManager* memoryManager);
 	uint16_t GetIndirectJumpDestination(MemoryManager* memoryManager);
 	void ToString(string &out, uint32_t memoryAddr, MemoryManager* memoryManager, LabelManager* labelManager, bool extendZeroPage);
 	void GetByteCode(string &out);
+	void GetByteCode(uint8_t byteCode[3]);
 	uint32_t GetSize();
 	uint16_t GetOpAddr(uint16_t memoryAddr);
 
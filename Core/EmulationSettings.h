@@ -99,6 +99,9 @@ enum EmulationFlags : uint64_t
 	VsDualMuteSlave = 0x400000000000000,
 	
 	RandomizeCpuPpuAlignment = 0x800000000000000,
+
+	HeadlessMode = 0x1000000000000000,
+	BatchPpuRendering = 0x2000000000000000,
 	
 	ForceMaxSpeed = 0x4000000000000000,	
 	ConsoleMode = 0x8000000000000000,
@@ -233,6 +236,9 @@ struct NtscFilterSettings
 	double YFilterLength = 0;
 	double IFilterLength = 0;
 	double QFilterLength = 0;
+
+	//Number of extra threads used by the Bisqwit filter (-1 = one per core), applied when the filter is created
+	int32_t ThreadCount = -1;
 };
 
 enum class RamPowerOnState
@@ -677,6 +683,7 @@ private:
 	uint32_t _rewindSpeed = 100;
 
 	uint32_t _rewindBufferSize = 300;
+	uint32_t _rewindMemoryLimit = 256;
 
 	bool _disableOverclocking = false;
 	uint32_t _extraScanlinesBeforeNmi = 0;
@@ -684,6 +691,7 @@ private:
 
 	OverscanDimensions _overscan;
 	VideoFilterType _videoFilterType = VideoFilterType::None;
+	bool _videoFilterFallback = false;
 	double _videoScale = 1;
 	VideoAspectRatio _aspectRatio = VideoAspectRatio::NoStretching;
 	double _customAspectRatio = 1.0;
@@ -1086,6 +1094,16 @@ public:
 		return _rewindBufferSize;
 	}
 
+	void SetRewindMemoryLimit(uint32_t megabytes)
+	{
+		_rewindMemoryLimit = megabytes;
+	}
+
+	uint32_t GetRewindMemoryLimit()
+	{
+		return _rewindMemoryLimit;
+	}
+
 	uint32_t GetEmulationSpeed(bool ignoreTurbo = false);
 	
 	void DisableOverclocking(bool disabled)
@@ -1167,6 +1185,17 @@ public:
 		return _videoFilterType;
 	}
 
+	//When enabled, the video decoder falls back to a faster filter of the same family when the selected filter can't decode frames in time
+	void SetVideoFilterFallback(bool enabled)
+	{
+		_videoFilterFallback = enabled;
+	}
+
+	bool IsVideoFilterFallbackEnabled()
+	{
+		return _videoFilterFallback;
+	}
+
 	void SetVideoResizeFilter(VideoResizeFilter videoResizeFilter)
 	{
 		_resizeFilter = videoResizeFilter;
@@ -1226,6 +1255,11 @@ public:
 		_ntscFilterSettings.KeepVerticalResolution = keepVerticalResolution;
 	}
 
+	void SetNtscFilterThreadCount(int32_t threadCount)
+	{
+		_ntscFilterSettings.ThreadCount = threadCount;
+	}
+
 	NtscFilterSettings GetNtscFilterSettings()
 	{
 		return _ntscFilterSettings;
@@ -0,0 +1,214 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <complex>
+#include "../Utilities/orfanidis_eq.h"
+#include "EqualizerFilter.h"
+
+typedef std::complex<double> Complex;
+
+//Finds the roots of c[0]*z^4 + c[1]*z^3 + c[2]*z^2 + c[3]*z + c[4] (Durand-Kerner method)
+static void FindRoots(const double c[5], Complex roots[4])
+{
+	Complex seed(0.4, 0.9);
+	roots[0] = 1;
+	for(int i = 1; i < 4; i++) {
+		roots[i] = roots[i - 1] * seed;
+	}
+
+	for(int iteration = 0; iteration < 1000; iteration++) {
+		double maxChange = 0;
+		for(int i = 0; i < 4; i++) {
+			Complex z = roots[i];
+			Complex value = (((c[0] * z + c[1]) * z + c[2]) * z + c[3]) * z + c[4];
+			Complex divisor = c[0];
+			for(int j = 0; j < 4; j++) {
+				if(j != i) {
+					divisor *= z - roots[j];
+				}
+			}
+			if(divisor == 0.0) {
+				continue;
+			}
+			Complex change = value / divisor;
+			roots[i] -= change;
+			maxChange = std::max(maxChange, std::abs(change));
+		}
+
+		if(maxChange < 1e-15) {
+			break;
+		}
+	}
+}
+
+//Splits a 4th order polynomial (in z^-1) into two 2nd order polynomials (1 + factors[i][0]*z^-1 + factors[i][1]*z^-2), keeping complex conjugate roots together
+static void Factorize(const double c[5], double factors[2][2], Complex pairRoots[2])
+{
+	Complex roots[4];
+	FindRoots(c, roots);
+
+	//Pick the pairing that makes both factors real (each pair is either conjugate roots or 2 real roots)
+	static constexpr int pairings[3][4] = { { 0, 1, 2, 3 }, { 0, 2, 1, 3 }, { 0, 3, 1, 2 } };
+	int best = 0;
+	double bestError = 0;
+	for(int i = 0; i < 3; i++) {
+		const int* p = pairings[i];
+		double error = std::abs((roots[p[0]] + roots[p[1]]).imag()) + std::abs((roots[p[2]] + roots[p[3]]).imag());
+		if(i == 0 || error < bestError) {
+			best = i;
+			bestError = error;
+		}
+	}
+
+	for(int i = 0; i < 2; i++) {
+		Complex r1 = roots[pairings[best][i * 2]];
+		Complex r2 = roots[pairings[best][i * 2 + 1]];
+		factors[i][0] = -(r1 + r2).real();
+		factors[i][1] = (r1 * r2).real();
+		pairRoots[i] = r1.imag() >= 0 ? r1 : r2;
+	}
+}
+
+//Converts a 2nd order section (b[0] + b[1]*z^-1 + b[2]*z^-2) / (1 + a[0]*z^-1 + a[1]*z^-2) to the coefficients of a trapezoidal state variable filter:
+//the bilinear transform is reversed to get the analog filter, which is normalized to (m0*s^2 + (m0*k+m1)*s + m0+m2) / (s^2 + k*s + 1) with s = (z-1)/(z+1)/g
+static void GetStateVariableCoefficients(const double b[3], const double a[2], double svf[6])
+{
+	double q2 = 1 - a[0] + a[1];
+	double q1 = 2 - 2 * a[1];
+	double q0 = 1 + a[0] + a[1];
+	double p2 = b[0] - b[1] + b[2];
+	double p1 = 2 * b[0] - 2 * b[2];
+	double p0 = b[0] + b[1] + b[2];
+
+	double g = std::sqrt(q0 / q2);
+	double k = q1 * g / q0;
+	double n2 = p2 / q2;
+	double n1 = p1 * g / q0;
+	double n0 = p0 / q0;
+
+	svf[0] = 1 / (1 + g * (g + k));
+	svf[1] = g * svf[0];
+	svf[2] = g * svf[1];
+	svf[3] = n2;
+	svf[4] = n1 - k * n2;
+	svf[5] = n0 - n2;
+}
+
+bool EqualizerFilter::IsEnabled()
+{
+	return _bandCount > 0;
+}
+
+void EqualizerFilter::SetFilters(orfanidis_eq::eq1* equalizer)
+{
+	_bandCount = equalizer ? equalizer->get_number_of_bands() : 0;
+	_stageCount = 0;
+	for(uint32_t i = 0; i < _bandCount; i++) {
+		_stageCount = std::max(_stageCount, (uint32_t)equalizer->get_band_filter(i)->get_sections().size() * 2);
+	}
+	_blockCount = (_bandCount + LaneCount - 1) / LaneCount;
+
+	//Padding lanes and unused stages (when bands have fewer sections than others) are passthrough filters
+	FilterLanes passthrough = {};
+	std::fill(passthrough.A1, passthrough.A1 + LaneCount, 1.0f);
+	std::fill(passthrough.M0, passthrough.M0 + LaneCount, 1.0f);
+	_stages.assign(_blockCount * 2 * _stageCount, passthrough);
+
+	for(uint32_t band = 0; band < _bandCount; band++) {
+		const vector<orfanidis_eq::fo_section>& sections = equalizer->get_band_filter(band)->get_sections();
+		for(size_t i = 0; i < sections.size(); i++) {
+			double b[5], a[5];
+			sections[i].get_coefficients(b, a);
+
+			double numerator[2][2], denominator[2][2];
+			Complex zeros[2], poles[2];
+			Factorize(b, numerator, zeros);
+			Factorize(a, denominator, poles);
+
+			//Pair each set of poles with the closest zeros, this keeps the gain of each 2nd order section (and the rounding errors) low
+			bool swapZeros = std::abs(zeros[0] - poles[1]) + std::abs(zeros[1] - poles[0]) < std::abs(zeros[0] - poles[0]) + std::abs(zeros[1] - poles[1]);
+			for(int j = 0; j < 2; j++) {
+				double* num = numerator[swapZeros ? 1 - j : j];
+				double gain = j == 0 ? b[0] / a[0] : 1.0;
+				double sectionB[3] = { gain, gain * num[0], gain * num[1] };
+				double svf[6];
+				GetStateVariableCoefficients(sectionB, denominator[j], svf);
+
+				for(int channel = 0; channel < 2; channel++) {
+					uint32_t block = channel * _blockCount + band / LaneCount;
+					FilterLanes& stage = _stages[block * _stageCount + i * 2 + j];
+					uint32_t lane = band % LaneCount;
+					stage.A1[lane] = (float)svf[0];
+					stage.A2[lane] = (float)svf[1];
+					stage.A3[lane] = (float)svf[2];
+					stage.M0[lane] = (float)svf[3];
+					stage.M1[lane] = (float)svf[4];
+					stage.M2[lane] = (float)svf[5];
+				}
+			}
+		}
+	}
+
+	SetBandGains(equalizer);
+}
+
+void EqualizerFilter::SetBandGains(orfanidis_eq::eq1* equalizer)
+{
+	_gains.assign(_blockCount * 2 * LaneCount, 0.0f);
+	for(uint32_t band = 0; band < _bandCount; band++) {
+		_gains[band] = _gains[_blockCount * LaneCount + band] = (float)equalizer->get_band_gain(band);
+	}
+}
+
+void EqualizerFilter::ProcessBlock(uint32_t block, int16_t input, float sums[LaneCount])
+{
+	float values[LaneCount];
+	std::fill(values, values + LaneCount, (float)input);
+
+	for(uint32_t i = 0; i < _stageCount; i++) {
+		FilterLanes& stage = _stages[block * _stageCount + i];
+		for(uint32_t j = 0; j < LaneCount; j++) {
+			float v0 = values[j];
+			float v3 = v0 - stage.State2[j];
+			float v1 = stage.A1[j] * stage.State1[j] + stage.A2[j] * v3;
+			float v2 = stage.State2[j] + stage.A2[j] * stage.State1[j] + stage.A3[j] * v3;
+
+			//Prevent denormalized values (causes extreme performance loss)
+			float state1 = 2 * v1 - stage.State1[j];
+			float state2 = 2 * v2 - stage.State2[j];
+			stage.State1[j] = std::abs(state1) < 1e-15f ? 0.0f : state1;
+			stage.State2[j] = std::abs(state2) < 1e-15f ? 0.0f : state2;
+
+			values[j] = stage.M0[j] * v0 + stage.M1[j] * v1 + stage.M2[j] * v2;
+		}
+	}
+
+	float* gains = _gains.data() + block * LaneCount;
+	for(uint32_t j = 0; j < LaneCount; j++) {
+		sums[j] += values[j] * gains[j];
+	}
+}
+
+void EqualizerFilter::ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, bool stereo)
+{
+	if(!IsEnabled()) {
+		return;
+	}
+
+	//In mono mode, only the left channel is filtered
+	uint32_t channelCount = stereo ? 2 : 1;
+	for(size_t i = 0; i < sampleCount; i++) {
+		for(uint32_t channel = 0; channel < channelCount; channel++) {
+			//The bands' outputs are summed in separate lanes, to allow vectorization
+			float sums[LaneCount] = {};
+			for(uint32_t block = 0; block < _blockCount; block++) {
+				ProcessBlock(channel * _blockCount + block, stereoBuffer[i * 2 + channel], sums);
+			}
+
+			float output = 0;
+			for(uint32_t j = 0; j < LaneCount; j++) {
+				output += sums[j];
+			}
+			stereoBuffer[i * 2 + channel] = (int16_t)std::max(std::min(output, 32767.0f), -32768.0f);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "stdafx.h"
+
+namespace orfanidis_eq {
+	class eq1;
+}
+
+//Applies the band filters designed by orfanidis_eq::eq1 in single precision.
+//Each band's 4th order sections are split into 2nd order sections, which run as trapezoidal state variable filters (unlike direct form filters,
+//these stay accurate in single precision for the low frequency bands), and the bands are processed side by side in blocks of LaneCount
+//bands (one "lane" per band) so the inner loops can be vectorized
+class EqualizerFilter
+{
+private:
+	static constexpr uint32_t LaneCount = 8;
+
+	//One 2nd order section of LaneCount bands
+	struct FilterLanes
+	{
+		float A1[LaneCount];
+		float A2[LaneCount];
+		float A3[LaneCount];
+		float M0[LaneCount];
+		float M1[LaneCount];
+		float M2[LaneCount];
+		float State1[LaneCount];
+		float State2[LaneCount];
+	};
+
+	uint32_t _bandCount = 0;
+	uint32_t _stageCount = 0;
+
+	//Blocks of LaneCount bands per channel (padding lanes have a gain of 0) - the right channel's blocks follow the left channel's
+	uint32_t _blockCount = 0;
+	vector<FilterLanes> _stages; //[block * _stageCount + stage]
+	vector<float> _gains; //[block * LaneCount + lane]
+
+	void ProcessBlock(uint32_t block, int16_t input, float sums[LaneCount]);
+
+public:
+	bool IsEnabled();
+
+	//Copies the equalizer's filters (or disables the filter if equalizer is null) and resets the filter's state
+	void SetFilters(orfanidis_eq::eq1* equalizer);
+
+	//Updates the band gains without resetting the filter's state
+	void SetBandGains(orfanidis_eq::eq1* equalizer);
+
+	void ApplyFilter(int16_t* stereoBuffer, size_t sampleCount, bool stereo);
+};
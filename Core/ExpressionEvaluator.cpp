@@ -348,7 +348,93 @@ bool ExpressionEvaluator::ToRpn(string expression, ExpressionData &data)
 	return true;
 }
 
+static bool IsBooleanValue(int64_t value)
+{
+	switch(value) {
+		case EvalValues::Nmi:
+		case EvalValues::Irq:
+		case EvalValues::Sprite0Hit:
+		case EvalValues::SpriteOverflow:
+		case EvalValues::VerticalBlank:
+		case EvalValues::Branched:
+		case EvalValues::RegPS_Carry:
+		case EvalValues::RegPS_Zero:
+		case EvalValues::RegPS_Interrupt:
+		case EvalValues::RegPS_Decimal:
+		case EvalValues::RegPS_Overflow:
+		case EvalValues::RegPS_Negative:
+			return true;
+
+		default:
+			return false;
+	}
+}
+
+int64_t ExpressionEvaluator::GetValue(int64_t value, DebugState &state, OperationInfo &operationInfo)
+{
+	switch(value) {
+		case EvalValues::RegA: return state.CPU.A;
+		case EvalValues::RegX: return state.CPU.X;
+		case EvalValues::RegY: return state.CPU.Y;
+		case EvalValues::RegSP: return state.CPU.SP;
+		case EvalValues::RegPS: return state.CPU.PS;
+		case EvalValues::RegPC: return state.CPU.PC;
+		case EvalValues::RegOpPC: return state.CPU.DebugPC;
+		case EvalValues::PpuFrameCount: return state.PPU.FrameCount;
+		case EvalValues::PpuCycle: return state.PPU.Cycle;
+		case EvalValues::PpuScanline: return state.PPU.Scanline;
+		case EvalValues::Nmi: return state.CPU.NMIFlag;
+		case EvalValues::Irq: return state.CPU.IRQFlag;
+		case EvalValues::Value: return operationInfo.Value;
+		case EvalValues::Address: return operationInfo.Address;
+		case EvalValues::IsWrite: return operationInfo.OperationType == MemoryOperationType::Write || operationInfo.OperationType == MemoryOperationType::DummyWrite;
+		case EvalValues::IsRead: return operationInfo.OperationType == MemoryOperationType::Read || operationInfo.OperationType == MemoryOperationType::DummyRead;
+		case EvalValues::PreviousOpPC: return state.CPU.PreviousDebugPC;
+		case EvalValues::Sprite0Hit: return state.PPU.StatusFlags.Sprite0Hit;
+		case EvalValues::SpriteOverflow: return state.PPU.StatusFlags.SpriteOverflow;
+		case EvalValues::VerticalBlank: return state.PPU.StatusFlags.VerticalBlank;
+		case EvalValues::Branched: return Disassembler::IsJump(_debugger->GetMemoryDumper()->GetMemoryValue(DebugMemoryType::CpuMemory, state.CPU.PreviousDebugPC, true));
+		case EvalValues::RegPS_Carry: return (state.CPU.PS & PSFlags::Carry) != 0;
+		case EvalValues::RegPS_Zero: return (state.CPU.PS & PSFlags::Zero) != 0;
+		case EvalValues::RegPS_Interrupt: return (state.CPU.PS & PSFlags::Interrupt) != 0;
+		case EvalValues::RegPS_Decimal: return (state.CPU.PS & PSFlags::Decimal) != 0;
+		case EvalValues::RegPS_Overflow: return (state.CPU.PS & PSFlags::Overflow) != 0;
+		case EvalValues::RegPS_Negative: return (state.CPU.PS & PSFlags::Negative) != 0;
+		default: return value;
+	}
+}
+
+bool ExpressionEvaluator::GetLabelAddress(ExpressionData &data, int64_t labelIndex, int64_t &address, EvalResultType &resultType)
+{
+	if((size_t)labelIndex < data.Labels.size()) {
+		address = _debugger->GetLabelManager()->GetLabelRelativeAddress(data.Labels[(uint32_t)labelIndex]);
+		if(address < -1) {
+			//Label doesn't exist, try to find a matching multi-byte label
+			string label = data.Labels[(uint32_t)labelIndex] + "+0";
+			address = _debugger->GetLabelManager()->GetLabelRelativeAddress(label);
+		}
+	} else {
+		address = -2;
+	}
+
+	if(address < 0) {
+		//Label is no longer valid
+		resultType = address == -1 ? EvalResultType::OutOfScope : EvalResultType::Invalid;
+		return false;
+	}
+	return true;
+}
+
 int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo)
+{
+	if(!data.Program.empty()) {
+		return EvaluateProgram(data, state, resultType, operationInfo);
+	} else {
+		return EvaluateRpn(data, state, resultType, operationInfo);
+	}
+}
+
+int32_t ExpressionEvaluator::EvaluateRpn(ExpressionData &data, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo)
 {
 	if(data.RpnQueue.empty()) {
 		resultType = EvalResultType::Invalid;
@@ -366,52 +452,14 @@ int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, E
 		if(token >= EvalValues::RegA) {
 			//Replace value with a special value
 			if(token >= EvalValues::FirstLabelIndex) {
-				int64_t labelIndex = token - EvalValues::FirstLabelIndex;
-				if((size_t)labelIndex < data.Labels.size()) {
-					token = _debugger->GetLabelManager()->GetLabelRelativeAddress(data.Labels[(uint32_t)labelIndex]);
-					if(token < -1) {
-						//Label doesn't exist, try to find a matching multi-byte label
-						string label = data.Labels[(uint32_t)labelIndex] + "+0";
-						token = _debugger->GetLabelManager()->GetLabelRelativeAddress(label);
-					}
-				} else {
-					token = -2;
-				}
-				if(token < 0) {
-					//Label is no longer valid
-					resultType = token == -1 ? EvalResultType::OutOfScope : EvalResultType::Invalid;
+				if(!GetLabelAddress(data, token - EvalValues::FirstLabelIndex, token, resultType)) {
 					return 0;
 				}
 			} else {
-				switch(token) {
-					case EvalValues::RegA: token = state.CPU.A; break;
-					case EvalValues::RegX: token = state.CPU.X; break;
-					case EvalValues::RegY: token = state.CPU.Y; break;
-					case EvalValues::RegSP: token = state.CPU.SP; break;
-					case EvalValues::RegPS: token = state.CPU.PS; break;
-					case EvalValues::RegPC: token = state.CPU.PC; break;
-					case EvalValues::RegOpPC: token = state.CPU.DebugPC; break;
-					case EvalValues::PpuFrameCount: token = state.PPU.FrameCount; break;
-					case EvalValues::PpuCycle: token = state.PPU.Cycle; break;
-					case EvalValues::PpuScanline: token = state.PPU.Scanline; break;
-					case EvalValues::Nmi: token = state.CPU.NMIFlag; resultType = EvalResultType::Boolean; break;
-					case EvalValues::Irq: token = state.CPU.IRQFlag; resultType = EvalResultType::Boolean; break;
-					case EvalValues::Value: token = operationInfo.Value; break;
-					case EvalValues::Address: token = operationInfo.Address; break;
-					case EvalValues::IsWrite: token = operationInfo.OperationType == MemoryOperationType::Write || operationInfo.OperationType == MemoryOperationType::DummyWrite; break;
-					case EvalValues::IsRead: token = operationInfo.OperationType == MemoryOperationType::Read || operationInfo.OperationType == MemoryOperationType::DummyRead; break;
-					case EvalValues::PreviousOpPC: token = state.CPU.PreviousDebugPC; break;
-					case EvalValues::Sprite0Hit: token = state.PPU.StatusFlags.Sprite0Hit; resultType = EvalResultType::Boolean; break;
-					case EvalValues::SpriteOverflow: token = state.PPU.StatusFlags.SpriteOverflow; resultType = EvalResultType::Boolean; break;
-					case EvalValues::VerticalBlank: token = state.PPU.StatusFlags.VerticalBlank; resultType = EvalResultType::Boolean; break;
-					case EvalValues::Branched: token = Disassembler::IsJump(_debugger->GetMemoryDumper()->GetMemoryValue(DebugMemoryType::CpuMemory, state.CPU.PreviousDebugPC, true)); resultType = EvalResultType::Boolean; break;
-					case EvalValues::RegPS_Carry: token = (state.CPU.PS & PSFlags::Carry) != 0; resultType = EvalResultType::Boolean; break;
-					case EvalValues::RegPS_Zero: token = (state.CPU.PS & PSFlags::Zero) != 0; resultType = EvalResultType::Boolean; break;
-					case EvalValues::RegPS_Interrupt: token = (state.CPU.PS & PSFlags::Interrupt) != 0; resultType = EvalResultType::Boolean; break;
-					case EvalValues::RegPS_Decimal: token = (state.CPU.PS & PSFlags::Decimal) != 0; resultType = EvalResultType::Boolean; break;
-					case EvalValues::RegPS_Overflow: token = (state.CPU.PS & PSFlags::Overflow) != 0; resultType = EvalResultType::Boolean; break;
-					case EvalValues::RegPS_Negative: token = (state.CPU.PS & PSFlags::Negative) != 0; resultType = EvalResultType::Boolean; break;
+				if(IsBooleanValue(token)) {
+					resultType = EvalResultType::Boolean;
 				}
+				token = GetValue(token, state, operationInfo);
 			}
 		} else if(token >= EvalOperators::Multiplication) {
 			right = operandStack[--pos];
@@ -477,6 +525,282 @@ int32_t ExpressionEvaluator::Evaluate(ExpressionData &data, DebugState &state, E
 	return (int32_t)operandStack[0];
 }
 
+struct ExpressionNode
+{
+	EvalOpCode OpCode;
+	int64_t Value;
+	int32_t Left; //Operand of unary operators
+	int32_t Right;
+	EvalResultType ResultType;
+
+	//True when evaluating the node can end the evaluation with an error (invalid label, division by 0)
+	bool CanFail;
+};
+
+static void FoldConstants(ExpressionNode &node, vector<ExpressionNode> &nodes)
+{
+	ExpressionNode &left = nodes[node.Left];
+	bool isBinary = node.Right >= 0;
+	bool leftIsConstant = left.OpCode == EvalOpCode::Constant;
+	bool rightIsConstant = !isBinary || nodes[node.Right].OpCode == EvalOpCode::Constant;
+	int64_t l = left.Value;
+	int64_t r = isBinary ? nodes[node.Right].Value : 0;
+
+	int64_t value;
+	if(node.OpCode == EvalOpCode::LogicalAnd && leftIsConstant && l == 0 && !nodes[node.Right].CanFail) {
+		value = 0;
+	} else if(node.OpCode == EvalOpCode::LogicalOr && leftIsConstant && l != 0 && !nodes[node.Right].CanFail) {
+		value = 1;
+	} else if(!leftIsConstant || !rightIsConstant) {
+		return;
+	} else {
+		switch(node.OpCode) {
+			case EvalOpCode::Multiplication: value = l * r; break;
+			case EvalOpCode::Division: if(r == 0) { return; } value = l / r; break;
+			case EvalOpCode::Modulo: if(r == 0) { return; } value = l % r; break;
+			case EvalOpCode::Addition: value = l + r; break;
+			case EvalOpCode::Substration: value = l - r; break;
+			case EvalOpCode::ShiftLeft: value = l << r; break;
+			case EvalOpCode::ShiftRight: value = l >> r; break;
+			case EvalOpCode::SmallerThan: value = l < r; break;
+			case EvalOpCode::SmallerOrEqual: value = l <= r; break;
+			case EvalOpCode::GreaterThan: value = l > r; break;
+			case EvalOpCode::GreaterOrEqual: value = l >= r; break;
+			case EvalOpCode::Equal: value = l == r; break;
+			case EvalOpCode::NotEqual: value = l != r; break;
+			case EvalOpCode::BinaryAnd: value = l & r; break;
+			case EvalOpCode::BinaryXor: value = l ^ r; break;
+			case EvalOpCode::BinaryOr: value = l | r; break;
+			case EvalOpCode::LogicalAnd: value = l && r; break;
+			case EvalOpCode::LogicalOr: value = l || r; break;
+			case EvalOpCode::Plus: value = l; break;
+			case EvalOpCode::Minus: value = -l; break;
+			case EvalOpCode::BinaryNot: value = ~l; break;
+			case EvalOpCode::LogicalNot: value = !l; break;
+
+			//Memory reads and absolute addresses depend on the emulator's state
+			default: return;
+		}
+	}
+
+	node.OpCode = EvalOpCode::Constant;
+	node.Value = value;
+	node.Left = -1;
+	node.Right = -1;
+	node.CanFail = false;
+}
+
+static bool EmitNode(vector<ExpressionNode> &nodes, int32_t index, uint16_t reg, uint16_t registerCount, vector<ExpressionInstruction> &program)
+{
+	if(reg >= registerCount - 1) {
+		return false;
+	}
+
+	ExpressionNode &node = nodes[index];
+	switch(node.OpCode) {
+		case EvalOpCode::Constant:
+		case EvalOpCode::Label:
+		case EvalOpCode::Value:
+			program.push_back({ node.OpCode, reg, 0, 0, node.Value });
+			return true;
+
+		case EvalOpCode::LogicalAnd:
+		case EvalOpCode::LogicalOr:
+			if(!nodes[node.Right].CanFail) {
+				//Skip the right operand when the left one is enough to know the result - only done when the right operand
+				//can't fail, otherwise the result type (e.g DivideBy0) would no longer match the RPN evaluation's
+				if(!EmitNode(nodes, node.Left, reg, registerCount, program)) {
+					return false;
+				}
+				size_t skipIndex = program.size();
+				program.push_back({ node.OpCode == EvalOpCode::LogicalAnd ? EvalOpCode::SkipIfZero : EvalOpCode::SkipIfNotZero, reg, reg, 0, 0 });
+				if(!EmitNode(nodes, node.Right, reg + 1, registerCount, program)) {
+					return false;
+				}
+				program.push_back({ EvalOpCode::ToBoolean, reg, (uint16_t)(reg + 1), 0, 0 });
+				program[skipIndex].Value = program.size() - skipIndex - 1;
+				return true;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	if(!EmitNode(nodes, node.Left, reg, registerCount, program)) {
+		return false;
+	}
+	if(node.Right >= 0 && !EmitNode(nodes, node.Right, reg + 1, registerCount, program)) {
+		return false;
+	}
+	program.push_back({ node.OpCode, reg, reg, (uint16_t)(reg + 1), 0 });
+	return true;
+}
+
+bool ExpressionEvaluator::Compile(ExpressionData &data)
+{
+	data.Program.clear();
+	data.ProgramResultType = EvalResultType::Numeric;
+
+	//Rebuild the expression's tree from the RPN queue
+	vector<ExpressionNode> nodes;
+	vector<int32_t> stack;
+	for(int64_t token : data.RpnQueue) {
+		ExpressionNode node = { EvalOpCode::Constant, token, -1, -1, EvalResultType::Numeric, false };
+
+		if(token >= EvalValues::FirstLabelIndex) {
+			node.OpCode = EvalOpCode::Label;
+			node.Value = token - EvalValues::FirstLabelIndex;
+			node.CanFail = true;
+		} else if(token >= EvalValues::RegA) {
+			node.OpCode = EvalOpCode::Value;
+			node.ResultType = IsBooleanValue(token) ? EvalResultType::Boolean : EvalResultType::Numeric;
+		} else if(token >= EvalOperators::Multiplication) {
+			bool isBinary = token <= EvalOperators::LogicalOr;
+			if(isBinary) {
+				node.OpCode = (EvalOpCode)((int64_t)EvalOpCode::Multiplication + token - EvalOperators::Multiplication);
+			} else if(token >= EvalOperators::Plus && token <= EvalOperators::AbsoluteAddress) {
+				node.OpCode = (EvalOpCode)((int64_t)EvalOpCode::Plus + token - EvalOperators::Plus);
+			} else if(token == EvalOperators::Bracket || token == EvalOperators::Braces) {
+				node.OpCode = token == EvalOperators::Bracket ? EvalOpCode::Bracket : EvalOpCode::Braces;
+			} else {
+				return false;
+			}
+
+			if(stack.size() < (isBinary ? 2u : 1u)) {
+				//Invalid expression, let the RPN evaluation handle it
+				return false;
+			}
+
+			if(isBinary) {
+				node.Right = stack.back();
+				stack.pop_back();
+			}
+			node.Left = stack.back();
+			stack.pop_back();
+
+			node.CanFail = nodes[node.Left].CanFail || (isBinary && nodes[node.Right].CanFail);
+			if(node.OpCode == EvalOpCode::Division || node.OpCode == EvalOpCode::Modulo) {
+				ExpressionNode &divisor = nodes[node.Right];
+				node.CanFail |= divisor.OpCode != EvalOpCode::Constant || divisor.Value == 0;
+			}
+
+			switch(node.OpCode) {
+				case EvalOpCode::SmallerThan: case EvalOpCode::SmallerOrEqual:
+				case EvalOpCode::GreaterThan: case EvalOpCode::GreaterOrEqual:
+				case EvalOpCode::Equal: case EvalOpCode::NotEqual:
+				case EvalOpCode::LogicalAnd: case EvalOpCode::LogicalOr:
+					node.ResultType = EvalResultType::Boolean;
+					break;
+
+				default:
+					break;
+			}
+
+			FoldConstants(node, nodes);
+		}
+
+		nodes.push_back(node);
+		stack.push_back((int32_t)nodes.size() - 1);
+	}
+
+	if(stack.size() != 1) {
+		return false;
+	}
+
+	vector<ExpressionInstruction> program;
+	if(!EmitNode(nodes, stack[0], 0, (uint16_t)(sizeof(operandStack) / sizeof(operandStack[0])), program)) {
+		return false;
+	}
+
+	data.Program = program;
+	data.ProgramResultType = nodes[stack[0]].ResultType;
+	return true;
+}
+
+int32_t ExpressionEvaluator::EvaluateProgram(ExpressionData &data, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo)
+{
+	int64_t* r = operandStack;
+	ExpressionInstruction* program = data.Program.data();
+
+	for(size_t i = 0, len = data.Program.size(); i < len; i++) {
+		ExpressionInstruction &instr = program[i];
+		switch(instr.OpCode) {
+			case EvalOpCode::Constant: r[instr.Dest] = instr.Value; break;
+			case EvalOpCode::Label:
+				if(!GetLabelAddress(data, instr.Value, r[instr.Dest], resultType)) {
+					return 0;
+				}
+				break;
+			case EvalOpCode::Value: r[instr.Dest] = GetValue(instr.Value, state, operationInfo); break;
+
+			case EvalOpCode::Multiplication: r[instr.Dest] = r[instr.Left] * r[instr.Right]; break;
+			case EvalOpCode::Division:
+				if(r[instr.Right] == 0) {
+					resultType = EvalResultType::DivideBy0;
+					return 0;
+				}
+				r[instr.Dest] = r[instr.Left] / r[instr.Right];
+				break;
+			case EvalOpCode::Modulo:
+				if(r[instr.Right] == 0) {
+					resultType = EvalResultType::DivideBy0;
+					return 0;
+				}
+				r[instr.Dest] = r[instr.Left] % r[instr.Right];
+				break;
+			case EvalOpCode::Addition: r[instr.Dest] = r[instr.Left] + r[instr.Right]; break;
+			case EvalOpCode::Substration: r[instr.Dest] = r[instr.Left] - r[instr.Right]; break;
+			case EvalOpCode::ShiftLeft: r[instr.Dest] = r[instr.Left] << r[instr.Right]; break;
+			case EvalOpCode::ShiftRight: r[instr.Dest] = r[instr.Left] >> r[instr.Right]; break;
+			case EvalOpCode::SmallerThan: r[instr.Dest] = r[instr.Left] < r[instr.Right]; break;
+			case EvalOpCode::SmallerOrEqual: r[instr.Dest] = r[instr.Left] <= r[instr.Right]; break;
+			case EvalOpCode::GreaterThan: r[instr.Dest] = r[instr.Left] > r[instr.Right]; break;
+			case EvalOpCode::GreaterOrEqual: r[instr.Dest] = r[instr.Left] >= r[instr.Right]; break;
+			case EvalOpCode::Equal: r[instr.Dest] = r[instr.Left] == r[instr.Right]; break;
+			case EvalOpCode::NotEqual: r[instr.Dest] = r[instr.Left] != r[instr.Right]; break;
+			case EvalOpCode::BinaryAnd: r[instr.Dest] = r[instr.Left] & r[instr.Right]; break;
+			case EvalOpCode::BinaryXor: r[instr.Dest] = r[instr.Left] ^ r[instr.Right]; break;
+			case EvalOpCode::BinaryOr: r[instr.Dest] = r[instr.Left] | r[instr.Right]; break;
+			case EvalOpCode::LogicalAnd: r[instr.Dest] = r[instr.Left] && r[instr.Right]; break;
+			case EvalOpCode::LogicalOr: r[instr.Dest] = r[instr.Left] || r[instr.Right]; break;
+
+			case EvalOpCode::Plus: r[instr.Dest] = r[instr.Left]; break;
+			case EvalOpCode::Minus: r[instr.Dest] = -r[instr.Left]; break;
+			case EvalOpCode::BinaryNot: r[instr.Dest] = ~r[instr.Left]; break;
+			case EvalOpCode::LogicalNot: r[instr.Dest] = !r[instr.Left]; break;
+			case EvalOpCode::AbsoluteAddress:
+				if(r[instr.Left] >= 0) {
+					AddressTypeInfo addressInfo;
+					_debugger->GetAbsoluteAddressAndType((uint32_t)r[instr.Left], &addressInfo);
+					r[instr.Dest] = addressInfo.Address;
+				} else {
+					r[instr.Dest] = -1;
+				}
+				break;
+			case EvalOpCode::Bracket: r[instr.Dest] = _debugger->GetMemoryDumper()->GetMemoryValue(DebugMemoryType::CpuMemory, (uint32_t)r[instr.Left]); break;
+			case EvalOpCode::Braces: r[instr.Dest] = _debugger->GetMemoryDumper()->GetMemoryValueWord(DebugMemoryType::CpuMemory, (uint32_t)r[instr.Left]); break;
+
+			case EvalOpCode::SkipIfZero:
+				if(r[instr.Left] == 0) {
+					//Result is 0 (the left operand's value)
+					i += (size_t)instr.Value;
+				}
+				break;
+			case EvalOpCode::SkipIfNotZero:
+				if(r[instr.Left] != 0) {
+					r[instr.Dest] = 1;
+					i += (size_t)instr.Value;
+				}
+				break;
+			case EvalOpCode::ToBoolean: r[instr.Dest] = r[instr.Left] != 0; break;
+		}
+	}
+
+	resultType = data.ProgramResultType;
+	return (int32_t)r[0];
+}
+
 ExpressionEvaluator::ExpressionEvaluator(Debugger* debugger)
 {
 	_debugger = debugger;
@@ -510,6 +834,9 @@ ExpressionData* ExpressionEvaluator::PrivateGetRpnList(string expression, bool&
 		ExpressionData data;
 		success = ToRpn(fixedExp, data);
 		if(success) {
+			//Compile the expression to a register-based program - if this fails, the RPN queue is interpreted instead
+			Compile(data);
+
 			LockHandler lock = _cacheLock.AcquireSafe();
 			_cache[expression] = data;
 			cachedData = &_cache[expression];
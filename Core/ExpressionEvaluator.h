@@ -99,10 +99,67 @@ public:
 	}
 };
 
+enum class EvalOpCode : uint8_t
+{
+	//Loads a constant, a label's address or a special value (EvalValues) in the destination register
+	Constant,
+	Label,
+	Value,
+
+	//Binary operators (same order as EvalOperators)
+	Multiplication,
+	Division,
+	Modulo,
+	Addition,
+	Substration,
+	ShiftLeft,
+	ShiftRight,
+	SmallerThan,
+	SmallerOrEqual,
+	GreaterThan,
+	GreaterOrEqual,
+	Equal,
+	NotEqual,
+	BinaryAnd,
+	BinaryXor,
+	BinaryOr,
+	LogicalAnd,
+	LogicalOr,
+
+	//Unary operators (same order as EvalOperators)
+	Plus,
+	Minus,
+	BinaryNot,
+	LogicalNot,
+	AbsoluteAddress,
+	Bracket,
+	Braces,
+
+	//Short-circuit evaluation of && and || - skips the right operand's instructions when the left operand decides the result
+	SkipIfZero,
+	SkipIfNotZero,
+	ToBoolean,
+};
+
+struct ExpressionInstruction
+{
+	EvalOpCode OpCode;
+	uint16_t Dest;
+	uint16_t Left;
+	uint16_t Right;
+
+	//Constant, label index, EvalValues value or number of instructions to skip
+	int64_t Value;
+};
+
 struct ExpressionData
 {
 	std::vector<int64_t> RpnQueue;
 	std::vector<string> Labels;
+
+	//Compiled version of the RPN queue, evaluated with registers instead of a stack (empty if the expression could not be compiled, the RPN queue is used instead)
+	std::vector<ExpressionInstruction> Program;
+	EvalResultType ProgramResultType = EvalResultType::Numeric;
 };
 
 class ExpressionEvaluator
@@ -126,6 +183,10 @@ private:
 	string GetNextToken(string expression, size_t &pos, ExpressionData &data, bool &success, bool previousTokenIsOp);
 	bool ProcessSpecialOperator(EvalOperators evalOp, std::stack<EvalOperators> &opStack, std::stack<int> &precedenceStack, vector<int64_t> &outputQueue);
 	bool ToRpn(string expression, ExpressionData &data);
+	bool Compile(ExpressionData &data);
+	int64_t GetValue(int64_t value, DebugState &state, OperationInfo &operationInfo);
+	bool GetLabelAddress(ExpressionData &data, int64_t labelIndex, int64_t &address, EvalResultType &resultType);
+	int32_t EvaluateProgram(ExpressionData &data, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo);
 	int32_t PrivateEvaluate(string expression, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo, bool &success);
 	ExpressionData* PrivateGetRpnList(string expression, bool& success);
 
@@ -133,6 +194,9 @@ public:
 	ExpressionEvaluator(Debugger* debugger);
 
 	int32_t Evaluate(ExpressionData &data, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo);
+
+	//Interprets the RPN queue, even if the expression was compiled (used to benchmark/validate the compiled version)
+	int32_t EvaluateRpn(ExpressionData &data, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo);
 	int32_t Evaluate(string expression, DebugState &state, EvalResultType &resultType, OperationInfo &operationInfo);
 	ExpressionData GetRpnList(string expression, bool &success);
 
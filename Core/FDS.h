@@ -106,6 +106,7 @@ protected:
 	uint8_t ReadRegister(uint16_t addr) override;
 
 	uint8_t ReadRAM(uint16_t addr) override;
+	bool AllowDirectPrgRead() override { return false; }
 
 	void StreamState(bool saving) override;
 
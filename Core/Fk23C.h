@@ -356,6 +356,8 @@ public:
 		}
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		switch(_a12Watcher.UpdateVramAddress(addr, _console->GetPpu()->GetFrameCycle())) {
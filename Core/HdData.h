@@ -2,6 +2,7 @@
 #include "stdafx.h"
 #include <unordered_set>
 #include "PPU.h"
+#include "OggFile.h"
 #include "../Utilities/HexUtilities.h"
 
 struct HdTileKey
@@ -355,8 +356,8 @@ struct HdPackData
 	std::unordered_set<uint32_t> WatchedMemoryAddresses;
 	std::unordered_map<HdTileKey, vector<HdPackTileInfo*>> TileByKey;
 	std::unordered_map<string, string> PatchesByHash;
-	std::unordered_map<int, string> BgmFilesById;
-	std::unordered_map<int, string> SfxFilesById;
+	std::unordered_map<int, shared_ptr<OggFile>> BgmFilesById;
+	std::unordered_map<int, shared_ptr<OggFile>> SfxFilesById;
 	vector<uint32_t> Palette;
 
 	bool HasOverscanConfig = false;
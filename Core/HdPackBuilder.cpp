@@ -352,11 +352,11 @@ void HdPackBuilder::SaveHdPack()
 	}
 
 	for(auto &bgmInfo : _hdData.BgmFilesById) {
-		ss << "<bgm>" << std::to_string(bgmInfo.first >> 8) << "," << std::to_string(bgmInfo.first & 0xFF) << "," << VirtualFile(bgmInfo.second).GetFileName() << std::endl;
+		ss << "<bgm>" << std::to_string(bgmInfo.first >> 8) << "," << std::to_string(bgmInfo.first & 0xFF) << "," << VirtualFile(bgmInfo.second->GetPath()).GetFileName() << std::endl;
 	}
 
 	for(auto &sfxInfo : _hdData.SfxFilesById) {
-		ss << "<sfx>" << std::to_string(sfxInfo.first >> 8) << "," << std::to_string(sfxInfo.first & 0xFF) << "," << VirtualFile(sfxInfo.second).GetFileName() << std::endl;
+		ss << "<sfx>" << std::to_string(sfxInfo.first >> 8) << "," << std::to_string(sfxInfo.first & 0xFF) << "," << VirtualFile(sfxInfo.second->GetPath()).GetFileName() << std::endl;
 	}
 
 	for(auto &patchInfo : _hdData.PatchesByHash) {
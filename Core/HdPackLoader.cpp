@@ -649,12 +649,7 @@ void HdPackLoader::ProcessBgmTag(vector<string> &tokens)
 {
 	int trackId = ProcessSoundTrack(tokens[0], tokens[1], tokens[2]);
 	if(trackId >= 0) {
-		if(_loadFromZip) {
-			VirtualFile file(_hdPackFolder, tokens[2]);
-			_data->BgmFilesById[trackId] = file;
-		} else {
-			_data->BgmFilesById[trackId] = FolderUtilities::CombinePath(_hdPackFolder, tokens[2]);
-		}
+		_data->BgmFilesById[trackId] = LoadOggFile(tokens[2]);
 	}
 }
 
@@ -662,13 +657,29 @@ void HdPackLoader::ProcessSfxTag(vector<string> &tokens)
 {
 	int trackId = ProcessSoundTrack(tokens[0], tokens[1], tokens[2]);
 	if(trackId >= 0) {
-		if(_loadFromZip) {
-			VirtualFile file(_hdPackFolder, tokens[2]);
-			_data->SfxFilesById[trackId] = file;
-		} else {
-			_data->SfxFilesById[trackId] = FolderUtilities::CombinePath(_hdPackFolder, tokens[2]);
+		_data->SfxFilesById[trackId] = LoadOggFile(tokens[2]);
+	}
+}
+
+shared_ptr<OggFile> HdPackLoader::LoadOggFile(string filename)
+{
+	shared_ptr<OggFile> file;
+	if(_loadFromZip) {
+		//Files inside the archive can't be memory-mapped - they are read from the archive file (not from the copy loaded in memory)
+		//and only extracted the first time they are played, so the pack's audio is not all kept in memory
+		if(!_oggArchive) {
+			_oggArchive.reset(new ZipReader());
+			_oggArchive->LoadArchiveFromFile(_hdPackFolder);
 		}
+		file.reset(new OggFile(VirtualFile(_hdPackFolder, filename), _oggArchive, filename));
+	} else {
+		file.reset(new OggFile(FolderUtilities::CombinePath(_hdPackFolder, filename)));
+	}
+
+	if(!file->IsValid()) {
+		MessageManager::Log("[HDPack] Invalid OGG file: " + filename);
 	}
+	return file;
 }
 
 vector<HdPackCondition*> HdPackLoader::ParseConditionString(string conditionString, vector<unique_ptr<HdPackCondition>> &conditions)
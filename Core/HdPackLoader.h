@@ -14,6 +14,7 @@ private:
 	HdPackData* _data;
 	bool _loadFromZip = false;
 	ZipReader _reader;
+	shared_ptr<ZipReader> _oggArchive;
 	string _hdPackDefinitionFile;
 	string _hdPackFolder;
 	vector<HdPackBitmapInfo> _hdNesBitmaps;
@@ -44,6 +45,7 @@ private:
 	int ProcessSoundTrack(string albumString, string trackString, string filename);
 	void ProcessBgmTag(vector<string> &tokens);
 	void ProcessSfxTag(vector<string> &tokens);
+	shared_ptr<OggFile> LoadOggFile(string filename);
 
 	vector<HdPackCondition*> ParseConditionString(string conditionString, vector<unique_ptr<HdPackCondition>> &conditions);
 };
\ No newline at end of file
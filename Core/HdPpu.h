@@ -18,6 +18,7 @@ protected:
 	HdPackData *_hdData = nullptr;
 
 	void DrawPixel() override;
+	void DrawTile() override { DrawTileByPixel(); }
 
 public:
 	HdPpu(shared_ptr<Console> console, HdPackData* hdData);
@@ -67,8 +67,7 @@ void HistoryViewer::SeekTo(uint32_t seekPosition)
 		bool wasPaused = _console->GetSettings()->CheckFlag(EmulationFlags::Paused);
 		_console->GetSettings()->ClearFlags(EmulationFlags::Paused);
 		_position = seekPosition;
-		RewindData rewindData = _history[_position];
-		rewindData.LoadState(_console);
+		_history[_position].LoadState(_console, _history, _position);
 
 		_console->GetSoundMixer()->StopAudio(true);
 		_pollCounter = 0;
@@ -86,7 +85,7 @@ bool HistoryViewer::CreateSaveState(string outputFile, uint32_t position)
 	if(position < _history.size()) {
 		std::stringstream stateData;
 		_console->GetSaveStateManager()->GetSaveStateHeader(stateData);
-		_history[position].GetStateData(stateData);
+		_history[position].GetStateData(stateData, _history, position);
 
 		ofstream output(outputFile, ios::binary);
 		if(output) {
@@ -124,9 +123,9 @@ void HistoryViewer::ResumeGameplay(shared_ptr<Console> console, uint32_t resumeP
 		console->Initialize(_console->GetRomPath(), _console->GetPatchFile());
 	}
 	if(resumePosition < _history.size()) {
-		_history[resumePosition].LoadState(console);
+		_history[resumePosition].LoadState(console, _history, resumePosition);
 	} else {
-		_history[_history.size() - 1].LoadState(console);
+		_history[_history.size() - 1].LoadState(console, _history, (int32_t)_history.size() - 1);
 	}
 	console->Resume();
 }
@@ -159,7 +158,6 @@ void HistoryViewer::ProcessEndOfFrame()
 			return;
 		}
 
-		RewindData rewindData = _history[_position];
-		rewindData.LoadState(_console);
+		_history[_position].LoadState(_console, _history, _position);
 	}
 }
@@ -7,6 +7,10 @@ struct AudioStatistics
 	double AverageLatency = 0;
 	uint32_t BufferUnderrunEventCount = 0;
 	uint32_t BufferSize = 0;
+
+	//Amount of audio currently queued in the device's buffer, in ms (only for devices that can report it, used for rate control)
+	bool HasFillLevel = false;
+	double FillLevel = 0;
 };
 
 class IAudioDevice
@@ -347,6 +347,8 @@ protected:
 		}
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	uint8_t MapperReadVRAM(uint16_t addr, MemoryOperationType type) override
 	{
 		if(_irqSource == JyIrqSource::PpuRead && type == MemoryOperationType::PpuRenderingRead) {
@@ -80,6 +80,8 @@ class MMC2 : public BaseMapper
 		}
 
 	public:
+		bool AllowPpuBatching() override { return false; }
+
 		virtual void NotifyVRAMAddressChange(uint16_t addr) override
 		{
 			if(_needChrUpdate) {
@@ -263,6 +263,8 @@ class MMC3 : public BaseMapper
 		}
 
 	public:
+		bool AllowPpuBatching() override { return false; }
+
 		virtual void NotifyVRAMAddressChange(uint16_t addr) override
 		{
 			if(_a12Watcher.UpdateVramAddress(addr, _console->GetPpu()->GetFrameCycle()) == A12StateChange::Rise) {
@@ -476,6 +476,8 @@ protected:
 		}
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	virtual uint8_t MapperReadVRAM(uint16_t addr, MemoryOperationType memoryOperationType) override
 	{
 		bool isNtFetch = addr >= 0x2000 && addr <= 0x2FFF && (addr & 0x3FF) < 0x3C0;
@@ -93,6 +93,8 @@ protected:
 		);
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	virtual void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		if((_mode & 0x03) == 1) {
@@ -33,6 +33,8 @@ protected:
 		Stream(_irqCounter, _irqEnabled, _irqEnabledAlt, _irqReloadValue, a12Watcher);
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		if(_a12Watcher.UpdateVramAddress(addr, _console->GetPpu()->GetFrameCycle()) == A12StateChange::Rise) {
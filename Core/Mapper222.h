@@ -28,6 +28,8 @@ protected:
 		Stream(_irqCounter, a12Watcher);
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	virtual void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		if(_a12Watcher.UpdateVramAddress(addr, _console->GetPpu()->GetFrameCycle()) == A12StateChange::Rise) {
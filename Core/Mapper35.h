@@ -56,6 +56,8 @@ protected:
 		}
 	}
 	
+	bool AllowPpuBatching() override { return false; }
+
 	virtual void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		//MMC3-style A12 IRQ counter
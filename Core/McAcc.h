@@ -26,6 +26,8 @@ protected:
 		MMC3::WriteRegister(addr, value);
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		if(!(addr & 0x1000) && (_prevAddr & 0x1000)) {
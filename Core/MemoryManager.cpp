@@ -33,6 +33,34 @@ MemoryManager::~MemoryManager()
 void MemoryManager::SetMapper(shared_ptr<BaseMapper> mapper)
 {
 	_mapper = mapper;
+	_prgDirectReadPages = mapper->GetPrgDirectReadPages();
+	UpdatePageTypes();
+}
+
+void MemoryManager::UpdatePageTypes()
+{
+	//A page can only use the fast path if all of its addresses are mapped to the same handler
+	for(int page = 0; page < 0x100; page++) {
+		IMemoryHandler* readHandler = _ramReadHandlers[page << 8];
+		IMemoryHandler* writeHandler = _ramWriteHandlers[page << 8];
+		for(int i = 1; i < 0x100; i++) {
+			if(_ramReadHandlers[(page << 8) | i] != readHandler) {
+				readHandler = nullptr;
+			}
+			if(_ramWriteHandlers[(page << 8) | i] != writeHandler) {
+				writeHandler = nullptr;
+			}
+		}
+
+		if(readHandler == &_internalRamHandler) {
+			_readPageTypes[page] = ReadPageType::InternalRam;
+		} else if(readHandler && readHandler == _mapper.get()) {
+			_readPageTypes[page] = ReadPageType::Mapper;
+		} else {
+			_readPageTypes[page] = ReadPageType::Handler;
+		}
+		_internalRamWritePages[page] = writeHandler == &_internalRamHandler;
+	}
 }
 
 void MemoryManager::Reset(bool softReset)
@@ -61,6 +89,7 @@ void MemoryManager::RegisterIODevice(IMemoryHandler *handler)
 
 	InitializeMemoryHandlers(_ramReadHandlers, handler, ranges.GetRAMReadAddresses(), ranges.GetAllowOverride());
 	InitializeMemoryHandlers(_ramWriteHandlers, handler, ranges.GetRAMWriteAddresses(), ranges.GetAllowOverride());
+	UpdatePageTypes();
 }
 
 void MemoryManager::RegisterWriteHandler(IMemoryHandler* handler, uint32_t start, uint32_t end)
@@ -68,6 +97,7 @@ void MemoryManager::RegisterWriteHandler(IMemoryHandler* handler, uint32_t start
 	for(uint32_t i = start; i < end; i++) {
 		_ramWriteHandlers[i] = handler;
 	}
+	UpdatePageTypes();
 }
 
 void MemoryManager::UnregisterIODevice(IMemoryHandler *handler)
@@ -82,6 +112,7 @@ void MemoryManager::UnregisterIODevice(IMemoryHandler *handler)
 	for(uint16_t address : *ranges.GetRAMWriteAddresses()) {
 		_ramWriteHandlers[address] = &_openBusHandler;
 	}
+	UpdatePageTypes();
 }
 
 uint8_t* MemoryManager::GetInternalRAM()
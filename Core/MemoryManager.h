@@ -9,6 +9,13 @@
 class BaseMapper;
 class Console;
 
+enum class ReadPageType : uint8_t
+{
+	Handler = 0,
+	InternalRam = 1,
+	Mapper = 2
+};
+
 class MemoryManager : public Snapshotable
 {
 	private:
@@ -25,7 +32,13 @@ class MemoryManager : public Snapshotable
 		IMemoryHandler** _ramReadHandlers;
 		IMemoryHandler** _ramWriteHandlers;
 
+		//Used by the fast path to bypass the memory handlers (for internal RAM and for PRG pages mapped by the mapper)
+		ReadPageType _readPageTypes[0x100];
+		bool _internalRamWritePages[0x100];
+		uint8_t** _prgDirectReadPages = nullptr;
+
 		void InitializeMemoryHandlers(IMemoryHandler** memoryHandlers, IMemoryHandler* handler, vector<uint16_t> *addresses, bool allowOverride);
+		void UpdatePageTypes();
 
 	protected:
 		void StreamState(bool saving) override;
@@ -52,6 +65,52 @@ class MemoryManager : public Snapshotable
 		uint8_t Read(uint16_t addr, MemoryOperationType operationType = MemoryOperationType::Read);
 		void Write(uint16_t addr, uint8_t value, MemoryOperationType operationType);
 
+		//Equivalent to Read/Write, but skips the cheat/debugger hooks - only valid when Console::HasMemoryHooks() is false
+		__forceinline uint8_t FastRead(uint16_t addr)
+		{
+			uint8_t value;
+			switch(_readPageTypes[addr >> 8]) {
+				case ReadPageType::InternalRam:
+					value = _internalRAM[addr & (MemoryManager::InternalRAMSize - 1)];
+					break;
+
+				case ReadPageType::Mapper: {
+					//Pages that contain registers or that aren't readable go through the mapper's ReadRAM
+					uint8_t* page = _prgDirectReadPages[addr >> 8];
+					value = page ? page[(uint8_t)addr] : _ramReadHandlers[addr]->ReadRAM(addr);
+					break;
+				}
+
+				default:
+					value = _ramReadHandlers[addr]->ReadRAM(addr);
+					break;
+			}
+
+			_openBusHandler.SetOpenBus(value);
+			return value;
+		}
+
+		__forceinline void FastWrite(uint16_t addr, uint8_t value)
+		{
+			if(_internalRamWritePages[addr >> 8]) {
+				_internalRAM[addr & (MemoryManager::InternalRAMSize - 1)] = value;
+			} else {
+				_ramWriteHandlers[addr]->WriteRAM(addr, value);
+			}
+		}
+
+		//True when FastRead/FastWrite only touch memory (internal RAM or PRG pages), and can't have side effects on the PPU or the mapper
+		bool IsDirectRead(uint16_t addr)
+		{
+			ReadPageType type = _readPageTypes[addr >> 8];
+			return type == ReadPageType::InternalRam || (type == ReadPageType::Mapper && _prgDirectReadPages[addr >> 8]);
+		}
+
+		bool IsDirectWrite(uint16_t addr)
+		{
+			return _internalRamWritePages[addr >> 8];
+		}
+
 		uint32_t ToAbsolutePrgAddress(uint16_t ramAddr);
 
 		uint8_t GetOpenBus(uint8_t mask = 0xFF);
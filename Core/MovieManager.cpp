@@ -18,7 +18,7 @@ void MovieManager::Record(RecordMovieOptions options, shared_ptr<Console> consol
 	}
 }
 
-void MovieManager::Play(VirtualFile file, shared_ptr<Console> console)
+shared_ptr<IMovie> MovieManager::LoadMovie(VirtualFile file, shared_ptr<Console> console)
 {
 	vector<uint8_t> fileData;
 	if(file.IsValid() && file.ReadFile(fileData)) {
@@ -42,11 +42,20 @@ void MovieManager::Play(VirtualFile file, shared_ptr<Console> console)
 		}
 
 		if(player && player->Play(file)) {
-			_player = player;
-
-			MessageManager::DisplayMessage("Movies", "MoviePlaying", file.GetFileName());
+			return player;
 		}
 	}
+	return nullptr;
+}
+
+void MovieManager::Play(VirtualFile file, shared_ptr<Console> console)
+{
+	shared_ptr<IMovie> player = LoadMovie(file, console);
+	if(player) {
+		_player = player;
+
+		MessageManager::DisplayMessage("Movies", "MoviePlaying", file.GetFileName());
+	}
 }
 
 void MovieManager::Stop()
@@ -23,6 +23,7 @@ private:
 	static shared_ptr<MovieRecorder> _recorder;
 
 public:
+	static shared_ptr<IMovie> LoadMovie(VirtualFile file, shared_ptr<Console> console);
 	static void Record(RecordMovieOptions options, shared_ptr<Console> console);
 	static void Play(VirtualFile file, shared_ptr<Console> console);
 	static void Stop();
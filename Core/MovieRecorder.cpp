@@ -239,7 +239,7 @@ bool MovieRecorder::CreateMovie(string movieFile, std::deque<RewindData> &data,
 			_hasSaveState = true;
 			_saveStateData = stringstream();
 			_console->GetSaveStateManager()->GetSaveStateHeader(_saveStateData);
-			data[startPosition].GetStateData(_saveStateData);
+			data[startPosition].GetStateData(_saveStateData, data, startPosition);
 		}
 
 		_inputData = stringstream();
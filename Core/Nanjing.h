@@ -102,6 +102,8 @@ public:
 		return 4;
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	virtual void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		PPU *ppu = _console->GetPpu();
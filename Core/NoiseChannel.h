@@ -39,6 +39,22 @@ protected:
 		}
 	}
 
+	bool SkipClocks(uint32_t clockCount) override
+	{
+		if(_lastOutput != 0 || GetVolume() > 0) {
+			return false;
+		}
+
+		//Silent channel, only the shift register needs to be updated
+		bool mode = _console->GetSettings()->CheckFlag(EmulationFlags::DisableNoiseModeFlag) ? false : _modeFlag;
+		uint8_t shift = mode ? 6 : 1;
+		for(uint32_t i = 0; i < clockCount; i++) {
+			uint16_t feedback = (_shiftRegister & 0x01) ^ ((_shiftRegister >> shift) & 0x01);
+			_shiftRegister = (_shiftRegister >> 1) | (feedback << 14);
+		}
+		return true;
+	}
+
 public:
 	NoiseChannel(AudioChannel channel, shared_ptr<Console> console, SoundMixer* mixer) : ApuEnvelope(channel, console, mixer)
 	{
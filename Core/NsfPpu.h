@@ -6,6 +6,7 @@ class NsfPpu : public PPU
 {
 protected:
 	void DrawPixel() override;
+	void DrawTile() override { DrawTileByPixel(); }
 
 public:
 	using PPU::PPU;
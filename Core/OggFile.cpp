@@ -0,0 +1,91 @@
+#include "stdafx.h"
+#include "OggFile.h"
+#include "../Utilities/ZipReader.h"
+
+OggFile::OggFile(string path)
+{
+	_path = path;
+	if(_mappedFile.Open(path)) {
+		_data = _mappedFile.GetData();
+		_size = _mappedFile.GetSize();
+		ParseHeader(_data, _size);
+	}
+}
+
+OggFile::OggFile(string path, shared_ptr<ZipReader> archive, string filename)
+{
+	_path = path;
+	_archive = archive;
+	_archiveFilename = filename;
+
+	vector<uint8_t> header;
+	if(_archive->ExtractFile(filename, header, OggFile::HeaderSize)) {
+		ParseHeader(header.data(), header.size());
+	}
+}
+
+bool OggFile::Load()
+{
+	if(_archive) {
+		//Only the decoder thread reads the archive once the pack is loaded
+		if(!_archive->ExtractFile(_archiveFilename, _fileData)) {
+			return false;
+		}
+		_archive.reset();
+		_data = _fileData.data();
+		_size = _fileData.size();
+	}
+	return _data != nullptr;
+}
+
+void OggFile::ParseHeader(const uint8_t* data, size_t size)
+{
+	//The first page of the stream contains only the vorbis identification header:
+	//"OggS" page header (27 bytes) + segment table, followed by packet type 1, "vorbis", version (4 bytes), channel count (1 byte), sample rate (4 bytes)
+	if(size < 27 || memcmp(data, "OggS", 4) != 0) {
+		return;
+	}
+
+	size_t packetStart = 27 + data[26];
+	if(size < packetStart + 16) {
+		return;
+	}
+
+	const uint8_t* packet = data + packetStart;
+	if(packet[0] != 0x01 || memcmp(packet + 1, "vorbis", 6) != 0) {
+		return;
+	}
+
+	uint32_t version = packet[7] | (packet[8] << 8) | (packet[9] << 16) | ((uint32_t)packet[10] << 24);
+	if(version != 0) {
+		return;
+	}
+
+	_channelCount = packet[11];
+	_sampleRate = packet[12] | (packet[13] << 8) | (packet[14] << 16) | ((uint32_t)packet[15] << 24);
+}
+
+bool OggFile::IsValid()
+{
+	return _channelCount > 0 && _sampleRate > 0;
+}
+
+string OggFile::GetPath()
+{
+	return _path;
+}
+
+const uint8_t* OggFile::GetData()
+{
+	return _data;
+}
+
+size_t OggFile::GetSize()
+{
+	return _size;
+}
+
+uint32_t OggFile::GetSampleRate()
+{
+	return _sampleRate;
+}
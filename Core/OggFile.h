@@ -0,0 +1,43 @@
+#pragma once
+#include "stdafx.h"
+#include "../Utilities/MemoryMappedFile.h"
+
+class ZipReader;
+
+//An HD pack's BGM/SFX file - its header is parsed when the pack is loaded, so starting a track does not need to parse the file again
+class OggFile
+{
+private:
+	//"OggS" page header + largest segment table + vorbis identification header
+	static constexpr size_t HeaderSize = 27 + 255 + 30;
+
+	string _path;
+	MemoryMappedFile _mappedFile;
+	vector<uint8_t> _fileData;
+
+	shared_ptr<ZipReader> _archive;
+	string _archiveFilename;
+
+	const uint8_t* _data = nullptr;
+	size_t _size = 0;
+	uint32_t _sampleRate = 0;
+	uint8_t _channelCount = 0;
+
+	void ParseHeader(const uint8_t* data, size_t size);
+
+public:
+	//Memory-maps a file from the HD pack's folder
+	OggFile(string path);
+
+	//File inside the HD pack's archive - only its header is read here, the file is extracted the first time it is played (and then kept in memory)
+	OggFile(string path, shared_ptr<ZipReader> archive, string filename);
+
+	//Called by the OggMixer's decoder thread before the file is decoded - returns false if the file's content could not be read
+	bool Load();
+
+	bool IsValid();
+	string GetPath();
+	const uint8_t* GetData();
+	size_t GetSize();
+	uint32_t GetSampleRate();
+};
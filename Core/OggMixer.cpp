@@ -11,12 +11,55 @@ enum class OggPlaybackOptions
 
 OggMixer::OggMixer()
 {
+	_stopDecoder = false;
+}
+
+OggMixer::~OggMixer()
+{
+	if(_decoderThread.joinable()) {
+		_stopDecoder = true;
+		_decodeEvent.Signal();
+		_decoderThread.join();
+	}
+}
+
+void OggMixer::DecoderThread()
+{
+	vector<shared_ptr<OggReader>> readers;
+	while(!_stopDecoder) {
+		{
+			auto lock = _readerLock.AcquireSafe();
+			readers = _activeReaders;
+		}
+
+		//Decode a chunk for each track in turn, and sleep once all of their buffers are full
+		bool decoded = false;
+		for(shared_ptr<OggReader> &reader : readers) {
+			decoded |= reader->DecodeChunk();
+		}
+		readers.clear();
+
+		if(!decoded) {
+			_decodeEvent.Wait();
+		}
+	}
+}
+
+void OggMixer::UpdateActiveReaders()
+{
+	auto lock = _readerLock.AcquireSafe();
+	_activeReaders.clear();
+	if(_bgm) {
+		_activeReaders.push_back(_bgm);
+	}
+	_activeReaders.insert(_activeReaders.end(), _sfx.begin(), _sfx.end());
 }
 
 void OggMixer::Reset(uint32_t sampleRate)
 {
 	_bgm.reset();
 	_sfx.clear();
+	UpdateActiveReaders();
 	_sfxVolume = 128;
 	_bgmVolume = 128;
 	_options = 0;
@@ -42,11 +85,13 @@ void OggMixer::SetPausedFlag(bool paused)
 void OggMixer::StopBgm()
 {
 	_bgm.reset();
+	UpdateActiveReaders();
 }
 
 void OggMixer::StopSfx()
 {
 	_sfx.clear();
+	UpdateActiveReaders();
 }
 
 void OggMixer::SetBgmVolume(uint8_t volume)
@@ -80,16 +125,23 @@ void OggMixer::SetSampleRate(int sampleRate)
 	}
 }
 
-bool OggMixer::Play(string filename, bool isSfx, uint32_t startOffset)
+bool OggMixer::Play(shared_ptr<OggFile> file, bool isSfx, uint32_t startOffset)
 {
-	shared_ptr<OggReader> reader(new OggReader());
+	shared_ptr<OggReader> reader(new OggReader(&_decodeEvent));
 	bool loop = !isSfx && (_options & (int)OggPlaybackOptions::Loop) != 0;
-	if(reader->Init(filename, loop, _sampleRate, startOffset)) {
+	if(reader->Init(file, isSfx, loop, _sampleRate, startOffset)) {
 		if(isSfx) {
 			_sfx.push_back(reader);
 		} else {
 			_bgm = reader;
 		}
+		UpdateActiveReaders();
+
+		//The file is opened and decoded by the decoder thread, while the emulation thread runs the rest of the frame
+		if(!_decoderThread.joinable()) {
+			_decoderThread = std::thread(&OggMixer::DecoderThread, this);
+		}
+		_decodeEvent.Signal();
 		return true;
 	}
 	return false;
@@ -97,16 +149,23 @@ bool OggMixer::Play(string filename, bool isSfx, uint32_t startOffset)
 
 void OggMixer::ApplySamples(int16_t * buffer, size_t sampleCount, double masterVolumne)
 {
+	bool readersChanged = false;
 	if(_bgm && !_paused) {
 		_bgm->ApplySamples(buffer, sampleCount, _bgmVolume, masterVolumne);
 		if(_bgm->IsPlaybackOver()) {
 			_bgm.reset();
+			readersChanged = true;
 		}
 	}
 	for(shared_ptr<OggReader> &sfx : _sfx) {
 		sfx->ApplySamples(buffer, sampleCount, _sfxVolume, masterVolumne);
 	}
+
+	size_t sfxCount = _sfx.size();
 	_sfx.erase(std::remove_if(_sfx.begin(), _sfx.end(), [](const shared_ptr<OggReader>& o) { return o->IsPlaybackOver(); }), _sfx.end());
+	if(readersChanged || sfxCount != _sfx.size()) {
+		UpdateActiveReaders();
+	}
 }
 
 int OggMixer::GetBgmOffset()
@@ -1,7 +1,11 @@
 #pragma once
 #include "stdafx.h"
+#include <thread>
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/AutoResetEvent.h"
 
 class OggReader;
+class OggFile;
 
 class OggMixer
 {
@@ -15,14 +19,25 @@ private:
 	uint8_t _options;
 	bool _paused;
 
+	//The decoder thread prefetches the decoded samples of all tracks that are playing
+	std::thread _decoderThread;
+	AutoResetEvent _decodeEvent;
+	atomic<bool> _stopDecoder;
+	SimpleLock _readerLock;
+	vector<shared_ptr<OggReader>> _activeReaders;
+
+	void DecoderThread();
+	void UpdateActiveReaders();
+
 public:
 	OggMixer();
+	~OggMixer();
 
 	void SetSampleRate(int sampleRate);
 	void ApplySamples(int16_t* buffer, size_t sampleCount, double masterVolumne);
 	
 	void Reset(uint32_t sampleRate);
-	bool Play(string filename, bool isSfx, uint32_t startOffset);
+	bool Play(shared_ptr<OggFile> file, bool isSfx, uint32_t startOffset);
 	void SetPlaybackOptions(uint8_t options);
 	void SetPausedFlag(bool paused);
 	void StopBgm();
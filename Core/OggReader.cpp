@@ -1,12 +1,20 @@
 #include "stdafx.h"
 #include "OggReader.h"
+#include "OggFile.h"
 
-OggReader::OggReader()
+OggReader::OggReader(AutoResetEvent* decodeEvent)
 {
+	_decodeEvent = decodeEvent;
+	_writePosition = 0;
+	_readPosition = 0;
+	_initialOffset = 0;
+	_opened = false;
+	_finished = false;
+	_failed = false;
+
 	_done = false;
 	_blipLeft = blip_new(10000);
 	_blipRight = blip_new(10000);
-	_oggBuffer = new int16_t[OggReader::SamplesToRead * 2];
 	_outputBuffer = new int16_t[2000];
 }
 
@@ -14,7 +22,6 @@ OggReader::~OggReader()
 {
 	blip_delete(_blipLeft);
 	blip_delete(_blipRight);
-	delete[] _oggBuffer;
 	delete[] _outputBuffer;
 
 	if(_vorbis) {
@@ -22,25 +29,102 @@ OggReader::~OggReader()
 	}
 }
 
-bool OggReader::Init(string filename, bool loop, uint32_t sampleRate, uint32_t startOffset)
+bool OggReader::Init(shared_ptr<OggFile> file, bool isSfx, bool loop, uint32_t sampleRate, uint32_t startOffset)
 {
-	int error;
-	VirtualFile file = filename;
-	_fileData = vector<uint8_t>(100000);
-	if(file.ReadFile(_fileData)) {
-		_vorbis = stb_vorbis_open_memory(_fileData.data(), (int)_fileData.size(), &error, nullptr);
+	//The file's header was already validated when the HD pack was loaded - the file is opened and decoded by the decoder thread
+	if(file && file->IsValid()) {
+		_file = file;
+		_loop = loop;
+		_restartAtEnd = !isSfx;
+		_startOffset = startOffset;
+		_oggSampleRate = file->GetSampleRate();
+		blip_set_rates(_blipLeft, _oggSampleRate, sampleRate);
+		blip_set_rates(_blipRight, _oggSampleRate, sampleRate);
+		return true;
+	}
+	return false;
+}
+
+bool OggReader::DecodeChunk()
+{
+	if(_finished) {
+		return false;
+	}
+
+	if(!_opened) {
+		int error;
+		if(_file->Load()) {
+			_vorbis = stb_vorbis_open_memory(_file->GetData(), (int)_file->GetSize(), &error, nullptr);
+		}
 		if(_vorbis) {
-			_loop = loop;
-			_oggSampleRate = stb_vorbis_get_info(_vorbis).sample_rate;
-			if(startOffset > 0) {
-				stb_vorbis_seek(_vorbis, startOffset);
+			if(_startOffset > 0) {
+				stb_vorbis_seek(_vorbis, _startOffset);
 			}
-			blip_set_rates(_blipLeft, _oggSampleRate, sampleRate);
-			blip_set_rates(_blipRight, _oggSampleRate, sampleRate);
-			return true;
+			_initialOffset = stb_vorbis_get_file_offset(_vorbis);
+			_opened = true;
+		} else {
+			_failed = true;
+			_finished = true;
 		}
+		NotifyDecoderProgress();
+		return true;
 	}
-	return false;
+
+	uint32_t writePosition = _writePosition.load(std::memory_order_relaxed);
+	if(writePosition - _readPosition.load(std::memory_order_acquire) >= OggReader::ChunkCount) {
+		//Prefetch buffer is full
+		return false;
+	}
+
+	OggChunk &chunk = _chunks[writePosition % OggReader::ChunkCount];
+	chunk.SampleCount = stb_vorbis_get_samples_short_interleaved(_vorbis, 2, chunk.Samples, OggReader::SamplesToRead * 2);
+	chunk.FileOffset = stb_vorbis_get_file_offset(_vorbis);
+
+	bool endOfFile = chunk.SampleCount < OggReader::SamplesToRead;
+	if(_samplesSinceRestart >= 0) {
+		_samplesSinceRestart += chunk.SampleCount;
+	}
+
+	//BGM keeps decoding from the start of the file, in case the track loops (the loop flag can change at any time)
+	//Files that contain no samples are not restarted (this would never end)
+	bool restart = endOfFile && _restartAtEnd && _samplesSinceRestart != 0;
+	if(restart) {
+		stb_vorbis_seek_start(_vorbis);
+		_samplesSinceRestart = 0;
+	}
+
+	_writePosition.store(writePosition + 1, std::memory_order_release);
+	if(endOfFile && !restart) {
+		_finished = true;
+	}
+	NotifyDecoderProgress();
+	return true;
+}
+
+void OggReader::NotifyDecoderProgress()
+{
+	//The state was updated before taking the lock: a waiting thread either sees the new state when it checks its condition, or is already waiting and gets notified
+	{
+		std::lock_guard<std::mutex> lock(_decoderLock);
+	}
+	_decoderSignal.notify_all();
+}
+
+OggReader::OggChunk* OggReader::GetNextChunk()
+{
+	uint32_t readPosition = _readPosition.load(std::memory_order_relaxed);
+	if(_writePosition.load(std::memory_order_acquire) == readPosition) {
+		//Underrun (e.g when the track just started), wait for the decoder thread to catch up
+		_decodeEvent->Signal();
+		std::unique_lock<std::mutex> lock(_decoderLock);
+		_decoderSignal.wait(lock, [this, readPosition] { return _writePosition.load(std::memory_order_acquire) != readPosition || _finished; });
+
+		//The decoder may have written its last chunk right before it finished
+		if(_writePosition.load(std::memory_order_acquire) == readPosition) {
+			return nullptr;
+		}
+	}
+	return &_chunks[readPosition % OggReader::ChunkCount];
 }
 
 bool OggReader::IsPlaybackOver()
@@ -67,18 +151,34 @@ void OggReader::SetLoopFlag(bool loop)
 
 bool OggReader::LoadSamples()
 {
-	int samplesReturned = stb_vorbis_get_samples_short_interleaved(_vorbis, 2, _oggBuffer, OggReader::SamplesToRead * 2);
+	int samplesReturned = 0;
+	if(!_endOfFile) {
+		OggChunk* chunk = GetNextChunk();
+		if(!chunk) {
+			//The file could not be decoded
+			_done = true;
+			return false;
+		}
 
-	for(int i = 0; i < samplesReturned; i++) {
-		blip_add_delta(_blipLeft, i, i == 0 ? 0 : (_oggBuffer[i * 2] - _oggBuffer[i * 2 - 2]));
-		blip_add_delta(_blipRight, i, i == 0 ? 0 : (_oggBuffer[i * 2 + 1] - _oggBuffer[i * 2 - 1]));
+		int16_t* oggBuffer = chunk->Samples;
+		samplesReturned = chunk->SampleCount;
+		for(int i = 0; i < samplesReturned; i++) {
+			blip_add_delta(_blipLeft, i, i == 0 ? 0 : (oggBuffer[i * 2] - oggBuffer[i * 2 - 2]));
+			blip_add_delta(_blipRight, i, i == 0 ? 0 : (oggBuffer[i * 2 + 1] - oggBuffer[i * 2 - 1]));
+		}
+
+		_offset = chunk->FileOffset;
+		_hasOffset = true;
+		_endOfFile = samplesReturned < OggReader::SamplesToRead;
+		_readPosition.store(_readPosition.load(std::memory_order_relaxed) + 1, std::memory_order_release);
 	}
 	blip_end_frame(_blipLeft, samplesReturned);
 	blip_end_frame(_blipRight, samplesReturned);
 
-	if(samplesReturned < OggReader::SamplesToRead) {
+	if(_endOfFile) {
 		if(_loop) {
-			stb_vorbis_seek_start(_vorbis);
+			//The decoder thread has already restarted from the start of the file
+			_endOfFile = false;
 			LoadSamples();
 		} else {
 			_done = true;
@@ -96,6 +196,9 @@ void OggReader::ApplySamples(int16_t * buffer, size_t sampleCount, uint8_t volum
 		}
 	}
 
+	//Let the decoder thread refill the chunks that were used
+	_decodeEvent->Signal();
+
 	int samplesRead = blip_read_samples(_blipLeft, _outputBuffer, (int)sampleCount, 1);
 	blip_read_samples(_blipRight, _outputBuffer + 1, (int)sampleCount, 1);
 
@@ -106,5 +209,12 @@ void OggReader::ApplySamples(int16_t * buffer, size_t sampleCount, uint8_t volum
 
 uint32_t OggReader::GetOffset()
 {
-	return stb_vorbis_get_file_offset(_vorbis);
-}
\ No newline at end of file
+	if(!_hasOffset) {
+		//No samples were played yet, wait for the decoder thread to open the file
+		_decodeEvent->Signal();
+		std::unique_lock<std::mutex> lock(_decoderLock);
+		_decoderSignal.wait(lock, [this] { return _opened || _failed; });
+		return _initialOffset;
+	}
+	return _offset;
+}
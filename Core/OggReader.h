@@ -1,20 +1,57 @@
 #pragma once
 #include "stdafx.h"
+#include <condition_variable>
+#include <mutex>
 #include "../Utilities/stb_vorbis.h"
 #include "../Utilities/blip_buf.h"
-#include "VirtualFile.h"
+#include "../Utilities/AutoResetEvent.h"
+
+class OggFile;
 
 class OggReader
 {
 private:
-	const int SamplesToRead = 100;
+	static constexpr int SamplesToRead = 100;
+
+	//Number of decoded chunks that are prefetched by the decoder thread (~145ms at 44.1kHz)
+	static constexpr uint32_t ChunkCount = 64;
+
+	struct OggChunk
+	{
+		int16_t Samples[OggReader::SamplesToRead * 2];
+		int SampleCount;
+		uint32_t FileOffset;
+	};
+
+	shared_ptr<OggFile> _file;
+	AutoResetEvent* _decodeEvent;
+
+	//Decoder thread's state
+	stb_vorbis* _vorbis = nullptr;
+	uint32_t _startOffset = 0;
+	bool _restartAtEnd = false;
+	int _samplesSinceRestart = -1;
+
+	//Chunks are written by the decoder thread and read by the emulation thread
+	OggChunk _chunks[ChunkCount];
+	atomic<uint32_t> _writePosition;
+	atomic<uint32_t> _readPosition;
+	atomic<uint32_t> _initialOffset;
+	atomic<bool> _opened;
+	atomic<bool> _finished;
+	atomic<bool> _failed;
+
+	//Signaled by the decoder thread when the file is opened and after each chunk, when the emulation thread waits for it
+	std::mutex _decoderLock;
+	std::condition_variable _decoderSignal;
 
-	stb_vorbis* _vorbis;
-	int16_t* _oggBuffer;
 	int16_t* _outputBuffer;
 
 	bool _loop;
 	bool _done;
+	bool _endOfFile = false;
+	bool _hasOffset = false;
+	uint32_t _offset = 0;
 
 	blip_t* _blipLeft;
 	blip_t* _blipRight;
@@ -22,18 +59,21 @@ private:
 	int _sampleRate;
 	int _oggSampleRate;
 
-	vector<uint8_t> _fileData;
-	
+	void NotifyDecoderProgress();
+	OggChunk* GetNextChunk();
 	bool LoadSamples();
 
 public:
-	OggReader();
+	OggReader(AutoResetEvent* decodeEvent);
 	~OggReader();
 
-	bool Init(string filename, bool loop, uint32_t sampleRate, uint32_t startOffset = 0);
+	bool Init(shared_ptr<OggFile> file, bool isSfx, bool loop, uint32_t sampleRate, uint32_t startOffset = 0);
 	bool IsPlaybackOver();
 	void SetSampleRate(int sampleRate);
 	void SetLoopFlag(bool loop);
 	void ApplySamples(int16_t* buffer, size_t sampleCount, uint8_t volume, double masterVolume);
 	uint32_t GetOffset();
+
+	//Called by the decoder thread - decodes the next chunk, returns false when there is nothing to do
+	bool DecodeChunk();
 };
@@ -871,6 +871,42 @@ void PPU::DrawPixel()
 	}
 }
 
+void PPU::DrawTile()
+{
+	uint8_t offset = _state.XScroll;
+	bool backgroundEnabled = _settings->GetBackgroundEnabled();
+	uint16_t *out = _currentOutputBuffer + (_scanline << 8) + _cycle;
+	uint32_t cycle = _cycle;
+	for(uint32_t i = 0; i < 8; i++) {
+		uint8_t color;
+		if(_hasSprite[cycle + i + 1]) {
+			_cycle = cycle + i + 1;
+			color = GetPixelColor();
+		} else {
+			//Same as GetPixelColor, when there are no sprites on this pixel
+			uint8_t backgroundColor = 0;
+			if(backgroundEnabled && cycle + i + 1 > _minimumDrawBgCycle) {
+				backgroundColor = (((_state.LowBitShift << offset) & 0x8000) >> 15) | (((_state.HighBitShift << offset) & 0x8000) >> 14);
+			}
+			color = ((offset + i < 8) ? _previousTile : _currentTile).PaletteOffset + backgroundColor;
+		}
+		out[i] = _paletteRAM[color & 0x03 ? color : 0];
+		ShiftTileRegisters();
+	}
+	_cycle = cycle;
+}
+
+void PPU::DrawTileByPixel()
+{
+	uint32_t cycle = _cycle;
+	for(uint32_t i = 1; i <= 8; i++) {
+		_cycle = cycle + i;
+		DrawPixel();
+		ShiftTileRegisters();
+	}
+	_cycle = cycle;
+}
+
 uint16_t PPU::GetCurrentBgColor()
 {
 	uint16_t color;
@@ -1007,6 +1043,79 @@ void PPU::ProcessScanline()
 	}
 }
 
+void PPU::RenderScanline()
+{
+	//Processes the rest of a visible scanline (from dot _cycle+1 to dot 340) in one go, with rendering enabled
+	//Same result as ProcessScanline on each dot - the work is only grouped differently: _cycle must be a multiple of 8 (up to 256)
+	//Tile fetches, pixel output and sprite evaluation don't depend on each other within the scanline, so each one is done for the whole scanline at once
+	uint32_t startCycle = _cycle;
+
+	//Dots 1-256: background tiles and pixel output, 1 tile (8 dots) at a time
+	for(uint32_t tileCycle = startCycle; tileCycle < 256; tileCycle += 8) {
+		for(uint32_t i = 1; i < 8; i += 2) {
+			_cycle = tileCycle + i;
+			LoadTileInfo();
+		}
+
+		_cycle = tileCycle;
+		DrawTile();
+
+		IncHorizontalScrolling();
+		if(tileCycle == 248) {
+			IncVerticalScrolling();
+		}
+	}
+
+	//Dots 1-64: secondary OAM clear, dots 65-256: sprite evaluation
+	if(startCycle < 64) {
+		_oamCopybuffer = 0xFF;
+		memset(_secondarySpriteRAM + (startCycle >> 1), 0xFF, (64 - startCycle) >> 1);
+	}
+	for(uint32_t cycle = std::max<uint32_t>(startCycle + 1, 65); cycle <= 256; cycle++) {
+		_cycle = cycle;
+		ProcessSpriteEvaluation();
+	}
+
+	//Dots 257-320: sprite tile fetches
+	_cycle = 257;
+	_spriteIndex = 0;
+	memset(_hasSprite, 0, sizeof(_hasSprite));
+	_state.VideoRamAddr = (_state.VideoRamAddr & ~0x041F) | (_state.TmpVideoRamAddr & 0x041F);
+	_console->DebugSetLastFramePpuScroll(_state.VideoRamAddr, _state.XScroll, true);
+	_state.SpriteRamAddr = 0;
+	for(uint32_t cycle = 257; cycle < 320; cycle += 8) {
+		//Garbage NT/AT fetches, followed by the sprite's tile
+		_cycle = cycle;
+		ReadVram(GetNameTableAddr());
+		_cycle = cycle + 2;
+		ReadVram(GetAttributeAddr());
+		_cycle = cycle + 4;
+		LoadSpriteTileInfo();
+	}
+
+	//Dots 321-336: first 2 tiles of the next scanline
+	_cycle = 321;
+	LoadExtraSprites();
+	_oamCopybuffer = _secondarySpriteRAM[0];
+	for(uint32_t tileCycle = 320; tileCycle < 336; tileCycle += 8) {
+		for(uint32_t i = 1; i < 8; i += 2) {
+			_cycle = tileCycle + i;
+			LoadTileInfo();
+		}
+		_state.LowBitShift <<= 8;
+		_state.HighBitShift <<= 8;
+		IncHorizontalScrolling();
+	}
+
+	//Dots 337-340: garbage NT fetches
+	_cycle = 337;
+	ReadVram(GetNameTableAddr());
+	_cycle = 339;
+	ReadVram(GetNameTableAddr());
+
+	_cycle = 340;
+}
+
 void PPU::ProcessSpriteEvaluation()
 {
 	if(IsRenderingEnabled() || (_nesModel == NesModel::PAL && _scanline >= _palSpriteEvalScanline)) {
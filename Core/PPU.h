@@ -149,6 +149,12 @@ class PPU : public IMemoryHandler, public Snapshotable
 
 		uint8_t GetPixelColor();
 		__forceinline virtual void DrawPixel();
+
+		//Outputs the 8 pixels of the tile that starts after _cycle (dots _cycle+1 to _cycle+8) and shifts the tile registers
+		//Same result as calling DrawPixel and ShiftTileRegisters on each of these dots (used by RenderScanline)
+		virtual void DrawTile();
+		void DrawTileByPixel();
+		void RenderScanline();
 		void UpdateGrayscaleAndIntensifyBits();
 		virtual void SendFrame();
 
@@ -210,6 +216,8 @@ class PPU : public IMemoryHandler, public Snapshotable
 		void Exec();
 		__forceinline void Run(uint64_t runTo);
 
+		__forceinline uint64_t GetNextSyncClock();
+
 		uint32_t GetFrameCount()
 		{
 			return _frameCount;
@@ -254,7 +262,36 @@ class PPU : public IMemoryHandler, public Snapshotable
 void PPU::Run(uint64_t runTo)
 {
 	while(_masterClock + _masterClockDivider <= runTo) {
+		if(!_needStateUpdate && _cycle < 340 && _masterClock + _masterClockDivider * (340 - _cycle) <= runTo) {
+			//The rest of the scanline can be processed at once (this only happens when the PPU runs behind the CPU, see EmulationFlags::BatchPpuRendering)
+			//Nothing else can access the PPU until runTo, so this has the same result as running each dot
+			uint32_t dots = 340 - _cycle;
+			if(_scanline >= 0 && _scanline < 240 && (_cycle & 0x07) == 0 && _cycle <= 256 && IsRenderingEnabled()) {
+				RenderScanline();
+				_masterClock += _masterClockDivider * dots;
+				continue;
+			} else if(_scanline >= 240 && _cycle >= 1 && !(_nesModel == NesModel::PAL && _scanline >= _palSpriteEvalScanline)) {
+				//Nothing happens during the rest of the post-render/vblank scanlines
+				_cycle = 340;
+				_masterClock += _masterClockDivider * dots;
+				continue;
+			}
+		}
+
 		Exec();
 		_masterClock += _masterClockDivider;
 	}
 }
+
+uint64_t PPU::GetNextSyncClock()
+{
+	//Returns the master clock of the next dot that can affect the rest of the console (start of a scanline: frame end, input polling, APU status - dot 1 of the pre-render/NMI scanlines: NMI flag)
+	//The pre-render scanline can end a dot early (odd frame skip), so it is assumed to be 1 dot shorter
+	uint32_t dots;
+	if(_cycle > 339 || (_cycle == 0 && (_scanline == -1 || _scanline == _nmiScanline))) {
+		dots = 1;
+	} else {
+		dots = (_scanline == -1 ? 340 : 341) - _cycle;
+	}
+	return _masterClock + _masterClockDivider * dots;
+}
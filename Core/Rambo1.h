@@ -154,6 +154,8 @@ protected:
 	}
 
 public:
+	bool AllowPpuBatching() override { return false; }
+
 	virtual void NotifyVRAMAddressChange(uint16_t addr) override
 	{
 		if(!_irqCycleMode) {
@@ -179,9 +179,8 @@ void RecordedRomTest::RecordFromTest(string newTestFilename, string existingTest
 	}
 }
 
-int32_t RecordedRomTest::Run(string filename)
+void RecordedRomTest::ApplyTestSettings(EmulationSettings* settings, string filename)
 {
-	EmulationSettings* settings = _console->GetSettings();
 	string testName = FolderUtilities::GetFilename(filename, false);
 	if(testName.compare("5.MMC3_rev_A") == 0 || testName.compare("6-MMC6") == 0 || testName.compare("6-MMC3_alt") == 0) {
 		settings->SetFlags(EmulationFlags::Mmc3IrqAltBehavior);
@@ -194,6 +193,12 @@ int32_t RecordedRomTest::Run(string filename)
 	} else {
 		settings->SetNesModel(NesModel::NTSC);
 	}
+}
+
+int32_t RecordedRomTest::Run(string filename)
+{
+	EmulationSettings* settings = _console->GetSettings();
+	ApplyTestSettings(settings, filename);
 
 	VirtualFile testMovie(filename, "TestMovie.mmo");
 	VirtualFile testRom(filename, "TestRom.nes");
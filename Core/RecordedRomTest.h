@@ -7,6 +7,7 @@
 
 class VirtualFile;
 class Console;
+class EmulationSettings;
 
 class RecordedRomTest : public INotificationListener
 {
@@ -48,4 +49,6 @@ public:
 	void RecordFromTest(string newTestFilename, string existingTestFilename);
 	int32_t Run(string filename);
 	void Stop();
+
+	static void ApplyTestSettings(EmulationSettings* settings, string filename);
 };
\ No newline at end of file
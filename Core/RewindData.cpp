@@ -3,44 +3,129 @@
 #include "Console.h"
 #include "../Utilities/miniz.h"
 
-void RewindData::GetStateData(stringstream &stateData)
+bool RewindData::HasFullState()
+{
+	return IsFullState;
+}
+
+uint32_t RewindData::GetMemoryUsage()
+{
+	uint32_t size = (uint32_t)(sizeof(RewindData) + SaveStateData.capacity());
+	for(int i = 0; i < BaseControlDevice::PortCount; i++) {
+		for(ControlDeviceState &state : InputLogs[i]) {
+			size += (uint32_t)(sizeof(ControlDeviceState) + state.State.capacity());
+		}
+	}
+	return size;
+}
+
+void RewindData::DecompressState(vector<uint8_t> &stateData)
 {
 	unsigned long length = OriginalSaveStateSize;
-	uint8_t* buffer = new uint8_t[length];
-	uncompress(buffer, &length, SaveStateData.data(), (unsigned long)SaveStateData.size());
-	stateData.write((char*)buffer, length);
-	delete[] buffer;
+	stateData.resize(length);
+	if(SaveStateData.empty() || uncompress(stateData.data(), &length, SaveStateData.data(), (unsigned long)SaveStateData.size()) != MZ_OK) {
+		length = 0;
+	}
+	stateData.resize(length);
 }
 
-void RewindData::LoadState(shared_ptr<Console> &console)
+void RewindData::ApplyDelta(vector<uint8_t> &stateData, vector<uint8_t> &delta)
 {
-	if(SaveStateData.size() > 0 && OriginalSaveStateSize > 0) {
-		unsigned long length = OriginalSaveStateSize;
-		uint8_t* buffer = new uint8_t[length];
-		uncompress(buffer, &length, SaveStateData.data(), (unsigned long)SaveStateData.size());
-		console->LoadState(buffer, length);
-		delete[] buffer;
+	//XOR is its own inverse, this is used both to create a delta and to apply it
+	//The delta covers the whole (new) state - any bytes past the end of the previous state are XORed with 0
+	stateData.resize(delta.size(), 0);
+	uint8_t* dst = stateData.data();
+	uint8_t* src = delta.data();
+	for(size_t i = 0, len = delta.size(); i < len; i++) {
+		dst[i] ^= src[i];
 	}
 }
 
-void RewindData::CompressState(string stateData, vector<uint8_t>& compressedState)
+bool RewindData::GetStateData(vector<uint8_t> &stateData, std::deque<RewindData> &prevStates, int32_t position)
 {
-	unsigned long compressedSize = compressBound((unsigned long)stateData.size());
-	uint8_t* compressedData = new uint8_t[compressedSize];
-	compress(compressedData, &compressedSize, (unsigned char*)stateData.c_str(), (unsigned long)stateData.size());
-	compressedState = vector<uint8_t>(compressedData, compressedData + compressedSize);
-	delete[] compressedData;
+	if(position < 0) {
+		position = (int32_t)prevStates.size();
+	}
+
+	if(IsFullState) {
+		DecompressState(stateData);
+		return !stateData.empty();
+	}
+
+	//Find the closest full state, and rebuild this state by applying every delta that follows it
+	int32_t start = position - 1;
+	while(start > 0 && !prevStates[start].IsFullState) {
+		start--;
+	}
+
+	if(start < 0 || !prevStates[start].IsFullState) {
+		//The full state this delta depends on is no longer available
+		stateData.clear();
+		return false;
+	}
+
+	vector<uint8_t> delta;
+	prevStates[start].DecompressState(stateData);
+	for(int32_t i = start + 1; i < position; i++) {
+		prevStates[i].DecompressState(delta);
+		ApplyDelta(stateData, delta);
+	}
+	DecompressState(delta);
+	ApplyDelta(stateData, delta);
+
+	return !stateData.empty();
 }
 
-void RewindData::SaveState(shared_ptr<Console> &console)
+void RewindData::GetStateData(stringstream &stateData, std::deque<RewindData> &prevStates, int32_t position)
 {
-	std::stringstream state;
-	console->SaveState(state);
+	vector<uint8_t> data;
+	if(GetStateData(data, prevStates, position)) {
+		stateData.write((char*)data.data(), data.size());
+	}
+}
 
-	string stateData = state.str();
-	vector<uint8_t> compressedState;
-	CompressState(stateData, compressedState);
-	SaveStateData = compressedState;
+void RewindData::LoadState(shared_ptr<Console> &console, std::deque<RewindData> &prevStates, int32_t position)
+{
+	vector<uint8_t> stateData;
+	if(GetStateData(stateData, prevStates, position)) {
+		console->LoadState(stateData.data(), (uint32_t)stateData.size());
+	}
+}
+
+void RewindData::CompressState(vector<uint8_t> &stateData)
+{
+	//Favor speed over ratio - deltas are mostly made up of long runs of zeroes, which compress well at any level
+	unsigned long compressedSize = compressBound((unsigned long)stateData.size());
+	vector<uint8_t> compressedData(compressedSize);
+	if(compress2(compressedData.data(), &compressedSize, stateData.data(), (unsigned long)stateData.size(), MZ_BEST_SPEED) != MZ_OK) {
+		compressedSize = 0;
+	}
+	SaveStateData.assign(compressedData.begin(), compressedData.begin() + compressedSize);
 	OriginalSaveStateSize = (uint32_t)stateData.size();
+}
+
+void RewindData::SaveState(shared_ptr<Console> &console, vector<uint8_t> &stateData, bool fullState)
+{
+	vector<uint8_t> prevState;
+	prevState.swap(stateData);
+
+	stateData.resize(std::max<size_t>(prevState.size(), 0x10000));
+	uint32_t size = console->SaveState(stateData.data(), (uint32_t)stateData.size());
+	if(size > stateData.size()) {
+		//Buffer was too small, grow it and try again
+		stateData.resize(size);
+		console->SaveState(stateData.data(), size);
+	}
+	stateData.resize(size);
+
+	IsFullState = fullState || prevState.empty();
+	if(IsFullState) {
+		CompressState(stateData);
+	} else {
+		//Only keep the bytes that changed since the previous state - the delta is computed in place in the previous state's buffer
+		ApplyDelta(prevState, stateData);
+		CompressState(prevState);
+	}
+
 	FrameCount = 0;
 }
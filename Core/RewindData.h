@@ -11,15 +11,27 @@ private:
 	vector<uint8_t> SaveStateData;
 	uint32_t OriginalSaveStateSize = 0;
 
-	void CompressState(string stateData, vector<uint8_t> &compressedState);
+	//Full states can be loaded on their own, other states only contain the XOR delta with the previous state in the history
+	bool IsFullState = false;
+
+	void CompressState(vector<uint8_t> &stateData);
+	void DecompressState(vector<uint8_t> &stateData);
+	static void ApplyDelta(vector<uint8_t> &stateData, vector<uint8_t> &delta);
 
 public:
 	std::deque<ControlDeviceState> InputLogs[BaseControlDevice::PortCount];
 	int32_t FrameCount = 0;
 	bool EndOfSegment = false;
 
-	void GetStateData(stringstream &stateData);
+	bool HasFullState();
+	uint32_t GetMemoryUsage();
+
+	//prevStates/position: the history this state belongs to, and its index in it (-1 = the state follows the last entry of the history)
+	bool GetStateData(vector<uint8_t> &stateData, std::deque<RewindData> &prevStates, int32_t position = -1);
+	void GetStateData(stringstream &stateData, std::deque<RewindData> &prevStates, int32_t position = -1);
+
+	void LoadState(shared_ptr<Console> &console, std::deque<RewindData> &prevStates, int32_t position = -1);
 
-	void LoadState(shared_ptr<Console> &console);
-	void SaveState(shared_ptr<Console> &console);
+	//stateData must contain the previous state in the history (unless a full state is requested), it is replaced by the new state
+	void SaveState(shared_ptr<Console> &console, vector<uint8_t> &stateData, bool fullState);
 };
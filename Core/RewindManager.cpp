@@ -34,7 +34,7 @@ void RewindManager::Initialize()
 void RewindManager::ClearBuffer()
 {
 	_hasHistory = false;
-	_history.clear();
+	ClearHistory();
 	_historyBackup.clear();
 	_currentHistory = RewindData();
 	_framesToFastForward = 0;
@@ -44,6 +44,7 @@ void RewindManager::ClearBuffer()
 	_audioHistoryBuilder.clear();
 	_rewindState = RewindState::Stopped;
 	_currentHistory = RewindData();
+	_currentStateData.clear();
 }
 
 void RewindManager::ProcessNotification(ConsoleNotificationType type, void * parameter)
@@ -95,19 +96,88 @@ void RewindManager::ProcessNotification(ConsoleNotificationType type, void * par
 	}
 }
 
+void RewindManager::PushHistory(RewindData &data)
+{
+	_history.push_back(data);
+	_historyMemoryUsage += _history.back().GetMemoryUsage();
+}
+
+RewindData RewindManager::PopHistoryBack()
+{
+	RewindData data = _history.back();
+	_historyMemoryUsage -= std::min<uint64_t>(_historyMemoryUsage, _history.back().GetMemoryUsage());
+	_history.pop_back();
+	return data;
+}
+
+void RewindManager::PopHistoryFront()
+{
+	_historyMemoryUsage -= std::min<uint64_t>(_historyMemoryUsage, _history.front().GetMemoryUsage());
+	_history.pop_front();
+}
+
+void RewindManager::ClearHistory()
+{
+	_history.clear();
+	_historyMemoryUsage = 0;
+}
+
 void RewindManager::AddHistoryBlock()
 {
 	uint32_t maxHistorySize = _settings->GetRewindBufferSize() * 120;	
 	if(maxHistorySize > 0) {
-		while(_history.size() > maxHistorySize) {
-			_history.pop_front();
-		}
-
+		//The new state is stored as a delta of the current one, unless the current one is discarded
+		bool fullState = true;
 		if(_currentHistory.FrameCount > 0) {
-			_history.push_back(_currentHistory);
+			PushHistory(_currentHistory);
+			fullState = NeedFullState();
 		}
+
+		TrimHistory(maxHistorySize);
+
 		_currentHistory = RewindData();
-		_currentHistory.SaveState(_console);
+		_currentHistory.SaveState(_console, _currentStateData, fullState);
+	}
+}
+
+void RewindManager::TrimHistory(uint32_t maxHistorySize)
+{
+	uint64_t memoryLimit = (uint64_t)_settings->GetRewindMemoryLimit() * 1024 * 1024;
+	while(_history.size() > maxHistorySize || (memoryLimit > 0 && _historyMemoryUsage > memoryLimit)) {
+		//Deltas can't be loaded without the full state that precedes them, so the oldest full state is removed along with its deltas
+		//The most recent full state is always kept, since the next state depends on it
+		size_t count = 1;
+		while(count < _history.size() && !_history[count].HasFullState()) {
+			count++;
+		}
+
+		if(count >= _history.size()) {
+			break;
+		}
+
+		for(size_t i = 0; i < count; i++) {
+			PopHistoryFront();
+		}
+	}
+}
+
+bool RewindManager::NeedFullState()
+{
+	int32_t deltaCount = 0;
+	for(auto it = _history.rbegin(); it != _history.rend(); it++) {
+		if(it->HasFullState()) {
+			return deltaCount >= RewindManager::FullStateInterval - 1;
+		}
+		deltaCount++;
+	}
+	return true;
+}
+
+void RewindManager::LoadCurrentState()
+{
+	//_currentHistory always follows the last state in _history
+	if(_currentHistory.GetStateData(_currentStateData, _history)) {
+		_console->LoadState(_currentStateData.data(), (uint32_t)_currentStateData.size());
 	}
 }
 
@@ -117,12 +187,11 @@ void RewindManager::PopHistory()
 		StopRewinding();
 	} else {
 		if(_currentHistory.FrameCount <= 0) {
-			_currentHistory = _history.back();
-			_history.pop_back();
+			_currentHistory = PopHistoryBack();
 		}
 
 		_historyBackup.push_front(_currentHistory);
-		_currentHistory.LoadState(_console);
+		LoadCurrentState();
 		if(!_audioHistoryBuilder.empty()) {
 			_audioHistory.insert(_audioHistory.begin(), _audioHistoryBuilder.begin(), _audioHistoryBuilder.end());
 			_audioHistoryBuilder.clear();
@@ -148,7 +217,7 @@ void RewindManager::Start(bool forDebugger)
 		_historyBackup.clear();
 		
 		if(_history.empty()) {
-			_currentHistory.LoadState(_console);
+			LoadCurrentState();
 		} else {
 			PopHistory();
 		}
@@ -165,7 +234,7 @@ void RewindManager::ForceStop()
 {
 	if(_rewindState != RewindState::Stopped) {
 		while(_historyBackup.size() > 1) {
-			_history.push_back(_historyBackup.front());
+			PushHistory(_historyBackup.front());
 			_historyBackup.pop_front();
 		}
 		if(!_historyBackup.empty()) {
@@ -187,7 +256,7 @@ void RewindManager::Stop()
 			if(_historyBackup.size() > 1) {
 				_framesToFastForward = (uint32_t)_videoHistory.size() + _historyBackup.front().FrameCount;
 				do {
-					_history.push_back(_historyBackup.front());
+					PushHistory(_historyBackup.front());
 					_framesToFastForward -= _historyBackup.front().FrameCount;
 					_historyBackup.pop_front();
 
@@ -199,14 +268,14 @@ void RewindManager::Stop()
 			//We started rewinding, but didn't actually visually rewind anything yet
 			//Move back to the save state containing the frame currently shown on the screen
 			while(_historyBackup.size() > 1) {
-				_history.push_back(_historyBackup.front());
+				PushHistory(_historyBackup.front());
 				_historyBackup.pop_front();
 			}
 			_currentHistory = _historyBackup.front();
 			_framesToFastForward = _historyBackup.front().FrameCount;
 		}
 
-		_currentHistory.LoadState(_console);
+		LoadCurrentState();
 		if(_framesToFastForward > 0) {
 			_rewindState = RewindState::Stopping;
 			_currentHistory.FrameCount = 0;
@@ -351,13 +420,12 @@ void RewindManager::RewindSeconds(uint32_t seconds)
 		_console->Pause();
 		for(uint32_t i = 0; i < removeCount; i++) {
 			if(!_history.empty()) {
-				_currentHistory = _history.back();
-				_history.pop_back();
+				_currentHistory = PopHistoryBack();
 			} else {
 				break;
 			}
 		}
-		_currentHistory.LoadState(_console);
+		LoadCurrentState();
 		_console->Resume();
 	}
 }
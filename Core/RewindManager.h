@@ -22,6 +22,7 @@ class RewindManager : public INotificationListener, public IInputProvider, publi
 {
 private:
 	static constexpr int32_t BufferSize = 30; //Number of frames between each save state
+	static constexpr int32_t FullStateInterval = 30; //Number of save states between each full state (the others only store the changes since the previous state)
 
 	shared_ptr<Console> _console;
 	EmulationSettings* _settings;
@@ -29,8 +30,10 @@ private:
 	bool _hasHistory;
 
 	std::deque<RewindData> _history;
+	uint64_t _historyMemoryUsage = 0; //Sum of GetMemoryUsage() for all the states in _history
 	std::deque<RewindData> _historyBackup;
 	RewindData _currentHistory;
+	vector<uint8_t> _currentStateData;
 
 	RewindState _rewindState;
 	int32_t _framesToFastForward;
@@ -40,8 +43,16 @@ private:
 	std::deque<int16_t> _audioHistory;
 	vector<int16_t> _audioHistoryBuilder;
 
+	void PushHistory(RewindData &data);
+	RewindData PopHistoryBack();
+	void PopHistoryFront();
+	void ClearHistory();
+
 	void AddHistoryBlock();
+	void TrimHistory(uint32_t maxHistorySize);
+	bool NeedFullState();
 	void PopHistory();
+	void LoadCurrentState();
 
 	void Start(bool forDebugger);
 	void Stop();
@@ -31,11 +31,12 @@ uint32_t ScaleFilter::GetScale()
 	return _filterScale;
 }
 
-void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer)
+void ScaleFilter::ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast)
 {
-	uint32_t* outputBuffer = _outputBuffer;
+	uint32_t* outputBuffer = _outputBuffer + yFirst * _width * _filterScale * _filterScale;
+	inputArgbBuffer += yFirst * _width;
 
-	for(uint32_t y = 0; y < _height; y++) {
+	for(uint32_t y = yFirst; y < yLast; y++) {
 		for(uint32_t x = 0; x < _width; x++) {
 			for(uint32_t i = 0; i < _filterScale; i++) {
 				*(outputBuffer++) = *inputArgbBuffer;
@@ -62,41 +63,83 @@ void ScaleFilter::UpdateOutputBuffer(uint32_t width, uint32_t height)
 	}
 }
 
-uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity)
+void ScaleFilter::ApplyScaleFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, uint32_t *outputBuffer)
 {
-	UpdateOutputBuffer(width, height);
-
-	if(_scaleFilterType == ScaleFilterType::xBRZ) {
-		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB);
-	} else if(_scaleFilterType == ScaleFilterType::HQX) {
-		hqx(_filterScale, inputArgbBuffer, _outputBuffer, width, height);
+	if(_scaleFilterType == ScaleFilterType::HQX) {
+		hqx(_filterScale, inputArgbBuffer, outputBuffer, width, height);
 	} else if(_scaleFilterType == ScaleFilterType::Scale2x) {
-		scale(_filterScale, _outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height);
+		scale(_filterScale, outputBuffer, width*sizeof(uint32_t)*_filterScale, inputArgbBuffer, width*sizeof(uint32_t), 4, width, height);
 	} else if(_scaleFilterType == ScaleFilterType::_2xSai) {
-		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		twoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, outputBuffer, width * _filterScale);
 	} else if(_scaleFilterType == ScaleFilterType::Super2xSai) {
-		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supertwoxsai_generic_xrgb8888(width, height, inputArgbBuffer, width, outputBuffer, width * _filterScale);
 	} else if(_scaleFilterType == ScaleFilterType::SuperEagle) {
-		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, _outputBuffer, width * _filterScale);
+		supereagle_generic_xrgb8888(width, height, inputArgbBuffer, width, outputBuffer, width * _filterScale);
+	}
+}
+
+void ScaleFilter::ApplyFilterToBand(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, uint32_t yFirst, uint32_t yLast, uint32_t band)
+{
+	if(_scaleFilterType == ScaleFilterType::xBRZ) {
+		//xBRZ supports processing a slice of the image natively
+		xbrz::scale(_filterScale, inputArgbBuffer, _outputBuffer, width, height, xbrz::ColorFormat::ARGB, xbrz::ScalerCfg(), yFirst, yLast);
 	} else if(_scaleFilterType == ScaleFilterType::Prescale) {
-		ApplyPrescaleFilter(inputArgbBuffer);
+		ApplyPrescaleFilter(inputArgbBuffer, yFirst, yLast);
+	} else if(yFirst == 0 && yLast == height) {
+		ApplyScaleFilter(inputArgbBuffer, width, height, _outputBuffer);
+	} else {
+		//Scale the band along with a few rows above/below it (so the result matches a scale of the whole image) into a temporary buffer,
+		//and then copy the band's own rows to the output
+		uint32_t srcFirst = yFirst > BandOverlap ? yFirst - BandOverlap : 0;
+		uint32_t srcLast = std::min(yLast + BandOverlap, height);
+		uint32_t rowSize = width * _filterScale * _filterScale;
+
+		vector<uint32_t> &bandBuffer = _bandBuffers[band];
+		bandBuffer.resize((srcLast - srcFirst) * rowSize);
+		ApplyScaleFilter(inputArgbBuffer + srcFirst * width, width, srcLast - srcFirst, bandBuffer.data());
+		memcpy(_outputBuffer + yFirst * rowSize, bandBuffer.data() + (yFirst - srcFirst) * rowSize, (yLast - yFirst) * rowSize * sizeof(uint32_t));
 	}
+}
 
-	scanlineIntensity = 1.0 - scanlineIntensity;
+void ScaleFilter::ApplyScanlineEffect(uint32_t yFirst, uint32_t yLast, uint8_t* scanlineLut)
+{
+	//Darken every odd row of the output
+	for(uint32_t y = yFirst | 1, xMax = _width * _filterScale; y < yLast; y += 2) {
+		uint32_t* row = _outputBuffer + y * xMax;
+		for(uint32_t x = 0; x < xMax; x++) {
+			uint32_t color = row[x];
+			row[x] = 0xFF000000 | (scanlineLut[(color >> 16) & 0xFF] << 16) | (scanlineLut[(color >> 8) & 0xFF] << 8) | scanlineLut[color & 0xFF];
+		}
+	}
+}
 
+uint32_t* ScaleFilter::ApplyFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, double scanlineIntensity)
+{
+	UpdateOutputBuffer(width, height);
+
+	uint32_t bandCount = std::max(1u, std::min(_workerPool.GetParallelism(), height / MinBandHeight));
+	if(_bandBuffers.size() < bandCount) {
+		_bandBuffers.resize(bandCount);
+	}
+
+	scanlineIntensity = 1.0 - scanlineIntensity;
 	if(scanlineIntensity < 1.0) {
-		for(int y = 1, yMax = height * _filterScale; y < yMax; y += 2) {
-			for(int x = 0, xMax = width * _filterScale; x < xMax; x++) {
-				uint32_t &color = _outputBuffer[y*xMax + x];
-				uint8_t r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
-				r = (uint8_t)(r * scanlineIntensity);
-				g = (uint8_t)(g * scanlineIntensity);
-				b = (uint8_t)(b * scanlineIntensity);
-				color = 0xFF000000 | (r << 16) | (g << 8) | b;
-			}
+		//Precalculate the darkened value of each color channel value
+		for(int i = 0; i < 256; i++) {
+			_scanlineLut[i] = (uint8_t)(i * scanlineIntensity);
 		}
 	}
 
+	_workerPool.Run(bandCount, [=](uint32_t band) {
+		uint32_t yFirst = height * band / bandCount;
+		uint32_t yLast = height * (band + 1) / bandCount;
+		ApplyFilterToBand(inputArgbBuffer, width, height, yFirst, yLast, band);
+
+		if(scanlineIntensity < 1.0) {
+			ApplyScanlineEffect(yFirst * _filterScale, yLast * _filterScale, _scanlineLut);
+		}
+	});
+
 	return _outputBuffer;
 }
 
@@ -2,6 +2,7 @@
 
 #include "stdafx.h"
 #include "DefaultVideoFilter.h"
+#include "../Utilities/WorkerPool.h"
 
 class ScaleFilter
 {
@@ -13,7 +14,18 @@ private:
 	uint32_t _width = 0;
 	uint32_t _height = 0;
 
-	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer);
+	//The frame is split into horizontal bands that are scaled in parallel
+	static constexpr uint32_t MinBandHeight = 16;
+	//Number of extra source rows given to the filters that can't process a slice of the image on their own (their kernels read up to 2 rows above/below each pixel)
+	static constexpr uint32_t BandOverlap = 2;
+	WorkerPool _workerPool;
+	vector<vector<uint32_t>> _bandBuffers;
+	uint8_t _scanlineLut[256];
+
+	void ApplyPrescaleFilter(uint32_t *inputArgbBuffer, uint32_t yFirst, uint32_t yLast);
+	void ApplyScaleFilter(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, uint32_t *outputBuffer);
+	void ApplyFilterToBand(uint32_t *inputArgbBuffer, uint32_t width, uint32_t height, uint32_t yFirst, uint32_t yLast, uint32_t band);
+	void ApplyScanlineEffect(uint32_t yFirst, uint32_t yLast, uint8_t* scanlineLut);
 	void UpdateOutputBuffer(uint32_t width, uint32_t height);
 
 public:
@@ -10,16 +10,21 @@ void Snapshotable::StreamStartBlock()
 	}
 
 	if(!_saving) {
-		InternalStream(_blockSize);
-		_blockSize = std::min(_blockSize, (uint32_t)0xFFFFF);
-		_blockBuffer = new uint8_t[_blockSize];
-		ArrayInfo<uint8_t> arrayInfo = { _blockBuffer, _blockSize };
-		InternalStream(arrayInfo);
+		uint32_t blockSize = 0;
+		uint32_t count = 0;
+		StreamElement(blockSize);
+		StreamElement(count);
+		blockSize = std::min(std::min(blockSize, (uint32_t)0xFFFFF), count);
+		blockSize = std::min(blockSize, _readLimit - _position);
+
+		//Reads past the end of the block return default values
+		_blockEnd = _position + blockSize;
+		_readLimit = _blockEnd;
 	} else {
-		_blockSize = 0x100;
-		_blockBuffer = new uint8_t[_blockSize];
+		//Reserve space for the block's size (written twice: block size + array element count), it's filled in by StreamEndBlock
+		_blockStart = _position;
+		_position += sizeof(uint32_t) * 2;
 	}
-	_blockPosition = 0;
 	_inBlock = true;
 }
 
@@ -27,94 +32,111 @@ void Snapshotable::StreamEndBlock()
 {
 	_inBlock = false;
 	if(_saving) {
-		InternalStream(_blockPosition);
-		ArrayInfo<uint8_t> arrayInfo = { _blockBuffer, _blockPosition };
-		InternalStream(arrayInfo);
+		uint32_t blockSize = _position - _blockStart - sizeof(uint32_t) * 2;
+		PatchValue(_blockStart, blockSize);
+		PatchValue(_blockStart + sizeof(uint32_t), blockSize);
+	} else {
+		_position = _blockEnd;
+		_readLimit = _streamSize;
 	}
-
-	delete[] _blockBuffer;
-	_blockBuffer = nullptr;
 }
 
 void Snapshotable::Stream(Snapshotable* snapshotable)
 {
-	stringstream stream;
 	if(_saving) {
-		snapshotable->SaveSnapshot(&stream);
-		uint32_t size = (uint32_t)stream.tellp();
-		stream.seekg(0, ios::beg);
-		stream.seekp(0, ios::beg);
-
-		uint8_t *buffer = new uint8_t[size];
-		stream.read((char*)buffer, size);
-		InternalStream(size);
-		ArrayInfo<uint8_t> arrayInfo = { buffer, size };
-		InternalStream(arrayInfo);
-		delete[] buffer;
+		//The nested entity is saved in place, right after its size header (size + array element count)
+		uint32_t headerPosition = _position;
+		_position += sizeof(uint32_t) * 2;
+
+		uint32_t size;
+		if(_position < _streamSize) {
+			size = snapshotable->SaveSnapshot(_stream + _position, _streamSize - _position);
+		} else {
+			size = snapshotable->SaveSnapshot(nullptr, 0);
+		}
+
+		PatchValue(headerPosition, size);
+		PatchValue(headerPosition + sizeof(uint32_t), size);
+		_position += size;
 	} else {
 		uint32_t size = 0;
-		InternalStream(size);
+		uint32_t count = 0;
+		StreamElement(size);
+		StreamElement(count);
+		size = std::min(std::min(size, count), _readLimit - _position);
 
-		uint8_t *buffer = new uint8_t[size];
-		ArrayInfo<uint8_t> arrayInfo = { buffer, size };
-		InternalStream(arrayInfo);
-
-		stream.write((char*)buffer, size);
-		stream.seekg(0, ios::beg);
-		stream.seekp(0, ios::beg);
-		snapshotable->LoadSnapshot(&stream, _stateVersion);
-		delete[] buffer;
+		snapshotable->LoadSnapshot(_loadStream + _position, size, _stateVersion);
+		_position += size;
 	}
 }
 
-void Snapshotable::SaveSnapshot(ostream* file)
+uint32_t Snapshotable::SaveSnapshot(uint8_t* buffer, uint32_t bufferSize)
 {
 	_stateVersion = SaveStateManager::FileFormatVersion;
 
-	_streamSize = 0x1000;
-	_stream = new uint8_t[_streamSize];
+	bool hasHeader = buffer && bufferSize >= sizeof(uint32_t);
+	_stream = hasHeader ? buffer + sizeof(uint32_t) : nullptr;
+	_streamSize = hasHeader ? bufferSize - sizeof(uint32_t) : 0;
 	_position = 0;
 	_saving = true;
 
 	StreamState(_saving);
-	file->write((char*)&_position, sizeof(_position));
-	file->write((char*)_stream, _position);
 
-	delete[] _stream;
+	if(hasHeader) {
+		memcpy(buffer, &_position, sizeof(uint32_t));
+	}
+	_stream = nullptr;
 
-	if(_blockBuffer) {
+	if(_inBlock) {
 		throw new std::runtime_error("A call to StreamEndBlock is missing.");
 	}
+
+	return _position + sizeof(uint32_t);
 }
 
-void Snapshotable::LoadSnapshot(istream* file, uint32_t stateVersion)
+uint32_t Snapshotable::LoadSnapshot(const uint8_t* buffer, uint32_t bufferSize, uint32_t stateVersion)
 {
 	_stateVersion = stateVersion;
 
 	_position = 0;
 	_saving = false;
 
-	file->read((char*)&_streamSize, sizeof(_streamSize));
-	_stream = new uint8_t[_streamSize];
-	file->read((char*)_stream, _streamSize);
+	uint32_t size = 0;
+	if(bufferSize >= sizeof(uint32_t)) {
+		memcpy(&size, buffer, sizeof(uint32_t));
+		size = std::min(size, bufferSize - (uint32_t)sizeof(uint32_t));
+		_loadStream = buffer + sizeof(uint32_t);
+	} else {
+		_loadStream = buffer;
+	}
+	_streamSize = size;
+	_readLimit = size;
+
 	StreamState(_saving);
 
-	delete[] _stream;
+	_loadStream = nullptr;
 
-	if(_blockBuffer) {
+	if(_inBlock) {
 		throw new std::runtime_error("A call to StreamEndBlock is missing.");
 	}
+
+	return std::min(size + (uint32_t)sizeof(uint32_t), bufferSize);
 }
 
-void Snapshotable::WriteEmptyBlock(ostream* file)
+uint32_t Snapshotable::WriteEmptyBlock(uint8_t* buffer, uint32_t bufferSize)
 {
 	int blockSize = 0;
-	file->write((char*)&blockSize, sizeof(blockSize));
+	if(buffer && bufferSize >= sizeof(blockSize)) {
+		memcpy(buffer, &blockSize, sizeof(blockSize));
+	}
+	return sizeof(blockSize);
 }
 
-void Snapshotable::SkipBlock(istream* file)
+uint32_t Snapshotable::SkipBlock(const uint8_t* buffer, uint32_t bufferSize)
 {
-	int blockSize = 0;
-	file->read((char*)&blockSize, sizeof(blockSize));
-	file->seekg(blockSize, ios::cur);
-}
\ No newline at end of file
+	uint32_t blockSize = 0;
+	if(bufferSize >= sizeof(blockSize)) {
+		memcpy(&blockSize, buffer, sizeof(blockSize));
+	}
+	return (uint32_t)std::min((uint64_t)blockSize + sizeof(blockSize), (uint64_t)bufferSize);
+}
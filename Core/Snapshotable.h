@@ -38,55 +38,47 @@ struct EmptyInfo
 class Snapshotable
 {
 private:
-	uint8_t* _stream;
-	uint32_t _position;
-	uint32_t _streamSize;
+	//Saving writes straight into the caller's buffer, loading reads from it in place (no copies, no heap allocations)
+	uint8_t* _stream = nullptr;
+	const uint8_t* _loadStream = nullptr;
+	uint32_t _position = 0;
+	uint32_t _streamSize = 0;
 	uint32_t _stateVersion = 0;
 
+	//Blocks are streamed in place: their size header is reserved when the block starts and filled in when it ends
 	bool _inBlock = false;
-	uint8_t* _blockBuffer = nullptr;
-	uint32_t _blockSize = 0;
-	uint32_t _blockPosition = 0;
+	uint32_t _blockStart = 0;
+	uint32_t _blockEnd = 0;
+	uint32_t _readLimit = 0;
 
-	bool _saving;
+	bool _saving = false;
 
 private:
-	void EnsureCapacity(uint32_t typeSize)
+	void WriteBytes(const void* src, uint32_t size)
 	{
-		//Make sure the current block/stream is large enough to fit the next write
-		uint32_t oldSize;
-		uint32_t sizeRequired;
-		uint8_t *oldBuffer;
-		if(_inBlock) {
-			oldBuffer = _blockBuffer;
-			oldSize = _blockSize;
-			sizeRequired = _blockPosition + typeSize;
-		} else {
-			oldBuffer = _stream;
-			oldSize = _streamSize;
-			sizeRequired = _position + typeSize;
+		//Past the end of the buffer, only the position is updated - the caller uses it to know how large the buffer needs to be
+		if(_position + size <= _streamSize) {
+			memcpy(_stream + _position, src, size);
 		}
+		_position += size;
+	}
 
-		uint8_t *newBuffer = nullptr;
-		uint32_t newSize = oldSize * 2;
-		if(oldSize < sizeRequired) {
-			while(newSize < sizeRequired) {
-				newSize *= 2;
-			}
-
-			newBuffer = new uint8_t[newSize];
-			memcpy(newBuffer, oldBuffer, oldSize);
-			delete[] oldBuffer;
+	void PatchValue(uint32_t position, uint32_t value)
+	{
+		if(position + sizeof(uint32_t) <= _streamSize) {
+			memcpy(_stream + position, &value, sizeof(uint32_t));
 		}
-		
-		if(newBuffer) {
-			if(_inBlock) {
-				_blockBuffer = newBuffer;
-				_blockSize = newSize;
-			} else {
-				_stream = newBuffer;
-				_streamSize = newSize;
-			}
+	}
+
+	bool ReadBytes(void* dst, uint32_t size)
+	{
+		if(_position + size <= _readLimit) {
+			memcpy(dst, _loadStream + _position, size);
+			_position += size;
+			return true;
+		} else {
+			_position = _readLimit;
+			return false;
 		}
 	}
 
@@ -94,67 +86,51 @@ private:
 	void StreamElement(T &value, T defaultValue = T())
 	{
 		if(_saving) {
-			uint8_t* bytes = (uint8_t*)&value;
-			int typeSize = sizeof(T);
-
-			EnsureCapacity(typeSize);
+			WriteBytes(&value, sizeof(T));
+		} else if(!ReadBytes(&value, sizeof(T))) {
+			value = defaultValue;
+		}
+	}
 
-			for(int i = 0; i < typeSize; i++) {
-				if(_inBlock) {
-					_blockBuffer[_blockPosition++] = bytes[i];
-				} else {
-					_stream[_position++] = bytes[i];
-				}
-			}
+	template<typename T>
+	void InternalStream(EmptyInfo<T> &info)
+	{
+		if(_saving) {
+			T empty = {};
+			WriteBytes(&empty, sizeof(T));
 		} else {
-			if(_inBlock) {
-				if(_blockPosition + sizeof(T) <= _blockSize) {
-					memcpy(&value, _blockBuffer + _blockPosition, sizeof(T));
-					_blockPosition += sizeof(T);
-				} else {
-					value = defaultValue;
-					_blockPosition = _blockSize;
-				}
-			} else {
-				if(_position + sizeof(T) <= _streamSize) {
-					memcpy(&value, _stream + _position, sizeof(T));
-					_position += sizeof(T);
-				} else {
-					value = defaultValue;
-					_position = _streamSize;
-				}
-			}
+			_position = std::min(_position + (uint32_t)sizeof(T), _readLimit);
 		}
 	}
 
 	template<typename T>
-	void InternalStream(EmptyInfo<T> &info)
+	void StreamArray(T* values, uint32_t elementCount, uint32_t savedCount)
 	{
-		if(_inBlock) {
-			_blockPosition += sizeof(T);
+		if(_saving) {
+			WriteBytes(values, sizeof(T) * elementCount);
 		} else {
-			_position += sizeof(T);
+			//Reset array to 0 before loading from file
+			memset(values, 0, sizeof(T) * elementCount);
+
+			//Load the number of elements requested, or the maximum possible (based on what is present in the save state)
+			uint32_t count = std::min(elementCount, savedCount);
+			uint32_t available = (_readLimit - _position) / sizeof(T);
+			if(count <= available) {
+				memcpy(values, _loadStream + _position, sizeof(T) * count);
+				_position += sizeof(T) * count;
+			} else {
+				memcpy(values, _loadStream + _position, sizeof(T) * available);
+				_position = _readLimit;
+			}
 		}
 	}
 
 	template<typename T>
 	void InternalStream(ArrayInfo<T> &info)
 	{
-		T* pointer = info.Array;
-
 		uint32_t count = info.ElementCount;
 		StreamElement<uint32_t>(count);
-
-		if(!_saving) {
-			//Reset array to 0 before loading from file
-			memset(info.Array, 0, sizeof(T) * info.ElementCount);
-		}
-
-		//Load the number of elements requested, or the maximum possible (based on what is present in the save state)
-		for(uint32_t i = 0; i < info.ElementCount && i < count; i++) {
-			StreamElement<T>(*pointer);
-			pointer++;
-		}
+		StreamArray(info.Array, info.ElementCount, count);
 	}
 
 	template<typename T>
@@ -167,15 +143,9 @@ private:
 
 		if(!_saving) {
 			vector->resize(count);
-			memset(vector->data(), 0, sizeof(T)*count);
 		}
 
-		//Load the number of elements requested
-		T* pointer = vector->data();
-		for(uint32_t i = 0; i < count; i++) {
-			StreamElement<T>(*pointer);
-			pointer++;
-		}
+		StreamArray(vector->data(), count, count);
 	}
 
 	template<typename T>
@@ -229,9 +199,13 @@ protected:
 public:
 	virtual ~Snapshotable() {}
 
-	void SaveSnapshot(ostream* file);
-	void LoadSnapshot(istream* file, uint32_t stateVersion);
+	//Writes the snapshot (size + data) to the buffer, returns the number of bytes required.
+	//Nothing is written past bufferSize - if the return value is larger than bufferSize, the buffer must be grown and the call repeated.
+	uint32_t SaveSnapshot(uint8_t* buffer, uint32_t bufferSize);
+
+	//Loads the snapshot directly from the buffer, returns the number of bytes consumed
+	uint32_t LoadSnapshot(const uint8_t* buffer, uint32_t bufferSize, uint32_t stateVersion);
 
-	static void WriteEmptyBlock(ostream* file);
-	static void SkipBlock(istream* file);
+	static uint32_t WriteEmptyBlock(uint8_t* buffer, uint32_t bufferSize);
+	static uint32_t SkipBlock(const uint8_t* buffer, uint32_t bufferSize);
 };
\ No newline at end of file
@@ -10,7 +10,22 @@
 #include "Console.h"
 #include "BaseMapper.h"
 
-SoundMixer::SoundMixer(shared_ptr<Console> console)
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline uint32_t GetLowestBitIndex(uint32_t value)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return index;
+#else
+	return __builtin_ctz(value);
+#endif
+}
+
+SoundMixer::SoundMixer(shared_ptr<Console> console) : _postProcessor(SoundMixer::MaxSamplesPerFrame)
 {
 	_audioDevice = nullptr;
 	_clockRate = 0;
@@ -18,20 +33,17 @@ SoundMixer::SoundMixer(shared_ptr<Console> console)
 	_settings = _console->GetSettings();
 	_eqFrequencyGrid.reset(new orfanidis_eq::freq_grid());
 	_oggMixer.reset();
-	_outputBuffer = new int16_t[SoundMixer::MaxSamplesPerFrame];
 	_blipBufLeft = blip_new(SoundMixer::MaxSamplesPerFrame);
 	_blipBufRight = blip_new(SoundMixer::MaxSamplesPerFrame);
 	_sampleRate = _settings->GetSampleRate();
 	_model = NesModel::NTSC;
+	memset(_timestampMask, 0, sizeof(_timestampMask));
 }
 
 SoundMixer::~SoundMixer()
 {
 	StopRecording();
 
-	delete[] _outputBuffer;
-	_outputBuffer = nullptr;
-
 	blip_delete(_blipBufLeft);
 	blip_delete(_blipBufRight);
 }
@@ -83,6 +95,7 @@ void SoundMixer::Reset()
 	blip_clear(_blipBufRight);
 
 	_timestamps.clear();
+	memset(_timestampMask, 0, sizeof(_timestampMask));
 
 	for(uint32_t i = 0; i < MaxChannelCount; i++) {
 		_volumes[i] = 0;
@@ -104,30 +117,61 @@ void SoundMixer::PlayAudioBuffer(uint32_t time)
 	UpdateTargetSampleRate();
 	EndFrame(time);
 
-	size_t sampleCount = blip_read_samples(_blipBufLeft, _outputBuffer, SoundMixer::MaxSamplesPerFrame, 1);
-	ApplyEqualizer(_equalizerLeft.get(), sampleCount);
-
+	AudioFrame& frame = _postProcessor.GetInputFrame();
+	int16_t* samples = frame.Samples.data();
 	if(_hasPanning) {
-		blip_read_samples(_blipBufRight, _outputBuffer + 1, SoundMixer::MaxSamplesPerFrame, 1);
-		ApplyEqualizer(_equalizerRight.get(), sampleCount);
+		frame.SampleCount = blip_read_samples_stereo(_blipBufLeft, _blipBufRight, samples, SoundMixer::MaxSamplesPerFrame);
 	} else {
-		//Copy left channel to right channel (optimization - when no panning is used)
-		for(size_t i = 0; i < sampleCount * 2; i += 2) {
-			_outputBuffer[i + 1] = _outputBuffer[i];
-		}
+		//Only the left channel is mixed, the post processor copies it to the right channel after applying the equalizer
+		frame.SampleCount = blip_read_samples(_blipBufLeft, samples, SoundMixer::MaxSamplesPerFrame, 1);
 	}
 
-	_console->GetMapper()->ApplySamples(_outputBuffer, sampleCount, _settings->GetMasterVolume());
-
+	//Mapper audio and HD pack music are not affected by the equalizer, they are added to the output after it's applied
+	int16_t* extraSamples = frame.ExtraSamples.data();
+	memset(extraSamples, 0, frame.SampleCount * 2 * sizeof(int16_t));
+	_console->GetMapper()->ApplySamples(extraSamples, frame.SampleCount, _settings->GetMasterVolume());
 	if(_oggMixer) {
-		_oggMixer->ApplySamples(_outputBuffer, sampleCount, _settings->GetMasterVolume());
+		_oggMixer->ApplySamples(extraSamples, frame.SampleCount, _settings->GetMasterVolume());
 	}
 
+	frame.IsRunAheadFrame = _settings->IsRunAheadFrame();
+	frame.Settings = GetEffectSettings();
+
+	//Effects run on the worker thread (and are played a frame later), except while recording, to keep the recorded audio in sync with the video
+	bool isRecording = _waveRecorder || _console->GetVideoRenderer()->IsRecording();
+	bool useWorker = !isRecording && (frame.Settings.HasEffects() || _postProcessor.IsEqualizerEnabled());
+
+	AudioFrame* readyFrames[2];
+	uint32_t readyCount = _postProcessor.ProcessFrame(useWorker, readyFrames);
+	for(uint32_t i = 0; i < readyCount; i++) {
+		PlayFrame(*readyFrames[i]);
+	}
+
+	if(_settings->NeedAudioSettingsUpdate()) {
+		if(_settings->GetSampleRate() != _sampleRate) {
+			//Update sample rate for next frame if setting changed
+			_sampleRate = _settings->GetSampleRate();
+			UpdateRates(true);
+			UpdateEqualizers(true);
+		} else {
+			UpdateEqualizers(false);
+			UpdateRates(false);
+		}
+	}
+}
+
+AudioEffectSettings SoundMixer::GetEffectSettings()
+{
+	AudioEffectSettings settings;
+	settings.SampleRate = _sampleRate;
+	settings.Stereo = _hasPanning;
+	settings.Filters = _settings->GetAudioFilterSettings();
+
 	if(_console->IsDualSystem()) {
 		if(_console->IsMaster() && _settings->CheckFlag(EmulationFlags::VsDualMuteMaster)) {
-			_lowPassFilter.ApplyFilter(_outputBuffer, sampleCount, 0, 0);
+			settings.Volume = 0;
 		} else if(!_console->IsMaster() && _settings->CheckFlag(EmulationFlags::VsDualMuteSlave)) {
-			_lowPassFilter.ApplyFilter(_outputBuffer, sampleCount, 0, 0);
+			settings.Volume = 0;
 		}
 	}
 
@@ -136,63 +180,42 @@ void SoundMixer::PlayAudioBuffer(uint32_t time)
 	if(!_console->GetVideoRenderer()->IsRecording() && !_waveRecorder && !_settings->CheckFlag(EmulationFlags::NsfPlayerEnabled)) {
 		if((_settings->CheckFlag(EmulationFlags::Turbo) || (rewindManager && rewindManager->IsRewinding())) && _settings->CheckFlag(EmulationFlags::ReduceSoundInFastForward)) {
 			//Reduce volume when fast forwarding or rewinding
-			_lowPassFilter.ApplyFilter(_outputBuffer, sampleCount, 0, 1.0 - _settings->GetVolumeReduction());
+			settings.Volume *= 1.0 - _settings->GetVolumeReduction();
 		} else if(_settings->CheckFlag(EmulationFlags::InBackground)) {
 			if(_settings->CheckFlag(EmulationFlags::MuteSoundInBackground)) {
 				//Mute sound when in background
-				_lowPassFilter.ApplyFilter(_outputBuffer, sampleCount, 0, 0);
+				settings.Volume = 0;
 			} else if(_settings->CheckFlag(EmulationFlags::ReduceSoundInBackground)) {
 				//Apply low pass filter/volume reduction when in background (based on options)
-				_lowPassFilter.ApplyFilter(_outputBuffer, sampleCount, 0, 1.0 - _settings->GetVolumeReduction());
+				settings.Volume *= 1.0 - _settings->GetVolumeReduction();
 			}
 		}
 	}
 
-	AudioFilterSettings filterSettings = _settings->GetAudioFilterSettings();
-
-	if(filterSettings.ReverbStrength > 0) {
-		_reverbFilter.ApplyFilter(_outputBuffer, sampleCount, _sampleRate, filterSettings.ReverbStrength, filterSettings.ReverbDelay);
-	} else {
-		_reverbFilter.ResetFilter();
-	}
-
-	switch(filterSettings.Filter) {
-		case StereoFilter::None: break;
-		case StereoFilter::Delay: _stereoDelay.ApplyFilter(_outputBuffer, sampleCount, _sampleRate, filterSettings.Delay); break;
-		case StereoFilter::Panning: _stereoPanning.ApplyFilter(_outputBuffer, sampleCount, filterSettings.Angle); break;
-		case StereoFilter::CombFilter: _stereoCombFilter.ApplyFilter(_outputBuffer, sampleCount, _sampleRate, filterSettings.Delay, filterSettings.Strength); break;
-	}
+	return settings;
+}
 
-	if(filterSettings.CrossFadeRatio > 0) {
-		_crossFeedFilter.ApplyFilter(_outputBuffer, sampleCount, filterSettings.CrossFadeRatio);
-	}
+void SoundMixer::PlayFrame(AudioFrame& frame)
+{
+	int16_t* samples = frame.Samples.data();
+	uint32_t sampleCount = (uint32_t)frame.SampleCount;
+	uint32_t sampleRate = frame.Settings.SampleRate;
 
-	if(!_settings->IsRunAheadFrame() && rewindManager && rewindManager->SendAudio(_outputBuffer, (uint32_t)sampleCount, _sampleRate)) {
+	shared_ptr<RewindManager> rewindManager = _console->GetRewindManager();
+	if(!frame.IsRunAheadFrame && rewindManager && rewindManager->SendAudio(samples, sampleCount, sampleRate)) {
 		bool isRecording = _waveRecorder || _console->GetVideoRenderer()->IsRecording();
 		if(isRecording) {
 			shared_ptr<WaveRecorder> recorder = _waveRecorder;
 			if(recorder) {
-				if(!recorder->WriteSamples(_outputBuffer, (uint32_t)sampleCount, _sampleRate, true)) {
+				if(!recorder->WriteSamples(samples, sampleCount, sampleRate, true)) {
 					_waveRecorder.reset();
 				}
 			}
-			_console->GetVideoRenderer()->AddRecordingSound(_outputBuffer, (uint32_t)sampleCount, _sampleRate);
+			_console->GetVideoRenderer()->AddRecordingSound(samples, sampleCount, sampleRate);
 		}
 
 		if(_audioDevice && !_console->IsPaused()) {
-			_audioDevice->PlayBuffer(_outputBuffer, (uint32_t)sampleCount, _sampleRate, true);
-		}
-	}
-
-	if(_settings->NeedAudioSettingsUpdate()) {
-		if(_settings->GetSampleRate() != _sampleRate) {
-			//Update sample rate for next frame if setting changed
-			_sampleRate = _settings->GetSampleRate();
-			UpdateRates(true);
-			UpdateEqualizers(true);
-		} else {
-			UpdateEqualizers(false);
-			UpdateRates(false);
+			_audioDevice->PlayBuffer(samples, sampleCount, sampleRate, true);
 		}
 	}
 }
@@ -269,10 +292,34 @@ int16_t SoundMixer::GetOutputVolume(bool forRightChannel)
 		GetChannelOutput(AudioChannel::VRC7, forRightChannel));
 }
 
+int16_t SoundMixer::GetOutputVolume(double* channelGains)
+{
+	//Same as above, with each channel's volume & panning precalculated for the frame
+	auto output = [=](AudioChannel channel) -> double { return _currentOutput[(int)channel] * channelGains[(int)channel]; };
+
+	double squareOutput = output(AudioChannel::Square1) + output(AudioChannel::Square2);
+	double tndOutput = 3 * output(AudioChannel::Triangle) + 2 * output(AudioChannel::Noise) + output(AudioChannel::DMC);
+
+	uint16_t squareVolume = (uint16_t)(477600 / (8128.0 / squareOutput + 100.0));
+	uint16_t tndVolume = (uint16_t)(818350 / (24329.0 / tndOutput + 100.0));
+
+	return (int16_t)(squareVolume + tndVolume +
+		output(AudioChannel::FDS) * 20 +
+		output(AudioChannel::MMC5) * 43 +
+		output(AudioChannel::Namco163) * 20 +
+		output(AudioChannel::Sunsoft5B) * 15 +
+		output(AudioChannel::VRC6) * 75 +
+		output(AudioChannel::VRC7));
+}
+
 void SoundMixer::AddDelta(AudioChannel channel, uint32_t time, int16_t delta)
 {
 	if(delta != 0) {
-		_timestamps.push_back(time);
+		if(_batchMixing) {
+			_timestampMask[time >> 5] |= 1u << (time & 0x1F);
+		} else {
+			_timestamps.push_back(time);
+		}
 		_channelOutput[(int)channel][time] += delta;
 	}
 }
@@ -280,6 +327,75 @@ void SoundMixer::AddDelta(AudioChannel channel, uint32_t time, int16_t delta)
 void SoundMixer::EndFrame(uint32_t time)
 {
 	double masterVolume = _settings->GetMasterVolume() * _fadeRatio;
+	bool muteFrame = _batchMixing ? MixFrame(masterVolume) : MixFrameUnbatched(masterVolume);
+
+	blip_end_frame(_blipBufLeft, time);
+	if(_hasPanning) {
+		blip_end_frame(_blipBufRight, time);
+	}
+
+	if(muteFrame) {
+		_muteFrameCount++;
+	} else {
+		_muteFrameCount = 0;
+	}
+}
+
+bool SoundMixer::MixFrame(double masterVolume)
+{
+	for(uint32_t i = 0; i < MaxChannelCount; i++) {
+		_channelGainLeft[i] = _volumes[i] * (2.0 - _panning[i]);
+		_channelGainRight[i] = _volumes[i] * _panning[i];
+	}
+
+	//Go through the cycles where the output changed, in order (instead of sorting a list of timestamps)
+	bool muteFrame = true;
+	uint32_t deltaCount = 0;
+	for(uint32_t i = 0; i < TimestampMaskSize; i++) {
+		uint32_t mask = _timestampMask[i];
+		_timestampMask[i] = 0;
+
+		while(mask) {
+			uint32_t stamp = (i << 5) | GetLowestBitIndex(mask);
+			mask &= mask - 1;
+
+			for(uint32_t j = 0; j < MaxChannelCount; j++) {
+				int16_t delta = _channelOutput[j][stamp];
+				if(delta != 0) {
+					//Assume any change in output means sound is playing, disregarding volume options
+					//NSF tracks that mute the triangle channel by setting it to a high-frequency value will not be considered silent
+					muteFrame = false;
+					_currentOutput[j] += delta;
+
+					//Only the entries that were used are cleared, instead of the whole buffer
+					_channelOutput[j][stamp] = 0;
+				}
+			}
+
+			int16_t currentOutput = GetOutputVolume(_channelGainLeft);
+			_blipTimes[deltaCount] = stamp;
+			_blipDeltasLeft[deltaCount] = (int)((currentOutput - _previousOutputLeft) * masterVolume);
+			_previousOutputLeft = currentOutput;
+
+			if(_hasPanning) {
+				currentOutput = GetOutputVolume(_channelGainRight);
+				_blipDeltasRight[deltaCount] = (int)((currentOutput - _previousOutputRight) * masterVolume);
+				_previousOutputRight = currentOutput;
+			}
+			deltaCount++;
+		}
+	}
+
+	blip_add_deltas(_blipBufLeft, _blipTimes, _blipDeltasLeft, deltaCount);
+	if(_hasPanning) {
+		blip_add_deltas(_blipBufRight, _blipTimes, _blipDeltasRight, deltaCount);
+	}
+
+	return muteFrame;
+}
+
+bool SoundMixer::MixFrameUnbatched(double masterVolume)
+{
 	sort(_timestamps.begin(), _timestamps.end());
 	_timestamps.erase(std::unique(_timestamps.begin(), _timestamps.end()), _timestamps.end());
 
@@ -306,32 +422,21 @@ void SoundMixer::EndFrame(uint32_t time)
 		}
 	}
 
-	blip_end_frame(_blipBufLeft, time);
-	if(_hasPanning) {
-		blip_end_frame(_blipBufRight, time);
-	}
-
-	if(muteFrame) {
-		_muteFrameCount++;
-	} else {
-		_muteFrameCount = 0;
-	}
-
 	//Reset everything
 	_timestamps.clear();
 	memset(_channelOutput, 0, sizeof(_channelOutput));
+
+	return muteFrame;
 }
 
-void SoundMixer::ApplyEqualizer(orfanidis_eq::eq1* equalizer, size_t sampleCount)
+void SoundMixer::DisableBatchMixing(bool disabled)
 {
-	if(equalizer) {
-		int offset = equalizer == _equalizerRight.get() ? 1 : 0;
-		for(size_t i = 0; i < sampleCount; i++) {
-			double in = _outputBuffer[i * 2 + offset];
-			double out;
-			equalizer->sbs_process(&in, &out);
-			_outputBuffer[i * 2 + offset] = (int16_t)std::max(std::min(out, 32767.0), -32768.0);
-		}
+	if(_batchMixing == disabled) {
+		//Discard the changes recorded for the current frame in the previous mode
+		_batchMixing = !disabled;
+		_timestamps.clear();
+		memset(_timestampMask, 0, sizeof(_timestampMask));
+		memset(_channelOutput, 0, sizeof(_channelOutput));
 	}
 }
 
@@ -343,11 +448,11 @@ void SoundMixer::UpdateEqualizers(bool forceUpdate)
 		vector<double> bandGains = _settings->GetBandGains();
 
 		if(bands.size() != _eqFrequencyGrid->get_number_of_bands()) {
-			_equalizerLeft.reset();
-			_equalizerRight.reset();
+			_equalizer.reset();
 		}
 
-		if((_equalizerLeft && (int)_equalizerLeft->get_eq_type() != (int)type) || !_equalizerLeft || forceUpdate) {
+		bool filtersChanged = false;
+		if((_equalizer && (int)_equalizer->get_eq_type() != (int)type) || !_equalizer || forceUpdate) {
 			bands.insert(bands.begin(), bands[0] - (bands[1] - bands[0]));
 			bands.insert(bands.end(), bands[bands.size() - 1] + (bands[bands.size() - 1] - bands[bands.size() - 2]));
 			_eqFrequencyGrid.reset(new orfanidis_eq::freq_grid());
@@ -355,19 +460,20 @@ void SoundMixer::UpdateEqualizers(bool forceUpdate)
 				_eqFrequencyGrid->add_band((bands[i] + bands[i - 1]) / 2, bands[i], (bands[i + 1] + bands[i]) / 2);
 			}
 
-			_equalizerLeft.reset(new orfanidis_eq::eq1(_eqFrequencyGrid.get(), (orfanidis_eq::filter_type)_settings->GetEqualizerFilterType()));
-			_equalizerRight.reset(new orfanidis_eq::eq1(_eqFrequencyGrid.get(), (orfanidis_eq::filter_type)_settings->GetEqualizerFilterType()));
-			_equalizerLeft->set_sample_rate(_sampleRate);
-			_equalizerRight->set_sample_rate(_sampleRate);
+			_equalizer.reset(new orfanidis_eq::eq1(_eqFrequencyGrid.get(), (orfanidis_eq::filter_type)_settings->GetEqualizerFilterType()));
+			_equalizer->set_sample_rate(_sampleRate);
+			filtersChanged = true;
 		}
 
 		for(unsigned int i = 0; i < _eqFrequencyGrid->get_number_of_bands(); i++) {
-			_equalizerLeft->change_band_gain_db(i, bandGains[i]);
-			_equalizerRight->change_band_gain_db(i, bandGains[i]);
+			_equalizer->change_band_gain_db(i, bandGains[i]);
 		}
-	} else {
-		_equalizerLeft.reset();
-		_equalizerRight.reset();
+
+		//The equalizer's filters are only used to get their coefficients, the post processor applies them in single precision
+		_postProcessor.SetEqualizer(_equalizer.get(), !filtersChanged);
+	} else if(_equalizer) {
+		_equalizer.reset();
+		_postProcessor.SetEqualizer(nullptr, false);
 	}
 }
 
@@ -439,7 +545,11 @@ double SoundMixer::GetTargetRateAdjustment()
 		//TODO: Have 2 output streams (one for recording, one for the speakers)
 		AudioStatistics stats = GetStatistics();
 
-		if(stats.AverageLatency > 0 && _settings->GetEmulationSpeed() == 100) {
+		if(stats.HasFillLevel && _settings->GetEmulationSpeed() == 100) {
+			//The device reports how much audio it has queued at any time, use it directly
+			_underTarget = 0;
+			_rateAdjustment = GetFillLevelRateAdjustment(stats.FillLevel, _settings->GetAudioLatency());
+		} else if(stats.AverageLatency > 0 && _settings->GetEmulationSpeed() == 100) {
 			//Try to stay within +/- 3ms of requested latency
 			constexpr int32_t maxGap = 3;
 			constexpr int32_t maxSubAdjustment = 3600;
@@ -470,15 +580,40 @@ double SoundMixer::GetTargetRateAdjustment()
 			}
 		} else {
 			_underTarget = 0;
+			_smoothedFillLevel = 0;
+			_fillLevelIntegral = 0;
 			_rateAdjustment = 1.0;
 		}
 	} else {
 		_underTarget = 0;
+		_smoothedFillLevel = 0;
+		_fillLevelIntegral = 0;
 		_rateAdjustment = 1.0;
 	}
 	return _rateAdjustment;
 }
 
+double SoundMixer::GetFillLevelRateAdjustment(double fillLevel, double requestedLatency)
+{
+	//The fill level drops by a full period each time the device reads from the buffer and rises by a frame's worth of samples
+	//each time a frame is played - smooth it out before using it (called about once per frame)
+	if(_smoothedFillLevel == 0) {
+		_smoothedFillLevel = fillLevel;
+	} else {
+		_smoothedFillLevel += (fillLevel - _smoothedFillLevel) * 0.05;
+	}
+
+	//Relative gap between the actual and requested latency (positive = too much audio queued, produce fewer samples)
+	double error = (_smoothedFillLevel - requestedLatency) / std::max(requestedLatency, 1.0);
+
+	//Proportional term to get back to the requested latency, integral term to slowly compensate for the difference
+	//between the emulation's clock and the sound card's actual sample rate
+	_fillLevelIntegral = std::max(-0.002, std::min(0.002, _fillLevelIntegral + error * 0.000005));
+	double adjustment = std::max(-0.0025, std::min(0.0025, error * 0.005));
+
+	return 1.0 - adjustment - _fillLevelIntegral;
+}
+
 void SoundMixer::UpdateTargetSampleRate()
 {
 	double targetRate = _sampleRate * GetTargetRateAdjustment();
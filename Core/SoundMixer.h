@@ -1,16 +1,11 @@
 #pragma once
 #include "stdafx.h"
 #include "EmulationSettings.h"
-#include "../Utilities/LowPassFilter.h"
 #include "../Utilities/blip_buf.h"
 #include "../Utilities/SimpleLock.h"
 #include "IAudioDevice.h"
 #include "Snapshotable.h"
-#include "StereoPanningFilter.h"
-#include "StereoDelayFilter.h"
-#include "StereoCombFilter.h"
-#include "ReverbFilter.h"
-#include "CrossFeedFilter.h"
+#include "AudioPostProcessor.h"
 
 class Console;
 class WaveRecorder;
@@ -31,6 +26,7 @@ private:
 	static constexpr uint32_t MaxSampleRate = 96000;
 	static constexpr uint32_t MaxSamplesPerFrame = MaxSampleRate / 60 * 4 * 2; //x4 to allow CPU overclocking up to 10x, x2 for panning stereo
 	static constexpr uint32_t MaxChannelCount = 11;
+	static constexpr uint32_t TimestampMaskSize = (CycleLength + 31) / 32;
 
 	IAudioDevice* _audioDevice;
 	EmulationSettings* _settings;
@@ -40,30 +36,35 @@ private:
 	unique_ptr<OggMixer> _oggMixer;
 	
 	unique_ptr<orfanidis_eq::freq_grid> _eqFrequencyGrid;
-	unique_ptr<orfanidis_eq::eq1> _equalizerLeft;
-	unique_ptr<orfanidis_eq::eq1> _equalizerRight;
+	unique_ptr<orfanidis_eq::eq1> _equalizer;
 	shared_ptr<Console> _console;
 
-	CrossFeedFilter _crossFeedFilter;
-	LowPassFilter _lowPassFilter;
-	StereoPanningFilter _stereoPanning;
-	StereoDelayFilter _stereoDelay;
-	StereoCombFilter _stereoCombFilter;
-	ReverbFilter _reverbFilter;
+	//Equalizer and audio effects (reverb, stereo filters, etc.) - these run on a worker thread while they are enabled
+	AudioPostProcessor _postProcessor;
 
 	int16_t _previousOutputLeft = 0;
 	int16_t _previousOutputRight = 0;
 
 	double _rateAdjustment = 1.0;
 	int32_t _underTarget = 0;
+	double _smoothedFillLevel = 0;
+	double _fillLevelIntegral = 0;
 
 	vector<uint32_t> _timestamps;
 	int16_t _channelOutput[MaxChannelCount][CycleLength];
 	int16_t _currentOutput[MaxChannelCount];
 
+	//Batched mixing: one bit per cycle where a channel's output changed, and the deltas sent to blip_buf at the end of the frame
+	bool _batchMixing = true;
+	uint32_t _timestampMask[TimestampMaskSize];
+	uint32_t _blipTimes[CycleLength];
+	int32_t _blipDeltasLeft[CycleLength];
+	int32_t _blipDeltasRight[CycleLength];
+	double _channelGainLeft[MaxChannelCount];
+	double _channelGainRight[MaxChannelCount];
+
 	blip_t* _blipBufLeft;
 	blip_t* _blipBufRight;
-	int16_t *_outputBuffer;
 	double _volumes[MaxChannelCount];
 	double _panning[MaxChannelCount];
 
@@ -77,14 +78,19 @@ private:
 
 	double GetChannelOutput(AudioChannel channel, bool forRightChannel);
 	int16_t GetOutputVolume(bool forRightChannel);
+	int16_t GetOutputVolume(double* channelGains);
 	void EndFrame(uint32_t time);
+	bool MixFrame(double masterVolume);
+	bool MixFrameUnbatched(double masterVolume);
 
 	void UpdateRates(bool forceUpdate);
 	
 	void UpdateEqualizers(bool forceUpdate);
-	void ApplyEqualizer(orfanidis_eq::eq1* equalizer, size_t sampleCount);
+	AudioEffectSettings GetEffectSettings();
+	void PlayFrame(AudioFrame& frame);
 	
 	double GetTargetRateAdjustment();
+	double GetFillLevelRateAdjustment(double fillLevel, double requestedLatency);
 	void UpdateTargetSampleRate();
 
 protected:
@@ -117,4 +123,7 @@ public:
 	AudioStatistics GetStatistics();
 	void ProcessEndOfFrame();
 	double GetRateAdjustment();
+
+	//Mixes and sends each output change to blip_buf one at a time, without batching (used by benchmarks)
+	void DisableBatchMixing(bool disabled);
 };
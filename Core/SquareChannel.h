@@ -89,6 +89,17 @@ protected:
 		UpdateOutput();
 	}
 
+	bool SkipClocks(uint32_t clockCount) override
+	{
+		if(_lastOutput != 0 || (!IsMuted() && GetVolume() > 0)) {
+			return false;
+		}
+
+		//Silent channel, only the duty cycle position changes
+		_dutyPos = (_dutyPos - clockCount) & 0x07;
+		return true;
+	}
+
 public:
 	SquareChannel(AudioChannel channel, shared_ptr<Console> console, SoundMixer *mixer, bool isChannel1) : ApuEnvelope(channel, console, mixer)
 	{
@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include "TraceLogFile.h"
+#include "DisassemblyInfo.h"
+#include "MemoryManager.h"
+
+bool TraceLogFile::IsBinaryTraceLog(string filename)
+{
+	string extension = filename.size() > 4 ? filename.substr(filename.size() - 4) : "";
+	std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+	return extension == ".mtl";
+}
+
+TraceLogFileHeader TraceLogFile::GetHeader()
+{
+	TraceLogFileHeader header = {};
+	memcpy(header.Signature, "MTL", 4);
+	header.Version = TraceLogFile::FileFormatVersion;
+	header.RecordSize = sizeof(TraceLogRecord);
+	return header;
+}
+
+void TraceLogFile::CreateRecord(TraceLogRecord &record, State &cpuState, PPUDebugState &ppuState, DisassemblyInfo &disassemblyInfo, MemoryManager* memoryManager)
+{
+	record.CycleCount = cpuState.CycleCount;
+	record.FrameCount = ppuState.FrameCount;
+	record.Scanline = (int16_t)ppuState.Scanline;
+	record.Cycle = (uint16_t)ppuState.Cycle;
+	record.PC = cpuState.DebugPC;
+	disassemblyInfo.GetByteCode(record.ByteCode);
+	record.A = cpuState.A;
+	record.X = cpuState.X;
+	record.Y = cpuState.Y;
+	record.SP = cpuState.SP;
+	record.PS = cpuState.PS;
+	record.Flags = (uint8_t)TraceLogRecordType::Instruction;
+
+	int32_t effectiveAddress = disassemblyInfo.GetEffectiveAddress(cpuState, memoryManager);
+	if(effectiveAddress >= 0) {
+		record.EffectiveAddress = (uint16_t)effectiveAddress;
+		record.Flags |= TraceLogRecordFlags::HasEffectiveAddress;
+	} else {
+		record.EffectiveAddress = 0;
+	}
+
+	int32_t memoryValue = disassemblyInfo.GetMemoryValue(cpuState, memoryManager);
+	if(memoryValue >= 0) {
+		record.MemoryValue = (uint8_t)memoryValue;
+		record.Flags |= TraceLogRecordFlags::HasMemoryValue;
+	} else {
+		record.MemoryValue = 0;
+	}
+}
+
+void TraceLogFile::CreateExtraInfoRecord(TraceLogRecord &record, TraceLogRecordType type, uint64_t cycleCount)
+{
+	record = {};
+	record.CycleCount = cycleCount;
+	record.Flags = (uint8_t)type;
+}
+
+bool TraceLogFile::Open(string filename)
+{
+	_recordCount = 0;
+	if(!_file.Open(filename) || _file.GetSize() < sizeof(TraceLogFileHeader)) {
+		return false;
+	}
+
+	TraceLogFileHeader header;
+	memcpy(&header, _file.GetData(), sizeof(header));
+	if(memcmp(header.Signature, "MTL", 4) != 0 || header.Version != TraceLogFile::FileFormatVersion || header.RecordSize != sizeof(TraceLogRecord)) {
+		_file.Close();
+		return false;
+	}
+
+	//A log that was interrupted (e.g crash) can end with a partial record, ignore it
+	_recordCount = (_file.GetSize() - sizeof(TraceLogFileHeader)) / sizeof(TraceLogRecord);
+	return true;
+}
+
+size_t TraceLogFile::GetRecordCount()
+{
+	return _recordCount;
+}
+
+TraceLogRecord TraceLogFile::GetRecord(size_t index)
+{
+	TraceLogRecord record;
+	memcpy(&record, _file.GetData() + sizeof(TraceLogFileHeader) + index * sizeof(TraceLogRecord), sizeof(TraceLogRecord));
+	return record;
+}
+
+size_t TraceLogFile::FindCycle(uint64_t cycleCount)
+{
+	//Records are logged in execution order, so their cycle counts are sorted (unless the console was reset while logging)
+	size_t start = 0;
+	size_t end = _recordCount;
+	while(start < end) {
+		size_t middle = start + (end - start) / 2;
+		if(GetRecord(middle).CycleCount < cycleCount) {
+			start = middle + 1;
+		} else {
+			end = middle;
+		}
+	}
+	return start;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "stdafx.h"
+#include "Types.h"
+#include "DebuggerTypes.h"
+#include "../Utilities/MemoryMappedFile.h"
+
+class DisassemblyInfo;
+class MemoryManager;
+
+enum class TraceLogRecordType : uint8_t
+{
+	Instruction = 0,
+	Nmi = 1,
+	Irq = 2
+};
+
+namespace TraceLogRecordFlags
+{
+	enum TraceLogRecordFlags : uint8_t
+	{
+		TypeMask = 0x03,
+		HasEffectiveAddress = 0x04,
+		HasMemoryValue = 0x08,
+	};
+}
+
+//Binary trace log record - everything needed to format a row of the trace log (with any format) is captured when the instruction is logged
+//Records have a fixed size, in native byte order: the Nth record of a binary trace log is at offset sizeof(TraceLogFileHeader) + N * sizeof(TraceLogRecord)
+struct TraceLogRecord
+{
+	uint64_t CycleCount;
+	uint32_t FrameCount;
+	int16_t Scanline;
+	uint16_t Cycle;
+	uint16_t PC;
+
+	//Effective address and memory value, as they were before the instruction was executed
+	uint16_t EffectiveAddress;
+	uint8_t ByteCode[3];
+	uint8_t A;
+	uint8_t X;
+	uint8_t Y;
+	uint8_t SP;
+	uint8_t PS;
+	uint8_t MemoryValue;
+
+	//Type (TraceLogRecordType) and TraceLogRecordFlags
+	uint8_t Flags;
+};
+
+static_assert(sizeof(TraceLogRecord) == 32, "Invalid trace log record size");
+
+struct TraceLogFileHeader
+{
+	char Signature[4];
+	uint32_t Version;
+	uint32_t RecordSize;
+	uint32_t Reserved;
+};
+
+//Read-only access to a binary trace log (.mtl) - the file is memory-mapped, so any part of a large log can be read without loading all of it
+class TraceLogFile
+{
+private:
+	MemoryMappedFile _file;
+	size_t _recordCount = 0;
+
+public:
+	static constexpr uint32_t FileFormatVersion = 1;
+
+	//Binary trace logs are used when the log's filename has this extension, any other file is logged as text
+	static bool IsBinaryTraceLog(string filename);
+	static TraceLogFileHeader GetHeader();
+
+	static void CreateRecord(TraceLogRecord &record, State &cpuState, PPUDebugState &ppuState, DisassemblyInfo &disassemblyInfo, MemoryManager* memoryManager);
+	static void CreateExtraInfoRecord(TraceLogRecord &record, TraceLogRecordType type, uint64_t cycleCount);
+
+	bool Open(string filename);
+
+	size_t GetRecordCount();
+	TraceLogRecord GetRecord(size_t index);
+
+	//Returns the index of the first record logged at or after the given CPU cycle (or the record count, if there are none)
+	size_t FindCycle(uint64_t cycleCount);
+};
@@ -0,0 +1,199 @@
+#include "stdafx.h"
+#include <regex>
+#include "TraceLogFormatter.h"
+#include "DisassemblyInfo.h"
+#include "LabelManager.h"
+#include "../Utilities/HexUtilities.h"
+
+TraceLogFormatter::TraceLogFormatter(TraceLoggerOptions options, shared_ptr<LabelManager> labelManager)
+{
+	_options = options;
+	_labelManager = _options.UseLabels ? labelManager : nullptr;
+
+	string format = _options.Format;
+	std::regex formatRegex = std::regex("(\\[\\s*([^[]*?)\\s*(,\\s*([\\d]*)\\s*(h){0,1}){0,1}\\s*\\])|([^[]*)", std::regex_constants::icase);
+	std::sregex_iterator start = std::sregex_iterator(format.cbegin(), format.cend(), formatRegex);
+	std::sregex_iterator end = std::sregex_iterator();
+
+	for(std::sregex_iterator it = start; it != end; it++) {
+		const std::smatch& match = *it;
+
+		if(match.str(1) == "") {
+			RowPart part = {};
+			part.DataType = RowDataType::Text;
+			part.Text = match.str(6);
+			_rowParts.push_back(part);
+		} else {
+			RowPart part = {};
+
+			string dataType = match.str(2);
+			if(dataType == "ByteCode") {
+				part.DataType = RowDataType::ByteCode;
+			} else if(dataType == "Disassembly") {
+				part.DataType = RowDataType::Disassembly;
+			} else if(dataType == "EffectiveAddress") {
+				part.DataType = RowDataType::EffectiveAddress;
+			} else if(dataType == "MemoryValue") {
+				part.DataType = RowDataType::MemoryValue;
+			} else if(dataType == "Align") {
+				part.DataType = RowDataType::Align;
+			} else if(dataType == "PC") {
+				part.DataType = RowDataType::PC;
+			} else if(dataType == "A") {
+				part.DataType = RowDataType::A;
+			} else if(dataType == "X") {
+				part.DataType = RowDataType::X;
+			} else if(dataType == "Y") {
+				part.DataType = RowDataType::Y;
+			} else if(dataType == "P") {
+				part.DataType = RowDataType::PS;
+			} else if(dataType == "SP") {
+				part.DataType = RowDataType::SP;
+			} else if(dataType == "Cycle") {
+				part.DataType = RowDataType::Cycle;
+			} else if(dataType == "Scanline") {
+				part.DataType = RowDataType::Scanline;
+			} else if(dataType == "FrameCount") {
+				part.DataType = RowDataType::FrameCount;
+			} else if(dataType == "CycleCount") {
+				part.DataType = RowDataType::CycleCount;
+			} else {
+				part.DataType = RowDataType::Text;
+				part.Text = "[Invalid tag]";
+			}
+
+			if(!match.str(4).empty()) {
+				try {
+					part.MinWidth = std::stoi(match.str(4));
+				} catch(std::exception &) {
+				}
+			}
+			part.DisplayInHex = match.str(5) == "h";
+
+			_rowParts.push_back(part);
+		}
+	}
+}
+
+template<typename T>
+void TraceLogFormatter::WriteValue(string &output, T value, RowPart& rowPart)
+{
+	string str = rowPart.DisplayInHex ? HexUtilities::ToHex(value) : std::to_string(value);
+	output += str;
+	if(rowPart.MinWidth > (int)str.size()) {
+		output += std::string(rowPart.MinWidth - str.size(), ' ');
+	}
+}
+
+template<>
+void TraceLogFormatter::WriteValue(string &output, string value, RowPart& rowPart)
+{
+	output += value;
+	if(rowPart.MinWidth > (int)value.size()) {
+		output += std::string(rowPart.MinWidth - value.size(), ' ');
+	}
+}
+
+void TraceLogFormatter::GetStatusFlag(string &output, uint8_t ps, RowPart& part)
+{
+	if(part.DisplayInHex) {
+		WriteValue(output, ps, part);
+	} else {
+		constexpr char activeStatusLetters[8] = { 'N', 'V', '-', '-', 'D', 'I', 'Z', 'C' };
+		constexpr char inactiveStatusLetters[8] = { 'n', 'v', '-', '-', 'd', 'i', 'z', 'c' };
+		string flags;
+		for(int i = 0; i < 8; i++) {
+			if(ps & 0x80) {
+				flags += activeStatusLetters[i];
+			} else if(part.MinWidth >= 8) {
+				flags += inactiveStatusLetters[i];
+			}
+			ps <<= 1;
+		}
+		WriteValue(output, flags, part);
+	}
+}
+
+void TraceLogFormatter::GetTraceRow(string &output, TraceLogRecord &record)
+{
+	TraceLogRecordType type = (TraceLogRecordType)(record.Flags & TraceLogRecordFlags::TypeMask);
+	if(type != TraceLogRecordType::Instruction) {
+		if(_options.ShowExtraInfo) {
+			output += type == TraceLogRecordType::Nmi ? "[NMI - Cycle: " : "[IRQ - Cycle: ";
+			output += std::to_string(record.CycleCount) + "]";
+			output += _options.UseWindowsEol ? "\r\n" : "\n";
+		}
+		return;
+	}
+
+	DisassemblyInfo disassemblyInfo(record.ByteCode, false);
+
+	int originalSize = (int)output.size();
+	for(RowPart& rowPart : _rowParts) {
+		switch(rowPart.DataType) {
+			case RowDataType::Text: output += rowPart.Text; break;
+
+			case RowDataType::ByteCode: {
+				string byteCode;
+				disassemblyInfo.GetByteCode(byteCode);
+				if(!rowPart.DisplayInHex) {
+					//Remove $ marks if not in "hex" mode (but still display the bytes as hex)
+					byteCode.erase(std::remove(byteCode.begin(), byteCode.end(), '$'), byteCode.end());
+				}
+				WriteValue(output, byteCode, rowPart);
+				break;
+			}
+
+			case RowDataType::Disassembly: {
+				int indentLevel = 0;
+				string code;
+
+				if(_options.IndentCode) {
+					indentLevel = 0xFF - record.SP;
+					code = std::string(indentLevel, ' ');
+				}
+
+				disassemblyInfo.ToString(code, record.PC, nullptr, _labelManager.get(), _options.ExtendZeroPage);
+				WriteValue(output, code, rowPart);
+				break;
+			}
+
+			case RowDataType::EffectiveAddress:{
+				if(record.Flags & TraceLogRecordFlags::HasEffectiveAddress) {
+					string effectiveAddress;
+					disassemblyInfo.GetEffectiveAddressString(effectiveAddress, record.EffectiveAddress, _labelManager.get());
+					WriteValue(output, effectiveAddress, rowPart);
+				} else {
+					WriteValue(output, string(), rowPart);
+				}
+				break;
+			}
+
+			case RowDataType::MemoryValue:{
+				if(record.Flags & TraceLogRecordFlags::HasMemoryValue) {
+					output += rowPart.DisplayInHex ? "= $" : "= ";
+					WriteValue(output, record.MemoryValue, rowPart);
+				}
+				break;
+			}
+
+			case RowDataType::Align:
+				if((int)output.size() - originalSize < rowPart.MinWidth) {
+					output += std::string(rowPart.MinWidth - (output.size() - originalSize), ' ');
+				}
+				break;
+
+			case RowDataType::PC: WriteValue(output, record.PC, rowPart); break;
+			case RowDataType::A: WriteValue(output, record.A, rowPart); break;
+			case RowDataType::X: WriteValue(output, record.X, rowPart); break;
+			case RowDataType::Y: WriteValue(output, record.Y, rowPart); break;
+			case RowDataType::SP: WriteValue(output, record.SP, rowPart); break;
+			case RowDataType::PS: GetStatusFlag(output, record.PS, rowPart); break;
+			case RowDataType::Cycle: WriteValue(output, (uint32_t)record.Cycle, rowPart); break;
+			case RowDataType::Scanline: WriteValue(output, (int32_t)record.Scanline, rowPart); break;
+			case RowDataType::FrameCount: WriteValue(output, record.FrameCount, rowPart); break;
+			case RowDataType::CycleCount: WriteValue(output, record.CycleCount, rowPart); break;
+		}
+	}
+	output += _options.UseWindowsEol ? "\r\n" : "\n";
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "stdafx.h"
+#include "TraceLogFile.h"
+
+class LabelManager;
+
+enum class RowDataType
+{
+	Text = 0,
+	ByteCode,
+	Disassembly,
+	EffectiveAddress,
+	MemoryValue,
+	Align,
+	PC,
+	A,
+	X,
+	Y,
+	SP,
+	PS,
+	Cycle,
+	Scanline,
+	FrameCount,
+	CycleCount
+};
+
+struct RowPart
+{
+	RowDataType DataType;
+	string Text;
+	bool DisplayInHex;
+	int MinWidth;
+};
+
+struct TraceLoggerOptions
+{
+	bool ShowExtraInfo;
+	bool IndentCode;
+	bool UseLabels;
+	bool UseWindowsEol;
+	bool ExtendZeroPage;
+
+	char Condition[1000];
+	char Format[1000];
+};
+
+//Formats trace log records as text, based on the trace logger's format string
+//Formatters are not modified after they are created, so they can be shared with the trace log writer's thread
+class TraceLogFormatter
+{
+private:
+	TraceLoggerOptions _options;
+	vector<RowPart> _rowParts;
+	shared_ptr<LabelManager> _labelManager;
+
+	void GetStatusFlag(string &output, uint8_t ps, RowPart& part);
+	template<typename T> void WriteValue(string &output, T value, RowPart& rowPart);
+
+public:
+	//Format used when none is given (matches the trace logger window's default options, with every column enabled)
+	static constexpr const char* DefaultFormat = "[PC,h] [ByteCode,11h] [Disassembly][EffectiveAddress] [MemoryValue,h][Align,54] A:[A,h] X:[X,h] Y:[Y,h] P:[P,h] SP:[SP,h] CYC:[Cycle,3] SL:[Scanline,3] FC:[FrameCount] CPU Cycle:[CycleCount]";
+
+	TraceLogFormatter(TraceLoggerOptions options, shared_ptr<LabelManager> labelManager);
+
+	//Appends the record's row (if any) to the output, followed by an end of line
+	void GetTraceRow(string &output, TraceLogRecord &record);
+};
@@ -0,0 +1,136 @@
+#include "stdafx.h"
+#include "TraceLogWriter.h"
+#include "TraceLogFormatter.h"
+
+TraceLogWriter::TraceLogWriter()
+{
+	_writePosition = 0;
+	_readPosition = 0;
+	_stopFlag = false;
+	_records = vector<TraceLogRecord>(TraceLogWriter::RecordCount);
+}
+
+TraceLogWriter::~TraceLogWriter()
+{
+	Close();
+}
+
+bool TraceLogWriter::Open(string filename, shared_ptr<TraceLogFormatter> formatter)
+{
+	_outputFile.open(filename, ios::out | ios::binary);
+	if(!_outputFile) {
+		return false;
+	}
+
+	_binaryOutput = TraceLogFile::IsBinaryTraceLog(filename);
+	if(_binaryOutput) {
+		TraceLogFileHeader header = TraceLogFile::GetHeader();
+		_outputFile.write((char*)&header, sizeof(header));
+	}
+
+	_formatter = formatter;
+	_stopFlag = false;
+	_writerThread = std::thread(&TraceLogWriter::WriterThread, this);
+	return true;
+}
+
+void TraceLogWriter::Close()
+{
+	if(_writerThread.joinable()) {
+		_stopFlag = true;
+		_recordsQueued.Signal();
+		_writerThread.join();
+
+		//The emulation thread can still queue records while the writer thread is stopping (e.g a Log() call that started before
+		//TraceLogger::StopLogging), write them now that this thread is the only consumer
+		while(WriteRecords()) { }
+		if(!_outputBuffer.empty()) {
+			_outputFile << _outputBuffer;
+			_outputBuffer.clear();
+		}
+	}
+
+	if(_outputFile.is_open()) {
+		_outputFile.close();
+	}
+}
+
+void TraceLogWriter::SetFormatter(shared_ptr<TraceLogFormatter> formatter)
+{
+	auto lock = _formatterLock.AcquireSafe();
+	_formatter = formatter;
+}
+
+void TraceLogWriter::AddRecord(TraceLogRecord &record)
+{
+	uint32_t writePosition = _writePosition.load(std::memory_order_relaxed);
+	if(writePosition - _readPosition.load(std::memory_order_acquire) >= TraceLogWriter::RecordCount) {
+		//Ring buffer is full, wait for the writer thread to catch up
+		_recordsQueued.Signal();
+		while(writePosition - _readPosition.load(std::memory_order_acquire) >= TraceLogWriter::RecordCount) {
+			_recordsWritten.Wait(10);
+		}
+	}
+
+	_records[writePosition & (TraceLogWriter::RecordCount - 1)] = record;
+	_writePosition.store(writePosition + 1, std::memory_order_release);
+
+	if(((writePosition + 1) & (TraceLogWriter::BatchSize - 1)) == 0) {
+		_recordsQueued.Signal();
+	}
+}
+
+bool TraceLogWriter::WriteRecords()
+{
+	uint32_t readPosition = _readPosition.load(std::memory_order_relaxed);
+	uint32_t writePosition = _writePosition.load(std::memory_order_acquire);
+	if(readPosition == writePosition) {
+		return false;
+	}
+
+	//Process records in batches, to free up space in the ring buffer as soon as possible
+	uint32_t start = readPosition & (TraceLogWriter::RecordCount - 1);
+	uint32_t count = std::min(std::min(writePosition - readPosition, TraceLogWriter::BatchSize), TraceLogWriter::RecordCount - start);
+
+	if(_binaryOutput) {
+		_outputFile.write((char*)&_records[start], count * sizeof(TraceLogRecord));
+	} else {
+		shared_ptr<TraceLogFormatter> formatter;
+		{
+			auto lock = _formatterLock.AcquireSafe();
+			formatter = _formatter;
+		}
+
+		for(uint32_t i = 0; i < count; i++) {
+			formatter->GetTraceRow(_outputBuffer, _records[start + i]);
+		}
+		if(_outputBuffer.size() > 32768) {
+			_outputFile << _outputBuffer;
+			_outputBuffer.clear();
+		}
+	}
+
+	_readPosition.store(readPosition + count, std::memory_order_release);
+	_recordsWritten.Signal();
+	return true;
+}
+
+void TraceLogWriter::WriterThread()
+{
+	while(true) {
+		_recordsQueued.Wait(50);
+		bool stop = _stopFlag;
+
+		while(WriteRecords()) { }
+
+		if(stop) {
+			break;
+		}
+	}
+
+	if(!_outputBuffer.empty()) {
+		_outputFile << _outputBuffer;
+		_outputBuffer.clear();
+	}
+	_outputFile.flush();
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "stdafx.h"
+#include <thread>
+#include "TraceLogFile.h"
+#include "../Utilities/SimpleLock.h"
+#include "../Utilities/AutoResetEvent.h"
+
+class TraceLogFormatter;
+
+//Writes the trace log to a file on a separate thread
+//The emulation thread only copies each record into a lock-free ring buffer - the writer thread then either writes the records
+//as-is (binary trace logs) or formats them to text, so the cost of formatting/writing the log is not paid by the emulation thread.
+class TraceLogWriter
+{
+private:
+	static constexpr uint32_t CacheLineSize = 64;
+
+	//Number of records in the ring buffer (2 MB)
+	static constexpr uint32_t RecordCount = 0x10000;
+
+	//The writer thread is woken up every time this many records are queued (and at regular intervals)
+	static constexpr uint32_t BatchSize = 0x400;
+
+	//Only modified by the constructor, read by both threads
+	vector<TraceLogRecord> _records;
+
+	//Each position is only modified by one thread - they are aligned to separate cache lines to avoid false sharing between the 2 threads.
+	alignas(CacheLineSize) atomic<uint32_t> _writePosition;
+	alignas(CacheLineSize) atomic<uint32_t> _readPosition;
+
+	ofstream _outputFile;
+	bool _binaryOutput = false;
+	string _outputBuffer;
+
+	SimpleLock _formatterLock;
+	shared_ptr<TraceLogFormatter> _formatter;
+
+	std::thread _writerThread;
+	atomic<bool> _stopFlag;
+	AutoResetEvent _recordsQueued;
+	AutoResetEvent _recordsWritten;
+
+	void WriterThread();
+	bool WriteRecords();
+
+public:
+	TraceLogWriter();
+	~TraceLogWriter();
+
+	bool Open(string filename, shared_ptr<TraceLogFormatter> formatter);
+
+	//Stops the writer thread, writes all the queued records (including the ones queued while the thread was stopping) and closes the file
+	void Close();
+
+	//Used for the records that are logged after this call (only affects text logs)
+	void SetFormatter(shared_ptr<TraceLogFormatter> formatter);
+
+	//Emulation thread: queues a record, only waits for the writer thread if the ring buffer is full (records are never dropped)
+	void AddRecord(TraceLogRecord &record);
+};
@@ -1,5 +1,4 @@
 #include "stdafx.h"
-#include <regex>
 #include "TraceLogger.h"
 #include "DisassemblyInfo.h"
 #include "DebuggerTypes.h"
@@ -9,6 +8,7 @@
 #include "LabelManager.h"
 #include "EmulationSettings.h"
 #include "ExpressionEvaluator.h"
+#include "TraceLogWriter.h"
 #include "../Utilities/HexUtilities.h"
 #include "../Utilities/FolderUtilities.h"
 
@@ -20,9 +20,17 @@ TraceLogger::TraceLogger(Debugger* debugger, shared_ptr<MemoryManager> memoryMan
 	_memoryManager = memoryManager;
 	_labelManager = labelManager;
 	_currentPos = 0;
-	_logCount = 0;
-	_logToFile = false;
+	_rowCount = 0;
+	_firstRow = 0;
 	_pendingLog = false;
+	_options = {};
+
+	shared_ptr<LogSettings> settings(new LogSettings());
+	settings->Formatter.reset(new TraceLogFormatter(_options, _labelManager));
+	_settings = settings;
+	_settingsVersion = 0;
+	_activeSettings = settings;
+	_activeSettingsVersion = 0;
 }
 
 TraceLogger::~TraceLogger()
@@ -30,232 +38,92 @@ TraceLogger::~TraceLogger()
 	StopLogging();
 }
 
-template<typename T>
-void TraceLogger::WriteValue(string &output, T value, RowPart& rowPart)
+void TraceLogger::PublishSettings(shared_ptr<LogSettings> settings)
 {
-	string str = rowPart.DisplayInHex ? HexUtilities::ToHex(value) : std::to_string(value);
-	output += str;
-	if(rowPart.MinWidth > (int)str.size()) {
-		output += std::string(rowPart.MinWidth - str.size(), ' ');
-	}
+	std::atomic_store(&_settings, settings);
+	_settingsVersion++;
 }
 
-template<>
-void TraceLogger::WriteValue(string &output, string value, RowPart& rowPart)
+TraceLogger::LogSettings* TraceLogger::GetSettings()
 {
-	output += value;
-	if(rowPart.MinWidth > (int)value.size()) {
-		output += std::string(rowPart.MinWidth - value.size(), ' ');
+	uint32_t version = _settingsVersion.load(std::memory_order_acquire);
+	if(version != _activeSettingsVersion) {
+		_activeSettings = std::atomic_load(&_settings);
+		_activeSettingsVersion = version;
 	}
+	return _activeSettings.get();
 }
 
 void TraceLogger::SetOptions(TraceLoggerOptions options)
 {
+	auto lock = _lock.AcquireSafe();
 	_options = options;
 	string condition = _options.Condition;
-	string format = _options.Format;
 	
-	auto lock = _lock.AcquireSafe();
-	_conditionData = ExpressionData();
+	shared_ptr<LogSettings> settings(new LogSettings(*std::atomic_load(&_settings)));
+	settings->Condition = ExpressionData();
 	if(!condition.empty()) {
 		bool success = false;
 		ExpressionData rpnList = _expEvaluator->GetRpnList(condition, success);
 		if(success) {
-			_conditionData = rpnList;
+			settings->Condition = rpnList;
 		}
 	}
 
-	_rowParts.clear();
-
-	std::regex formatRegex = std::regex("(\\[\\s*([^[]*?)\\s*(,\\s*([\\d]*)\\s*(h){0,1}){0,1}\\s*\\])|([^[]*)", std::regex_constants::icase);
-	std::sregex_iterator start = std::sregex_iterator(format.cbegin(), format.cend(), formatRegex);
-	std::sregex_iterator end = std::sregex_iterator();
-
-	for(std::sregex_iterator it = start; it != end; it++) {
-		const std::smatch& match = *it;
-
-		if(match.str(1) == "") {
-			RowPart part = {};
-			part.DataType = RowDataType::Text;
-			part.Text = match.str(6);
-			_rowParts.push_back(part);
-		} else {
-			RowPart part = {};
-			
-			string dataType = match.str(2);
-			if(dataType == "ByteCode") {
-				part.DataType = RowDataType::ByteCode;
-			} else if(dataType == "Disassembly") {
-				part.DataType = RowDataType::Disassembly;
-			} else if(dataType == "EffectiveAddress") {
-				part.DataType = RowDataType::EffectiveAddress;
-			} else if(dataType == "MemoryValue") {
-				part.DataType = RowDataType::MemoryValue;
-			} else if(dataType == "Align") {
-				part.DataType = RowDataType::Align;
-			} else if(dataType == "PC") {
-				part.DataType = RowDataType::PC;
-			} else if(dataType == "A") {
-				part.DataType = RowDataType::A;
-			} else if(dataType == "X") {
-				part.DataType = RowDataType::X;
-			} else if(dataType == "Y") {
-				part.DataType = RowDataType::Y;
-			} else if(dataType == "P") {
-				part.DataType = RowDataType::PS;
-			} else if(dataType == "SP") {
-				part.DataType = RowDataType::SP;
-			} else if(dataType == "Cycle") {
-				part.DataType = RowDataType::Cycle;
-			} else if(dataType == "Scanline") {
-				part.DataType = RowDataType::Scanline;
-			} else if(dataType == "FrameCount") {
-				part.DataType = RowDataType::FrameCount;
-			} else if(dataType == "CycleCount") {
-				part.DataType = RowDataType::CycleCount;
-			} else {
-				part.DataType = RowDataType::Text;
-				part.Text = "[Invalid tag]";
-			}
-
-			if(!match.str(4).empty()) {
-				try {
-					part.MinWidth = std::stoi(match.str(4));
-				} catch(std::exception &) {
-				}
-			}
-			part.DisplayInHex = match.str(5) == "h";
-
-			_rowParts.push_back(part);
-		}
+	settings->Formatter.reset(new TraceLogFormatter(_options, _labelManager));
+	if(settings->Writer) {
+		settings->Writer->SetFormatter(settings->Formatter);
 	}
+	PublishSettings(settings);
 }
 
 void TraceLogger::StartLogging(string filename)
 {
-	_outputBuffer.clear();
-	_outputFile.open(filename, ios::out | ios::binary);
-	_logToFile = true;
-}
+	StopLogging();
 
-void TraceLogger::StopLogging() 
-{
-	if(_logToFile) {
-		_logToFile = false;
-		if(_outputFile) {
-			if(!_outputBuffer.empty()) {
-				_outputFile << _outputBuffer;
-			}
-			_outputFile.close();
-		}
+	auto lock = _lock.AcquireSafe();
+	shared_ptr<LogSettings> settings(new LogSettings(*std::atomic_load(&_settings)));
+	shared_ptr<TraceLogWriter> writer(new TraceLogWriter());
+	if(writer->Open(filename, settings->Formatter)) {
+		settings->Writer = writer;
+		PublishSettings(settings);
 	}
 }
 
-void TraceLogger::LogExtraInfo(const char *log, uint64_t cycleCount)
+void TraceLogger::StopLogging() 
 {
-	if(_logToFile && _options.ShowExtraInfo) {
-		//Flush current buffer
-		_outputFile << _outputBuffer;
-		_outputBuffer.clear();
-		_outputFile << "[" << log << " - Cycle: " << std::to_string(cycleCount) << "]" << (_options.UseWindowsEol ? "\r\n" : "\n");
+	shared_ptr<TraceLogWriter> writer;
+	{
+		auto lock = _lock.AcquireSafe();
+		shared_ptr<LogSettings> settings(new LogSettings(*std::atomic_load(&_settings)));
+		writer = settings->Writer;
+		settings->Writer.reset();
+		PublishSettings(settings);
 	}
-}
 
-void TraceLogger::GetStatusFlag(string &output, uint8_t ps, RowPart& part)
-{
-	if(part.DisplayInHex) {
-		WriteValue(output, ps, part);
-	} else {
-		constexpr char activeStatusLetters[8] = { 'N', 'V', '-', '-', 'D', 'I', 'Z', 'C' };
-		constexpr char inactiveStatusLetters[8] = { 'n', 'v', '-', '-', 'd', 'i', 'z', 'c' };
-		string flags;
-		for(int i = 0; i < 8; i++) {
-			if(ps & 0x80) {
-				flags += activeStatusLetters[i];
-			} else if(part.MinWidth >= 8) {
-				flags += inactiveStatusLetters[i];
-			}
-			ps <<= 1;
-		}
-		WriteValue(output, flags, part);
+	if(writer) {
+		//Wait for the remaining records to be written (outside the lock to avoid blocking the other setters)
+		//Close() also writes the row of a Log() call that was running at the same time and still used the previous settings
+		writer->Close();
 	}
 }
 
-void TraceLogger::GetTraceRow(string &output, State &cpuState, PPUDebugState &ppuState, DisassemblyInfo &disassemblyInfo)
+void TraceLogger::LogExtraInfo(const char *log, uint64_t cycleCount)
 {
-	int originalSize = (int)output.size();
-	for(RowPart& rowPart : _rowParts) {
-		switch(rowPart.DataType) {
-			case RowDataType::Text: output += rowPart.Text; break;
-
-			case RowDataType::ByteCode: {
-				string byteCode;
-				disassemblyInfo.GetByteCode(byteCode);
-				if(!rowPart.DisplayInHex) {
-					//Remove $ marks if not in "hex" mode (but still display the bytes as hex)
-					byteCode.erase(std::remove(byteCode.begin(), byteCode.end(), '$'), byteCode.end());
-				}
-				WriteValue(output, byteCode, rowPart);
-				break;
-			}
-
-			case RowDataType::Disassembly: {
-				int indentLevel = 0;
-				string code;
-				
-				if(_options.IndentCode) {
-					indentLevel = 0xFF - cpuState.SP;
-					code = std::string(indentLevel, ' ');
-				}
-				
-				LabelManager* labelManager = _options.UseLabels ? _labelManager.get() : nullptr;
-				disassemblyInfo.ToString(code, cpuState.DebugPC, _memoryManager.get(), labelManager, _options.ExtendZeroPage);
-				WriteValue(output, code, rowPart);
-				break;
-			}
-			
-			case RowDataType::EffectiveAddress:{
-				string effectiveAddress;
-				disassemblyInfo.GetEffectiveAddressString(effectiveAddress, cpuState, _memoryManager.get(), _options.UseLabels ? _labelManager.get() : nullptr);
-				WriteValue(output, effectiveAddress, rowPart);
-				break;
-			}
-
-			case RowDataType::MemoryValue:{
-				int32_t value = disassemblyInfo.GetMemoryValue(cpuState, _memoryManager.get());
-				if(value >= 0) {
-					output += rowPart.DisplayInHex ? "= $" : "= ";
-					WriteValue(output, (uint8_t)value, rowPart);
-				}
-				break;
-			}
-
-			case RowDataType::Align:
-				if((int)output.size() - originalSize < rowPart.MinWidth) {
-					output += std::string(rowPart.MinWidth - (output.size() - originalSize), ' ');
-				}
-				break;
-
-			case RowDataType::PC: WriteValue(output, cpuState.DebugPC, rowPart); break;
-			case RowDataType::A: WriteValue(output, cpuState.A, rowPart); break;
-			case RowDataType::X: WriteValue(output, cpuState.X, rowPart); break;
-			case RowDataType::Y: WriteValue(output, cpuState.Y, rowPart); break;
-			case RowDataType::SP: WriteValue(output, cpuState.SP, rowPart); break;
-			case RowDataType::PS: GetStatusFlag(output, cpuState.PS, rowPart); break;
-			case RowDataType::Cycle: WriteValue(output, ppuState.Cycle, rowPart); break;
-			case RowDataType::Scanline: WriteValue(output, ppuState.Scanline, rowPart); break;
-			case RowDataType::FrameCount: WriteValue(output, ppuState.FrameCount, rowPart); break;
-			case RowDataType::CycleCount: WriteValue(output, cpuState.CycleCount, rowPart); break;
-		}
+	LogSettings* settings = GetSettings();
+	if(settings->Writer) {
+		//Extra info (NMIs and IRQs) is always logged, the formatter only displays it when ShowExtraInfo is enabled
+		TraceLogRecord record;
+		TraceLogFile::CreateExtraInfoRecord(record, strcmp(log, "IRQ") == 0 ? TraceLogRecordType::Irq : TraceLogRecordType::Nmi, cycleCount);
+		settings->Writer->AddRecord(record);
 	}
-	output += _options.UseWindowsEol ? "\r\n" : "\n";
 }
 
-bool TraceLogger::ConditionMatches(DebugState &state, DisassemblyInfo &disassemblyInfo, OperationInfo &operationInfo)
+bool TraceLogger::ConditionMatches(LogSettings* settings, DebugState &state, DisassemblyInfo &disassemblyInfo, OperationInfo &operationInfo)
 {
-	if(!_conditionData.RpnQueue.empty()) {
+	if(!settings->Condition.RpnQueue.empty()) {
 		EvalResultType type;
-		if(!_expEvaluator->Evaluate(_conditionData, state, type, operationInfo)) {
+		if(!_expEvaluator->Evaluate(settings->Condition, state, type, operationInfo)) {
 			if(operationInfo.OperationType == MemoryOperationType::ExecOpCode) {
 				//Condition did not match, keep state/disassembly info for instruction's subsequent cycles
 				_lastState = state;
@@ -268,7 +136,7 @@ bool TraceLogger::ConditionMatches(DebugState &state, DisassemblyInfo &disassemb
 	return true;
 }
 
-void TraceLogger::AddRow(DisassemblyInfo &disassemblyInfo, DebugState &state)
+void TraceLogger::AddRow(LogSettings* settings, DisassemblyInfo &disassemblyInfo, DebugState &state)
 {
 	_disassemblyCache[_currentPos] = disassemblyInfo;
 	_cpuStateCache[_currentPos] = state.CPU;
@@ -276,64 +144,75 @@ void TraceLogger::AddRow(DisassemblyInfo &disassemblyInfo, DebugState &state)
 	_currentPos = (_currentPos + 1) % ExecutionLogSize;
 	_pendingLog = false;
 
-	if(_logCount < ExecutionLogSize) {
-		_logCount++;
-	}
+	//Release: the row is written before the count is incremented - the fence keeps the next row's writes after the new count (like a seqlock)
+	_rowCount.store(_rowCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	std::atomic_thread_fence(std::memory_order_release);
 
-	if(_logToFile) {
-		GetTraceRow(_outputBuffer, state.CPU, state.PPU, disassemblyInfo);
-		if(_outputBuffer.size() > 32768) {
-			_outputFile << _outputBuffer;
-			_outputBuffer.clear();
-		}
+	if(settings->Writer) {
+		//Only capture the data needed to format the row, the writer thread formats/writes it
+		TraceLogRecord record;
+		TraceLogFile::CreateRecord(record, state.CPU, state.PPU, disassemblyInfo, _memoryManager.get());
+		settings->Writer->AddRecord(record);
 	}
 }
 
 void TraceLogger::LogNonExec(OperationInfo& operationInfo)
 {
 	if(_pendingLog) {
-		auto lock = _lock.AcquireSafe();
-		if(ConditionMatches(_lastState, _lastDisassemblyInfo, operationInfo)) {
-			AddRow(_lastDisassemblyInfo, _lastState);
+		LogSettings* settings = GetSettings();
+		if(ConditionMatches(settings, _lastState, _lastDisassemblyInfo, operationInfo)) {
+			AddRow(settings, _lastDisassemblyInfo, _lastState);
 		}
 	}
 }
 
 void TraceLogger::Log(DebugState &state, DisassemblyInfo &disassemblyInfo, OperationInfo &operationInfo)
 {
-	auto lock = _lock.AcquireSafe();
-	if(ConditionMatches(state, disassemblyInfo, operationInfo)) {
-		AddRow(disassemblyInfo, state);
+	LogSettings* settings = GetSettings();
+	if(ConditionMatches(settings, state, disassemblyInfo, operationInfo)) {
+		AddRow(settings, disassemblyInfo, state);
 	}
 }
 
 void TraceLogger::Clear()
 {
-	_logCount = 0;
+	_firstRow = _rowCount.load();
 }
 
 const char* TraceLogger::GetExecutionTrace(uint32_t lineCount)
 {
-	int startPos;
+	auto lock = _lock.AcquireSafe();
+	shared_ptr<TraceLogFormatter> formatter = std::atomic_load(&_settings)->Formatter;
+
+	//This is deliberately best-effort, like a seqlock without atomic accesses to the rows: the emulation thread keeps adding rows while
+	//the cache is copied (a benign data race, the UI can't pause the emulation to refresh this view). The rows written during the copy
+	//(and the one being written) are the oldest rows in the cache, so only the rows that are at least that far from the end of the cache
+	//are kept - a row that may have been torn by the copy is never displayed.
+	uint64_t rowCount = _rowCount.load(std::memory_order_acquire);
+	memcpy(_cpuStateCacheCopy, _cpuStateCache, sizeof(_cpuStateCache));
+	memcpy(_ppuStateCacheCopy, _ppuStateCache, sizeof(_ppuStateCache));
+	memcpy(_disassemblyCacheCopy, _disassemblyCache, sizeof(_disassemblyCache));
+	std::atomic_thread_fence(std::memory_order_acquire);
+	uint64_t overwrittenRows = _rowCount.load(std::memory_order_relaxed) - rowCount + 1;
+
+	uint64_t firstRow = _firstRow.load();
+	uint64_t availableRows = rowCount > firstRow ? std::min<uint64_t>(rowCount - firstRow, ExecutionLogSize) : 0;
+	availableRows = std::min<uint64_t>(availableRows, overwrittenRows < ExecutionLogSize ? ExecutionLogSize - overwrittenRows : 0);
+	lineCount = (uint32_t)std::min<uint64_t>(lineCount, availableRows);
+	int startPos = (int)((rowCount - lineCount) % ExecutionLogSize);
 
 	_executionTrace.clear();
-	{
-		auto lock = _lock.AcquireSafe();
-		lineCount = std::min(lineCount, _logCount);
-		memcpy(_cpuStateCacheCopy, _cpuStateCache, sizeof(_cpuStateCache));
-		memcpy(_ppuStateCacheCopy, _ppuStateCache, sizeof(_ppuStateCache));
-		memcpy(_disassemblyCacheCopy, _disassemblyCache, sizeof(_disassemblyCache));
-		startPos = _currentPos + ExecutionLogSize - lineCount;
-	}
-	
 	for(int i = 0; i < (int)lineCount; i++) {
 		int index = (startPos + i) % ExecutionLogSize;
 		_executionTrace += HexUtilities::ToHex(_cpuStateCacheCopy[index].DebugPC) + "\x1";
 		string byteCode;
 		_disassemblyCacheCopy[index].GetByteCode(byteCode);
 		_executionTrace += byteCode + "\x1";
-		GetTraceRow(_executionTrace, _cpuStateCacheCopy[index], _ppuStateCacheCopy[index], _disassemblyCacheCopy[index]);
+
+		TraceLogRecord record;
+		TraceLogFile::CreateRecord(record, _cpuStateCacheCopy[index], _ppuStateCacheCopy[index], _disassemblyCacheCopy[index], _memoryManager.get());
+		formatter->GetTraceRow(_executionTrace, record);
 	}
 
 	return _executionTrace.c_str();
-}
\ No newline at end of file
+}
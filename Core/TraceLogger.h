@@ -4,50 +4,12 @@
 #include "../Utilities/SimpleLock.h"
 #include "DisassemblyInfo.h"
 #include "ExpressionEvaluator.h"
+#include "TraceLogFormatter.h"
 
 class MemoryManager;
 class LabelManager;
 class Debugger;
-
-enum class RowDataType
-{
-	Text = 0,
-	ByteCode,
-	Disassembly,
-	EffectiveAddress,
-	MemoryValue,
-	Align,
-	PC,
-	A,
-	X,
-	Y,
-	SP,
-	PS,
-	Cycle,
-	Scanline,
-	FrameCount,
-	CycleCount
-};
-
-struct RowPart
-{
-	RowDataType DataType;
-	string Text;
-	bool DisplayInHex;
-	int MinWidth;
-};
-
-struct TraceLoggerOptions
-{
-	bool ShowExtraInfo;
-	bool IndentCode;
-	bool UseLabels;
-	bool UseWindowsEol;
-	bool ExtendZeroPage;
-
-	char Condition[1000];
-	char Format[1000];
-};
+class TraceLogWriter;
 
 class TraceLogger
 {
@@ -56,26 +18,35 @@ private:
 
 	//Must be static to be thread-safe when switching game
 	static string _executionTrace;
+
+	//Never modified once published - the setters build a new instance and increment _settingsVersion
+	struct LogSettings
+	{
+		ExpressionData Condition;
+		shared_ptr<TraceLogFormatter> Formatter;
+		shared_ptr<TraceLogWriter> Writer;
+	};
 	
 	TraceLoggerOptions _options;
-	string _outputFilepath;
-	string _outputBuffer;
-	ofstream _outputFile;
 	shared_ptr<MemoryManager> _memoryManager;
 	shared_ptr<LabelManager> _labelManager;
 	
 	shared_ptr<ExpressionEvaluator> _expEvaluator;
-	ExpressionData _conditionData;
 
-	vector<RowPart> _rowParts;
+	//Published by the setters (std::atomic_store), the emulation thread only reads _settingsVersion on each call and reloads _activeSettings when it changes
+	shared_ptr<LogSettings> _settings;
+	atomic<uint32_t> _settingsVersion;
+	shared_ptr<LogSettings> _activeSettings;
+	uint32_t _activeSettingsVersion;
 
 	bool _pendingLog;
 	DebugState _lastState;
 	DisassemblyInfo _lastDisassemblyInfo;
 
-	bool _logToFile;
+	//Rows are added by the emulation thread without locking, GetExecutionTrace discards the rows that may have been overwritten while it copied them
 	uint16_t _currentPos;
-	uint32_t _logCount;
+	atomic<uint64_t> _rowCount;
+	atomic<uint64_t> _firstRow;
 	State _cpuStateCache[ExecutionLogSize] = {};
 	PPUDebugState _ppuStateCache[ExecutionLogSize] = {};
 	DisassemblyInfo _disassemblyCache[ExecutionLogSize];
@@ -84,15 +55,14 @@ private:
 	PPUDebugState _ppuStateCacheCopy[ExecutionLogSize] = {};
 	DisassemblyInfo _disassemblyCacheCopy[ExecutionLogSize];
 
+	//Only used by the setters and GetExecutionTrace
 	SimpleLock _lock;
 	
-	void GetStatusFlag(string &output, uint8_t ps, RowPart& part);
-	void AddRow(DisassemblyInfo &disassemblyInfo, DebugState &state);
-	bool ConditionMatches(DebugState &state, DisassemblyInfo &disassemblyInfo, OperationInfo &operationInfo);
-	
-	void GetTraceRow(string &output, State &cpuState, PPUDebugState &ppuState, DisassemblyInfo &disassemblyInfo);
-	
-	template<typename T> void WriteValue(string &output, T value, RowPart& rowPart);
+	void PublishSettings(shared_ptr<LogSettings> settings);
+	LogSettings* GetSettings();
+
+	void AddRow(LogSettings* settings, DisassemblyInfo &disassemblyInfo, DebugState &state);
+	bool ConditionMatches(LogSettings* settings, DebugState &state, DisassemblyInfo &disassemblyInfo, OperationInfo &operationInfo);
 
 public:
 	TraceLogger(Debugger* debugger, shared_ptr<MemoryManager> memoryManager, shared_ptr<LabelManager> labelManager);
@@ -102,6 +72,8 @@ public:
 	void Clear();
 	void LogNonExec(OperationInfo& operationInfo);
 	void SetOptions(TraceLoggerOptions options);
+
+	//Files with the .mtl extension are logged in binary format (see TraceLogFile), other files are logged as text
 	void StartLogging(string filename);
 	void StopLogging();
 
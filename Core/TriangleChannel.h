@@ -33,6 +33,19 @@ protected:
 		}
 	}
 
+	bool SkipClocks(uint32_t clockCount) override
+	{
+		if(_lengthCounter > 0 && _linearCounter > 0) {
+			if(_period >= 2 || !_console->GetSettings()->CheckFlag(EmulationFlags::SilenceTriangleHighFreq)) {
+				return false;
+			}
+			_sequencePosition = (_sequencePosition + clockCount) & 0x1F;
+		}
+
+		//The sequencer is halted (or silenced), the output doesn't change
+		return true;
+	}
+
 public:
 	TriangleChannel(AudioChannel channel, shared_ptr<Console> console, SoundMixer* mixer) : ApuLengthCounter(channel, console, mixer)
 	{
@@ -85,6 +85,8 @@ protected:
 		SetCpuMemoryMapping(0x6000, 0x7FFF, 0, PrgMemoryType::WorkRam, _wramWriteEnabled ? MemoryAccessType::ReadWrite : MemoryAccessType::Read);
 	}
 	
+	bool AllowPpuBatching() override { return false; }
+
 	virtual uint8_t MapperReadVRAM(uint16_t addr, MemoryOperationType memoryOperationType) override
 	{
 		if(_extAttributesEnabled && memoryOperationType == MemoryOperationType::PpuRenderingRead) {
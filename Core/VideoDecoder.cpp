@@ -17,6 +17,9 @@
 #include "RotateFilter.h"
 #include "DebugHud.h"
 #include "NotificationManager.h"
+#include "VideoFilterBenchmark.h"
+#include "MessageManager.h"
+#include "../Utilities/Timer.h"
 
 VideoDecoder::VideoDecoder(shared_ptr<Console> console)
 {
@@ -34,6 +37,18 @@ VideoDecoder::~VideoDecoder()
 
 FrameInfo VideoDecoder::GetFrameInfo()
 {
+	if(_lastFrameInfo.Width == 0 && !_decodeThread) {
+		//No frame has been decoded yet (e.g headless consoles), calculate the size frames will have with the current filters
+		UpdateVideoFilter();
+		FrameInfo frameInfo = _videoFilter->GetFrameInfo();
+		if(_rotateFilter) {
+			frameInfo = _rotateFilter->GetFrameInfo(frameInfo);
+		}
+		if(_scaleFilter) {
+			frameInfo = _scaleFilter->GetFrameInfo(frameInfo);
+		}
+		return frameInfo;
+	}
 	return _lastFrameInfo;
 }
 
@@ -58,9 +73,69 @@ void VideoDecoder::GetScreenSize(ScreenSize &size, bool ignoreScale)
 	}
 }
 
+VideoFilterType VideoDecoder::GetActiveFilterType()
+{
+	VideoFilterType requestedFilter = _settings->GetVideoFilterType();
+	if(!_settings->IsVideoFilterFallbackEnabled()) {
+		_requestedFilterType = requestedFilter;
+		_fallbackFilterType = requestedFilter;
+		return requestedFilter;
+	}
+
+	if(requestedFilter != _requestedFilterType) {
+		//A new filter was selected, skip the filters that were too slow to decode a frame in time on this machine when they were benchmarked
+		if(!_benchmarkResultsLoaded) {
+			_benchmarkResults = VideoFilterBenchmark::LoadResults();
+			_benchmarkResultsLoaded = true;
+		}
+
+		double framePeriod = 1000.0 / _console->GetFps();
+		VideoFilterType filter = requestedFilter;
+		while(filter != VideoFilterType::None) {
+			auto result = _benchmarkResults.find((int)filter);
+			if(result == _benchmarkResults.end() || result->second <= framePeriod) {
+				break;
+			}
+			filter = VideoFilterBenchmark::GetFallbackFilter(filter);
+		}
+
+		_requestedFilterType = requestedFilter;
+		_fallbackFilterType = filter;
+		_measuredFrameCount = 0;
+		_slowFrameCount = 0;
+	}
+
+	return _fallbackFilterType;
+}
+
+void VideoDecoder::UpdateFilterFallback(double decodeTimeMs)
+{
+	uint32_t emulationSpeed = _settings->GetEmulationSpeed();
+	if(!_settings->IsVideoFilterFallbackEnabled() || emulationSpeed == 0 || _fallbackFilterType == VideoFilterType::None || _hdFilterEnabled) {
+		return;
+	}
+
+	//The emulation thread waits for the previous frame to be decoded before sending a new one, so a frame needs to be decoded within a frame period
+	double framePeriod = 1000.0 / (_console->GetFps() * emulationSpeed / 100);
+	_measuredFrameCount++;
+	if(decodeTimeMs > framePeriod) {
+		_slowFrameCount++;
+	}
+
+	if(_measuredFrameCount >= VideoDecoder::FallbackFrameWindow) {
+		if(_slowFrameCount > VideoDecoder::FallbackFrameWindow / 4) {
+			VideoFilterType fallbackFilter = VideoFilterBenchmark::GetFallbackFilter(_fallbackFilterType);
+			MessageManager::Log("[Video] " + VideoFilterBenchmark::GetFilterName(_fallbackFilterType) + " filter is too slow, switching to: " + VideoFilterBenchmark::GetFilterName(fallbackFilter));
+			_fallbackFilterType = fallbackFilter;
+		}
+		_measuredFrameCount = 0;
+		_slowFrameCount = 0;
+	}
+}
+
 void VideoDecoder::UpdateVideoFilter()
 {
-	VideoFilterType newFilter = _console->GetSettings()->GetVideoFilterType();
+	VideoFilterType newFilter = GetActiveFilterType();
 
 	if(_videoFilterType != newFilter || _videoFilter == nullptr || (_hdScreenInfo && !_hdFilterEnabled) || (!_hdScreenInfo && _hdFilterEnabled)) {
 		_videoFilterType = newFilter;
@@ -70,9 +145,9 @@ void VideoDecoder::UpdateVideoFilter()
 		switch(_videoFilterType) {
 			case VideoFilterType::None: break;
 			case VideoFilterType::NTSC: _videoFilter.reset(new NtscFilter(_console)); break;
-			case VideoFilterType::BisqwitNtsc: _videoFilter.reset(new BisqwitNtscFilter(_console, 1)); break;
-			case VideoFilterType::BisqwitNtscHalfRes: _videoFilter.reset(new BisqwitNtscFilter(_console, 2)); break;
-			case VideoFilterType::BisqwitNtscQuarterRes: _videoFilter.reset(new BisqwitNtscFilter(_console, 4)); break;
+			case VideoFilterType::BisqwitNtsc: _videoFilter.reset(new BisqwitNtscFilter(_console, 1, _console->GetSettings()->GetNtscFilterSettings().ThreadCount)); break;
+			case VideoFilterType::BisqwitNtscHalfRes: _videoFilter.reset(new BisqwitNtscFilter(_console, 2, _console->GetSettings()->GetNtscFilterSettings().ThreadCount)); break;
+			case VideoFilterType::BisqwitNtscQuarterRes: _videoFilter.reset(new BisqwitNtscFilter(_console, 4, _console->GetSettings()->GetNtscFilterSettings().ThreadCount)); break;
 			case VideoFilterType::Raw: _videoFilter.reset(new RawVideoFilter(_console)); break;
 			default: _scaleFilter = ScaleFilter::GetScaleFilter(_videoFilterType); break;
 		}
@@ -93,17 +168,15 @@ void VideoDecoder::UpdateVideoFilter()
 	}
 }
 
-void VideoDecoder::DecodeFrame(bool synchronous)
+uint32_t* VideoDecoder::ApplyFilters(FrameInfo &frameInfo)
 {
-	UpdateVideoFilter();
-
 	if(_hdFilterEnabled) {
 		((HdVideoFilter*)_videoFilter.get())->SetHdScreenTiles(_hdScreenInfo);
 	}
 	_videoFilter->SendFrame(_ppuOutputBuffer, _frameNumber);
 
 	uint32_t* outputBuffer = _videoFilter->GetOutputBuffer();
-	FrameInfo frameInfo = _videoFilter->GetFrameInfo();
+	frameInfo = _videoFilter->GetFrameInfo();
 	_console->GetDebugHud()->Draw(outputBuffer, _videoFilter->GetOverscan(), frameInfo.Width, _frameNumber);
 
 	if(_rotateFilter) {
@@ -120,6 +193,21 @@ void VideoDecoder::DecodeFrame(bool synchronous)
 		_hud->DrawHud(_console, outputBuffer, frameInfo, _videoFilter->GetOverscan());
 	}
 
+	return outputBuffer;
+}
+
+void VideoDecoder::DecodeFrame(bool synchronous)
+{
+	UpdateVideoFilter();
+
+	Timer timer;
+	FrameInfo frameInfo;
+	uint32_t* outputBuffer = ApplyFilters(frameInfo);
+	if(!synchronous) {
+		//Frames decoded on the emulation thread (e.g offline video rendering) never change filters on their own
+		UpdateFilterFallback(timer.GetElapsedMS());
+	}
+
 	ScreenSize screenSize;
 	GetScreenSize(screenSize, true);
 	if(_previousScale != _console->GetSettings()->GetVideoScale() || screenSize.Height != _previousScreenSize.Height || screenSize.Width != _previousScreenSize.Width) {
@@ -136,6 +224,34 @@ void VideoDecoder::DecodeFrame(bool synchronous)
 	_console->GetRewindManager()->SendFrame(outputBuffer, frameInfo.Width, frameInfo.Height, synchronous);
 }
 
+double VideoDecoder::DecodeBenchmarkFrame(uint16_t* ppuOutputBuffer)
+{
+	bool tempHud = !_hud;
+	if(tempHud) {
+		//Headless consoles have no HUD, use one to get the same results as the UI
+		_hud.reset(new VideoHud());
+	}
+
+	uint16_t* previousBuffer = _ppuOutputBuffer;
+	HdScreenInfo* previousHdScreenInfo = _hdScreenInfo;
+	_ppuOutputBuffer = ppuOutputBuffer;
+	_hdScreenInfo = nullptr;
+
+	UpdateVideoFilter();
+
+	Timer timer;
+	FrameInfo frameInfo;
+	ApplyFilters(frameInfo);
+	double elapsedMs = timer.GetElapsedMS();
+
+	_ppuOutputBuffer = previousBuffer;
+	_hdScreenInfo = previousHdScreenInfo;
+	if(tempHud) {
+		_hud.reset();
+	}
+	return elapsedMs;
+}
+
 void VideoDecoder::DecodeThread()
 {
 	//This thread will decode the PPU's output (color ID to RGB, intensify r/g/b and produce a HD version of the frame if needed)
@@ -184,6 +300,14 @@ void VideoDecoder::UpdateFrame(void *ppuOutputBuffer, HdScreenInfo *hdScreenInfo
 		return;
 	}
 
+	if(_settings->CheckFlag(EmulationFlags::HeadlessMode)) {
+		//Headless consoles only decode frames when they are recorded to a video (offline rendering), on the emulation thread
+		if(_console->GetVideoRenderer()->IsRecording()) {
+			UpdateFrameSync(ppuOutputBuffer, hdScreenInfo);
+		}
+		return;
+	}
+
 	if(_frameChanged) {
 		//Last frame isn't done decoding yet - sometimes Signal() introduces a 25-30ms delay
 		while(_frameChanged) {
@@ -204,6 +328,11 @@ void VideoDecoder::UpdateFrame(void *ppuOutputBuffer, HdScreenInfo *hdScreenInfo
 void VideoDecoder::StartThread()
 {
 #ifndef LIBRETRO
+	if(_settings->CheckFlag(EmulationFlags::HeadlessMode)) {
+		//Headless consoles (e.g batch runner) never display anything, skip decoding entirely
+		return;
+	}
+
 	if(!_decodeThread) {	
 		_stopFlag = false;
 		_frameChanged = false;
@@ -44,22 +44,39 @@ private:
 
 	ScreenSize _previousScreenSize = {};
 	double _previousScale = 0;
-	FrameInfo _lastFrameInfo;
+	FrameInfo _lastFrameInfo = {};
 
 	VideoFilterType _videoFilterType = VideoFilterType::None;
 	unique_ptr<BaseVideoFilter> _videoFilter;
 	shared_ptr<ScaleFilter> _scaleFilter;
 	shared_ptr<RotateFilter> _rotateFilter;
 
+	//Automatic fallback to a faster filter when the selected one takes longer than a frame to decode
+	VideoFilterType _requestedFilterType = VideoFilterType::None;
+	VideoFilterType _fallbackFilterType = VideoFilterType::None;
+	uint32_t _measuredFrameCount = 0;
+	uint32_t _slowFrameCount = 0;
+	bool _benchmarkResultsLoaded = false;
+	std::unordered_map<int, double> _benchmarkResults;
+
+	VideoFilterType GetActiveFilterType();
+	void UpdateFilterFallback(double decodeTimeMs);
 	void UpdateVideoFilter();
+	uint32_t* ApplyFilters(FrameInfo &frameInfo);
 
 	void DecodeThread();
 
 public:
+	//Number of frames over which the decode time is measured, before falling back to a faster filter
+	static constexpr uint32_t FallbackFrameWindow = 60;
+
 	VideoDecoder(shared_ptr<Console> console);
 	~VideoDecoder();
 
 	void DecodeFrame(bool synchronous = false);
+
+	//Decodes a frame without displaying it, and returns the time spent in the filters (ms) - used by VideoFilterBenchmark, when the decode thread isn't running
+	double DecodeBenchmarkFrame(uint16_t* ppuOutputBuffer);
 	void TakeScreenshot();
 	void TakeScreenshot(std::stringstream &stream, bool rawScreenshot = false);
 
@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include <algorithm>
+#include "VideoFilterBenchmark.h"
+#include "VideoDecoder.h"
+#include "Console.h"
+#include "../Utilities/FolderUtilities.h"
+#include "../Utilities/PlatformUtilities.h"
+
+vector<VideoFilterType> VideoFilterBenchmark::GetFilterTypes()
+{
+	return {
+		VideoFilterType::None, VideoFilterType::Raw, VideoFilterType::NTSC,
+		VideoFilterType::BisqwitNtscQuarterRes, VideoFilterType::BisqwitNtscHalfRes, VideoFilterType::BisqwitNtsc,
+		VideoFilterType::xBRZ2x, VideoFilterType::xBRZ3x, VideoFilterType::xBRZ4x, VideoFilterType::xBRZ5x, VideoFilterType::xBRZ6x,
+		VideoFilterType::HQ2x, VideoFilterType::HQ3x, VideoFilterType::HQ4x,
+		VideoFilterType::Scale2x, VideoFilterType::Scale3x, VideoFilterType::Scale4x,
+		VideoFilterType::_2xSai, VideoFilterType::Super2xSai, VideoFilterType::SuperEagle,
+		VideoFilterType::Prescale2x, VideoFilterType::Prescale3x, VideoFilterType::Prescale4x,
+		VideoFilterType::Prescale6x, VideoFilterType::Prescale8x, VideoFilterType::Prescale10x
+	};
+}
+
+string VideoFilterBenchmark::GetFilterName(VideoFilterType filter)
+{
+	switch(filter) {
+		case VideoFilterType::None: return "None";
+		case VideoFilterType::NTSC: return "NTSC";
+		case VideoFilterType::BisqwitNtscQuarterRes: return "BisqwitNtscQuarterRes";
+		case VideoFilterType::BisqwitNtscHalfRes: return "BisqwitNtscHalfRes";
+		case VideoFilterType::BisqwitNtsc: return "BisqwitNtsc";
+		case VideoFilterType::xBRZ2x: return "xBRZ2x";
+		case VideoFilterType::xBRZ3x: return "xBRZ3x";
+		case VideoFilterType::xBRZ4x: return "xBRZ4x";
+		case VideoFilterType::xBRZ5x: return "xBRZ5x";
+		case VideoFilterType::xBRZ6x: return "xBRZ6x";
+		case VideoFilterType::HQ2x: return "HQ2x";
+		case VideoFilterType::HQ3x: return "HQ3x";
+		case VideoFilterType::HQ4x: return "HQ4x";
+		case VideoFilterType::Scale2x: return "Scale2x";
+		case VideoFilterType::Scale3x: return "Scale3x";
+		case VideoFilterType::Scale4x: return "Scale4x";
+		case VideoFilterType::_2xSai: return "2xSai";
+		case VideoFilterType::Super2xSai: return "Super2xSai";
+		case VideoFilterType::SuperEagle: return "SuperEagle";
+		case VideoFilterType::Prescale2x: return "Prescale2x";
+		case VideoFilterType::Prescale3x: return "Prescale3x";
+		case VideoFilterType::Prescale4x: return "Prescale4x";
+		case VideoFilterType::Prescale6x: return "Prescale6x";
+		case VideoFilterType::Prescale8x: return "Prescale8x";
+		case VideoFilterType::Prescale10x: return "Prescale10x";
+		case VideoFilterType::Raw: return "Raw";
+		case VideoFilterType::HdPack: return "HdPack";
+	}
+	return "";
+}
+
+VideoFilterType VideoFilterBenchmark::GetFallbackFilter(VideoFilterType filter)
+{
+	switch(filter) {
+		case VideoFilterType::BisqwitNtsc: return VideoFilterType::BisqwitNtscHalfRes;
+		case VideoFilterType::BisqwitNtscHalfRes: return VideoFilterType::BisqwitNtscQuarterRes;
+		case VideoFilterType::BisqwitNtscQuarterRes: return VideoFilterType::NTSC;
+
+		case VideoFilterType::xBRZ6x: return VideoFilterType::xBRZ5x;
+		case VideoFilterType::xBRZ5x: return VideoFilterType::xBRZ4x;
+		case VideoFilterType::xBRZ4x: return VideoFilterType::xBRZ3x;
+		case VideoFilterType::xBRZ3x: return VideoFilterType::xBRZ2x;
+
+		case VideoFilterType::HQ4x: return VideoFilterType::HQ3x;
+		case VideoFilterType::HQ3x: return VideoFilterType::HQ2x;
+
+		case VideoFilterType::Scale4x: return VideoFilterType::Scale3x;
+		case VideoFilterType::Scale3x: return VideoFilterType::Scale2x;
+
+		case VideoFilterType::Super2xSai: return VideoFilterType::_2xSai;
+		case VideoFilterType::SuperEagle: return VideoFilterType::_2xSai;
+
+		case VideoFilterType::Prescale10x: return VideoFilterType::Prescale8x;
+		case VideoFilterType::Prescale8x: return VideoFilterType::Prescale6x;
+		case VideoFilterType::Prescale6x: return VideoFilterType::Prescale4x;
+		case VideoFilterType::Prescale4x: return VideoFilterType::Prescale3x;
+		case VideoFilterType::Prescale3x: return VideoFilterType::Prescale2x;
+
+		default: return VideoFilterType::None;
+	}
+}
+
+vector<VideoFilterTiming> VideoFilterBenchmark::Run(shared_ptr<Console> console, vector<vector<uint16_t>> &frames)
+{
+	vector<VideoFilterTiming> results;
+	if(frames.empty()) {
+		return results;
+	}
+
+	EmulationSettings* settings = console->GetSettings();
+	shared_ptr<VideoDecoder> decoder = console->GetVideoDecoder();
+	VideoFilterType originalFilter = settings->GetVideoFilterType();
+
+	for(VideoFilterType filter : GetFilterTypes()) {
+		settings->SetVideoFilterType(filter);
+
+		//Warm-up pass - filters initialize some of their lookup tables, buffers and worker threads on first use (some only once a frame has actual content)
+		for(vector<uint16_t> &frame : frames) {
+			decoder->DecodeBenchmarkFrame(frame.data());
+		}
+
+		VideoFilterTiming timing;
+		timing.Filter = filter;
+		double totalMs = 0;
+		for(vector<uint16_t> &frame : frames) {
+			double elapsedMs = decoder->DecodeBenchmarkFrame(frame.data());
+			totalMs += elapsedMs;
+			timing.MaxMs = std::max(timing.MaxMs, elapsedMs);
+		}
+		timing.AverageMs = totalMs / frames.size();
+		results.push_back(timing);
+	}
+
+	settings->SetVideoFilterType(originalFilter);
+	return results;
+}
+
+string VideoFilterBenchmark::GetResultsFile()
+{
+	//The results depend on the machine's hardware, keep them separate when the home folder is shared between machines (e.g portable mode)
+	string machineName = PlatformUtilities::GetMachineName();
+	for(char &c : machineName) {
+		if(!isalnum((uint8_t)c) && c != '-') {
+			c = '_';
+		}
+	}
+	return FolderUtilities::CombinePath(FolderUtilities::GetHomeFolder(), "VideoFilterBenchmark" + (machineName.empty() ? "" : "_" + machineName) + ".txt");
+}
+
+void VideoFilterBenchmark::SaveResults(vector<VideoFilterTiming> &results)
+{
+	ofstream file(GetResultsFile(), ios::out);
+	if(file) {
+		file << "#Filter, name, average and max decode time per frame (ms)" << std::endl;
+		for(VideoFilterTiming &timing : results) {
+			file << (int)timing.Filter << " " << GetFilterName(timing.Filter) << " " << timing.AverageMs << " " << timing.MaxMs << std::endl;
+		}
+	}
+}
+
+std::unordered_map<int, double> VideoFilterBenchmark::LoadResults()
+{
+	std::unordered_map<int, double> results;
+	ifstream file(GetResultsFile(), ios::in);
+	string line;
+	while(std::getline(file, line)) {
+		if(line.empty() || line[0] == '#') {
+			continue;
+		}
+
+		stringstream lineStream(line);
+		int filter;
+		string name;
+		double averageMs;
+		if(lineStream >> filter >> name >> averageMs) {
+			results[filter] = averageMs;
+		}
+	}
+	return results;
+}
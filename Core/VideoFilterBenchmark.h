@@ -0,0 +1,38 @@
+#pragma once
+#include "stdafx.h"
+#include <unordered_map>
+#include "EmulationSettings.h"
+
+class Console;
+
+struct VideoFilterTiming
+{
+	VideoFilterType Filter = VideoFilterType::None;
+
+	//Time spent decoding a frame (filter, rotation, HUD and scaling), in milliseconds
+	double AverageMs = 0;
+	double MaxMs = 0;
+};
+
+class VideoFilterBenchmark
+{
+private:
+	static string GetResultsFile();
+
+public:
+	//Every filter, except HD packs (which depend on the game)
+	static vector<VideoFilterType> GetFilterTypes();
+	static string GetFilterName(VideoFilterType filter);
+
+	//Returns the next filter of the same family, by decreasing quality (e.g xBRZ 4x -> xBRZ 3x)
+	//Returns VideoFilterType::None at the end of the chain (and for None itself)
+	static VideoFilterType GetFallbackFilter(VideoFilterType filter);
+
+	//Decodes the frames (PPU output buffers) with each filter, using the console's rotation/picture settings and the HUD, and measures the time spent per frame
+	//The console must not be running (e.g a headless console, between frames)
+	static vector<VideoFilterTiming> Run(shared_ptr<Console> console, vector<vector<uint16_t>> &frames);
+
+	//The results are stored in the home folder, in a file specific to the current machine
+	static void SaveResults(vector<VideoFilterTiming> &results);
+	static std::unordered_map<int, double> LoadResults();
+};
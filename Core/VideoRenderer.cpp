@@ -89,11 +89,14 @@ void VideoRenderer::StartRecording(string filename, VideoCodec codec, uint32_t c
 {
 	FrameInfo frameInfo = _console->GetVideoDecoder()->GetFrameInfo();
 	
+	//Headless consoles render videos offline, as fast as the encoders can go - frames are never dropped
+	bool allowFrameDrops = !_console->GetSettings()->CheckFlag(EmulationFlags::HeadlessMode);
+
 	shared_ptr<IVideoRecorder> recorder;
 	if(codec == VideoCodec::GIF) {
-		recorder.reset(new GifRecorder());
+		recorder.reset(new GifRecorder(allowFrameDrops));
 	} else {
-		recorder.reset(new AviRecorder(codec, compressionLevel));
+		recorder.reset(new AviRecorder(codec, compressionLevel, allowFrameDrops));
 	}
 
 	if(recorder->StartRecording(filename, frameInfo.Width, frameInfo.Height, frameInfo.BitsPerPixel, _console->GetSettings()->GetSampleRate(), _console->GetFps())) {
@@ -110,16 +113,36 @@ void VideoRenderer::AddRecordingSound(int16_t* soundBuffer, uint32_t sampleCount
 	}
 }
 
-void VideoRenderer::StopRecording()
+VideoRecorderStats VideoRenderer::StopRecording()
 {
+	VideoRecorderStats stats = {};
 	shared_ptr<IVideoRecorder> recorder = _recorder;
 	if(recorder) {
 		MessageManager::DisplayMessage("VideoRecorder", "VideoRecorderStopped", recorder->GetOutputFile());
 	}
 	_recorder.reset();
+
+	if(recorder) {
+		//Stop the recorder first, to include the frames that were still being encoded
+		recorder->StopRecording();
+		stats = recorder->GetStats();
+		if(stats.DroppedFrames > 0) {
+			MessageManager::Log("[Video] Recording ended: " + std::to_string(stats.WrittenFrames) + " frames written, " + std::to_string(stats.DroppedFrames) + " frames dropped (encoder too slow)");
+		}
+	}
+	return stats;
 }
 
 bool VideoRenderer::IsRecording()
 {
 	return _recorder != nullptr && _recorder->IsRecording();
+}
+
+VideoRecorderStats VideoRenderer::GetRecordingStats()
+{
+	shared_ptr<IVideoRecorder> recorder = _recorder;
+	if(recorder) {
+		return recorder->GetStats();
+	}
+	return {};
 }
\ No newline at end of file
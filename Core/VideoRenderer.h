@@ -37,6 +37,7 @@ public:
 
 	void StartRecording(string filename, VideoCodec codec, uint32_t compressionLevel);
 	void AddRecordingSound(int16_t* soundBuffer, uint32_t sampleCount, uint32_t sampleRate);
-	void StopRecording();
+	VideoRecorderStats StopRecording();
 	bool IsRecording();
+	VideoRecorderStats GetRecordingStats();
 };
\ No newline at end of file
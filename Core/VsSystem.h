@@ -74,6 +74,8 @@ protected:
 		Stream(_prgChrSelectBit);
 	}
 
+	bool AllowPpuBatching() override { return false; }
+
 	void ProcessCpuClock() override
 	{
 		VsControlManager* controlManager = dynamic_cast<VsControlManager*>(_console->GetControlManager());
@@ -81,6 +81,7 @@ namespace Mesen.GUI.Config
 		public bool ConfirmExitResetPower = false;
 
 		public UInt32 RewindBufferSize = 300;
+		public UInt32 RewindMemoryLimit = 256;
 
 		public bool OverrideGameFolder = false;
 		public bool OverrideAviFolder = false;
@@ -218,6 +219,7 @@ namespace Mesen.GUI.Config
 			}
 
 			InteropEmu.SetRewindBufferSize(preferenceInfo.RewindBufferSize);
+			InteropEmu.SetRewindMemoryLimit(preferenceInfo.RewindMemoryLimit);
 
 			InteropEmu.SetFolderOverrides(ConfigManager.SaveFolder, ConfigManager.SaveStateFolder, ConfigManager.ScreenshotFolder);
 		}
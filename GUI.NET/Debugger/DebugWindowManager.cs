@@ -53,6 +53,7 @@ namespace Mesen.GUI.Debugger
 
 				_openedWindows.Add(frm);
 				frm.FormClosed += Debugger_FormClosed;
+				UpdateDebuggerFeatures();
 				frm.Show();
 				return frm;
 			}
@@ -64,6 +65,7 @@ namespace Mesen.GUI.Debugger
 			frm.Icon = Properties.Resources.Chip;
 			_openedWindows.Add(frm);
 			frm.FormClosed += Debugger_FormClosed;
+			UpdateDebuggerFeatures();
 			frm.Show();
 		}
 
@@ -75,6 +77,7 @@ namespace Mesen.GUI.Debugger
 				frm.Icon = Properties.Resources.CheatCode;
 				frm.FormClosed += Debugger_FormClosed;
 				_openedWindows.Add(frm);
+				UpdateDebuggerFeatures();
 			} else {
 				if(frm.WindowState == FormWindowState.Minimized) {
 					//Unminimize window if it was minimized
@@ -104,6 +107,7 @@ namespace Mesen.GUI.Debugger
 			frm.Icon = Properties.Resources.Video;
 			_openedWindows.Add(frm);
 			frm.FormClosed += Debugger_FormClosed;
+			UpdateDebuggerFeatures();
 			frm.Show();
 			return frm;
 		}
@@ -114,6 +118,7 @@ namespace Mesen.GUI.Debugger
 			frm.Icon = Properties.Resources.Script;
 			_openedWindows.Add(frm);
 			frm.FormClosed += Debugger_FormClosed;
+			UpdateDebuggerFeatures();
 			frm.Show();
 			return frm;
 		}
@@ -168,7 +173,43 @@ namespace Mesen.GUI.Debugger
 				DebugWorkspaceManager.SaveWorkspace();
 				DebugWorkspaceManager.Clear();
 				InteropEmu.DebugRelease();
+			} else {
+				UpdateDebuggerFeatures();
+			}
+		}
+
+		private static void UpdateDebuggerFeatures()
+		{
+			//Only the debugger features used by the opened windows need to process memory accesses
+			DebuggerFeatures features = DebuggerFeatures.None;
+			foreach(Form frm in _openedWindows) {
+				features |= GetRequiredFeatures(frm);
+			}
+			InteropEmu.DebugSetEnabledFeatures(features);
+		}
+
+		private static DebuggerFeatures GetRequiredFeatures(Form frm)
+		{
+			if(frm is frmDebugger) {
+				return DebuggerFeatures.All;
+			} else if(frm is frmMemoryViewer) {
+				//Breakpoints can be set (and are highlighted) in the hex editor
+				return DebuggerFeatures.CodeDataLogger | DebuggerFeatures.MemoryAccessCounter | DebuggerFeatures.Breakpoints;
+			} else if(frm is frmPpuViewer) {
+				//Used to highlight the CHR data that was drawn/read
+				return DebuggerFeatures.CodeDataLogger;
+			} else if(frm is frmTraceLogger) {
+				return DebuggerFeatures.TraceLogger;
+			} else if(frm is frmScript) {
+				//Scripts can read the access counters
+				return DebuggerFeatures.Scripts | DebuggerFeatures.MemoryAccessCounter;
+			} else if(frm is frmProfiler) {
+				return DebuggerFeatures.Profiler;
+			} else if(frm is frmEventViewer) {
+				//Marked breakpoints are displayed in the event viewer
+				return DebuggerFeatures.EventViewer | DebuggerFeatures.Breakpoints;
 			}
+			return DebuggerFeatures.None;
 		}
 
 		private static void Debugger_FormClosed(object sender, FormClosedEventArgs e)
@@ -207,6 +207,7 @@ namespace Mesen.GUI.Debugger
 			this.autoLoadsaveCDLFileToolStripMenuItem = new System.Windows.Forms.ToolStripMenuItem();
 			this.toolStripMenuItem4 = new System.Windows.Forms.ToolStripSeparator();
 			this.mnuLoadCdlFile = new System.Windows.Forms.ToolStripMenuItem();
+			this.mnuMergeCdlFile = new System.Windows.Forms.ToolStripMenuItem();
 			this.mnuSaveAsCdlFile = new System.Windows.Forms.ToolStripMenuItem();
 			this.mnuResetCdlLog = new System.Windows.Forms.ToolStripMenuItem();
 			this.toolStripMenuItem5 = new System.Windows.Forms.ToolStripSeparator();
@@ -1826,6 +1827,7 @@ namespace Mesen.GUI.Debugger
             this.autoLoadsaveCDLFileToolStripMenuItem,
             this.toolStripMenuItem4,
             this.mnuLoadCdlFile,
+            this.mnuMergeCdlFile,
             this.mnuSaveAsCdlFile,
             this.mnuResetCdlLog,
             this.toolStripMenuItem5,
@@ -1856,6 +1858,13 @@ namespace Mesen.GUI.Debugger
 			this.mnuLoadCdlFile.Text = "Load CDL file...";
 			this.mnuLoadCdlFile.Click += new System.EventHandler(this.mnuLoadCdlFile_Click);
 			// 
+			// mnuMergeCdlFile
+			// 
+			this.mnuMergeCdlFile.Name = "mnuMergeCdlFile";
+			this.mnuMergeCdlFile.Size = new System.Drawing.Size(193, 22);
+			this.mnuMergeCdlFile.Text = "Merge CDL file...";
+			this.mnuMergeCdlFile.Click += new System.EventHandler(this.mnuMergeCdlFile_Click);
+			// 
 			// mnuSaveAsCdlFile
 			// 
 			this.mnuSaveAsCdlFile.Image = global::Mesen.GUI.Properties.Resources.Floppy;
@@ -2089,6 +2098,7 @@ namespace Mesen.GUI.Debugger
 		private System.Windows.Forms.ToolStripMenuItem autoLoadsaveCDLFileToolStripMenuItem;
 		private System.Windows.Forms.ToolStripSeparator toolStripMenuItem4;
 		private System.Windows.Forms.ToolStripMenuItem mnuLoadCdlFile;
+		private System.Windows.Forms.ToolStripMenuItem mnuMergeCdlFile;
 		private System.Windows.Forms.ToolStripMenuItem mnuSaveAsCdlFile;
 		private System.Windows.Forms.ToolStripMenuItem mnuResetCdlLog;
 		private System.Windows.Forms.ToolStripMenuItem mnuCdlGenerateRom;
@@ -1009,6 +1009,17 @@ namespace Mesen.GUI.Debugger
 			}
 		}
 
+		private void mnuMergeCdlFile_Click(object sender, EventArgs e)
+		{
+			OpenFileDialog ofd = new OpenFileDialog();
+			ofd.SetFilter("CDL files (*.cdl)|*.cdl");
+			if(ofd.ShowDialog() == System.Windows.Forms.DialogResult.OK) {
+				if(!InteropEmu.DebugMergeCdlFile(ofd.FileName)) {
+					MessageBox.Show("Could not merge CDL file.  The file selected file is invalid.", "Error", MessageBoxButtons.OK, MessageBoxIcon.Error);
+				}
+			}
+		}
+
 		private void mnuSaveAsCdlFile_Click(object sender, EventArgs e)
 		{
 			SaveFileDialog sfd = new SaveFileDialog();
@@ -219,6 +219,7 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern UInt32 GetEmulationSpeed();
 		[DllImport(DLLPath)] public static extern void SetTurboRewindSpeed(UInt32 turboSpeed, UInt32 rewindSpeed);
 		[DllImport(DLLPath)] public static extern void SetRewindBufferSize(UInt32 seconds);
+		[DllImport(DLLPath)] public static extern void SetRewindMemoryLimit(UInt32 megabytes);
 		[DllImport(DLLPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool IsRewinding();
 		[DllImport(DLLPath)] public static extern void SetPpuNmiConfig(UInt32 extraScanlinesBeforeNmi, UInt32 extraScanlineAfterNmi);
 		[DllImport(DLLPath)] public static extern void SetOverscanDimensions(UInt32 left, UInt32 right, UInt32 top, UInt32 bottom);
@@ -227,10 +228,12 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern void SetExclusiveRefreshRate(UInt32 refreshRate);
 		[DllImport(DLLPath)] public static extern void SetVideoAspectRatio(VideoAspectRatio aspectRatio, double customRatio);
 		[DllImport(DLLPath)] public static extern void SetVideoFilter(VideoFilterType filter);
+		[DllImport(DLLPath)] public static extern void SetVideoFilterFallback([MarshalAs(UnmanagedType.I1)]bool enabled);
 		[DllImport(DLLPath)] public static extern void SetVideoResizeFilter(VideoResizeFilter filter);
 		[DllImport(DLLPath)] public static extern void SetRgbPalette(byte[] palette, UInt32 paletteSize);
 		[DllImport(DLLPath)] public static extern void SetPictureSettings(double brightness, double contrast, double saturation, double hue, double scanlineIntensity);
 		[DllImport(DLLPath)] public static extern void SetNtscFilterSettings(double artifacts, double bleed, double fringing, double gamma, double resolution, double sharpness, [MarshalAs(UnmanagedType.I1)]bool mergeFields, double yFilterLength, double iFilterLength, double qFilterLength, [MarshalAs(UnmanagedType.I1)]bool verticalBlend);
+		[DllImport(DLLPath)] public static extern void SetNtscFilterThreadCount(Int32 threadCount);
 		[DllImport(DLLPath)] public static extern void SetInputDisplaySettings(byte visiblePorts, InputDisplayPosition displayPosition, [MarshalAs(UnmanagedType.I1)]bool displayHorizontally);
 		[DllImport(DLLPath)] public static extern void SetAutoSaveOptions(UInt32 delayInMinutes, [MarshalAs(UnmanagedType.I1)]bool showMessage);
 		[DllImport(DLLPath)] public static extern void SetPauseScreenMessage([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(UTF8Marshaler))]string message);
@@ -247,6 +250,7 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool DebugIsDebuggerRunning();
 		[DllImport(DLLPath)] public static extern void DebugRelease();
 		[DllImport(DLLPath)] public static extern void DebugSetFlags(DebuggerFlags flags);
+		[DllImport(DLLPath)] public static extern void DebugSetEnabledFeatures(DebuggerFeatures features);
 		[DllImport(DLLPath)] public static extern void DebugGetState(ref DebugState state);
 		[DllImport(DLLPath)] public static extern void DebugGetApuState(ref ApuState state);
 		[DllImport(DLLPath)] public static extern void DebugGetInstructionProgress(ref InstructionProgress progress);
@@ -332,6 +336,7 @@ namespace Mesen.GUI
 		[DllImport(DLLPath)] public static extern void DebugMarkPrgBytesAs(UInt32 start, UInt32 end, CdlPrgFlags type);
 		[DllImport(DLLPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool DebugLoadCdlFile([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(UTF8Marshaler))]string cdlFilepath);
 		[DllImport(DLLPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool DebugSaveCdlFile([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(UTF8Marshaler))]string cdlFilepath);
+		[DllImport(DLLPath)] [return: MarshalAs(UnmanagedType.I1)] public static extern bool DebugMergeCdlFile([MarshalAs(UnmanagedType.CustomMarshaler, MarshalTypeRef = typeof(UTF8Marshaler))]string cdlFilepath);
 		[DllImport(DLLPath)] public static extern void DebugGetCdlRatios(ref CdlRatios ratios);
 		[DllImport(DLLPath)] public static extern void DebugResetCdlLog();
 		[DllImport(DLLPath)] public static extern void DebugResetMemoryAccessCounts();
@@ -1696,6 +1701,9 @@ namespace Mesen.GUI
 
 		RandomizeCpuPpuAlignment = 0x800000000000000,
 
+		HeadlessMode = 0x1000000000000000,
+		BatchPpuRendering = 0x2000000000000000,
+
 		ForceMaxSpeed = 0x4000000000000000,
 		ConsoleMode = 0x8000000000000000,
 	}
@@ -1733,6 +1741,21 @@ namespace Mesen.GUI
 		BreakOnBusConflict = 0x40000,
 	}
 
+	[Flags]
+	public enum DebuggerFeatures
+	{
+		None = 0x00,
+		CodeDataLogger = 0x01,
+		MemoryAccessCounter = 0x02,
+		Breakpoints = 0x04,
+		TraceLogger = 0x08,
+		Scripts = 0x10,
+		Profiler = 0x20,
+		EventViewer = 0x40,
+
+		All = 0x7F
+	}
+
 	public struct InteropRomInfo
 	{
 		public IntPtr RomNamePointer;
@@ -48,6 +48,7 @@ extern "C"
 	}
 
 	DllExport void __stdcall DebugSetFlags(uint32_t flags) { GetDebugger()->SetFlags(flags); }
+	DllExport void __stdcall DebugSetEnabledFeatures(uint32_t features) { GetDebugger()->SetEnabledFeatures(features); }
 
 	DllExport void __stdcall DebugGetState(DebugState *state) { GetDebugger()->GetState(state); }
 	DllExport void __stdcall DebugSetState(DebugState state) { GetDebugger()->SetState(state); }
@@ -94,7 +95,8 @@ extern "C"
 	DllExport void __stdcall DebugGetPpuAbsoluteAddressAndType(uint32_t relativeAddr, PpuAddressTypeInfo* info) { return GetDebugger()->GetPpuAbsoluteAddressAndType(relativeAddr, info); }
 
 	DllExport bool __stdcall DebugLoadCdlFile(char* cdlFilepath) { return GetDebugger()->LoadCdlFile(cdlFilepath); }
-	DllExport bool __stdcall DebugSaveCdlFile(char* cdlFilepath) { return GetDebugger()->GetCodeDataLogger()->SaveCdlFile(cdlFilepath); }
+	DllExport bool __stdcall DebugSaveCdlFile(char* cdlFilepath) { return GetDebugger()->SaveCdlFile(cdlFilepath); }
+	DllExport bool __stdcall DebugMergeCdlFile(char* cdlFilepath) { return GetDebugger()->MergeCdlFile(cdlFilepath); }
 	DllExport void __stdcall DebugGetCdlRatios(CdlRatios* cdlRatios) { *cdlRatios = GetDebugger()->GetCodeDataLogger()->GetRatios(); }
 	DllExport void __stdcall DebugResetCdlLog() { GetDebugger()->ResetCdl(); }
 	DllExport void __stdcall DebugSetCdlData(uint8_t* cdlData, uint32_t length) { GetDebugger()->SetCdlData(cdlData, length); }
@@ -22,7 +22,13 @@ void SdlSoundManager::FillAudioBuffer(void *userData, uint8_t *stream, int len)
 {
 	SdlSoundManager* soundManager = (SdlSoundManager*)userData;
 
-	soundManager->ReadFromBuffer(stream, len);
+	//Runs on SDL's audio thread - never blocks, underruns are filled with silence
+	soundManager->_buffer.Read((int16_t*)stream, len / soundManager->GetFrameSize());
+}
+
+uint32_t SdlSoundManager::GetFrameSize()
+{
+	return (SoundMixer::BitsPerSample / 8) * (_isStereo ? 2 : 1);
 }
 
 void SdlSoundManager::Release()
@@ -30,12 +36,7 @@ void SdlSoundManager::Release()
 	if(_audioDeviceID != 0) {
 		Stop();
 		SDL_CloseAudioDevice(_audioDeviceID);
-	}
-
-	if(_buffer) {
-		delete[] _buffer;
-		_buffer = nullptr;
-		_bufferSize = 0;
+		_audioDeviceID = 0;
 	}
 }
 
@@ -52,18 +53,21 @@ bool SdlSoundManager::InitializeAudio(uint32_t sampleRate, bool isStereo)
 	_isStereo = isStereo;
 	_previousLatency = _console->GetSettings()->GetAudioLatency();
 
-	int bytesPerSample = 2 * (isStereo ? 2 : 1);
-	int32_t requestedByteLatency = (int32_t)((float)(sampleRate * _console->GetSettings()->GetAudioLatency()) / 1000.0f * bytesPerSample);
-	_bufferSize = (int32_t)std::ceil((double)requestedByteLatency * 2 / 0x10000) * 0x10000;
-	_buffer = new uint8_t[_bufferSize];
-	memset(_buffer, 0, _bufferSize);
+	_latencyFrames = std::max(1u, sampleRate * _previousLatency / 1000);
+
+	//SDL requests a full period of samples at once: use the largest period that fits in the requested latency
+	//(up to 1024 samples), so the latency can be set as low as a single period
+	uint16_t period = 64;
+	while(period < 1024 && period * 2u <= _latencyFrames) {
+		period *= 2;
+	}
 
 	SDL_AudioSpec audioSpec;
 	SDL_memset(&audioSpec, 0, sizeof(audioSpec));
 	audioSpec.freq = sampleRate;
 	audioSpec.format = AUDIO_S16SYS; //16-bit samples
 	audioSpec.channels = isStereo ? 2 : 1;
-	audioSpec.samples = 1024;
+	audioSpec.samples = period;
 	audioSpec.callback = &SdlSoundManager::FillAudioBuffer;
 	audioSpec.userdata = this;
 
@@ -75,8 +79,11 @@ bool SdlSoundManager::InitializeAudio(uint32_t sampleRate, bool isStereo)
 		_audioDeviceID = SDL_OpenAudioDevice(nullptr, isCapture, &audioSpec, &obtainedSpec, 0);
 	}
 
-	_writePosition = 0;
-	_readPosition = 0;
+	_periodFrames = _audioDeviceID != 0 ? obtainedSpec.samples : period;
+
+	//Room for twice the requested latency, and at least 2 periods on top of it
+	_buffer.Reset(std::max(_latencyFrames * 2, _latencyFrames + _periodFrames * 2), isStereo ? 2 : 1);
+	_bufferSize = _buffer.GetCapacity() * GetFrameSize();
 
 	_needReset = false;
 
@@ -117,36 +124,6 @@ void SdlSoundManager::SetAudioDevice(string deviceName)
 	}
 }
 
-void SdlSoundManager::ReadFromBuffer(uint8_t* output, uint32_t len)
-{
-	if(_readPosition + len < _bufferSize) {
-		memcpy(output, _buffer+_readPosition, len);
-		_readPosition += len;
-	} else {
-		int remainingBytes = (_bufferSize - _readPosition);
-		memcpy(output, _buffer+_readPosition, remainingBytes);
-		memcpy(output+remainingBytes, _buffer, len - remainingBytes);
-		_readPosition = len - remainingBytes;
-	}
-
-	if(_readPosition >= _writePosition && _readPosition - _writePosition < _bufferSize / 2) {
-		_bufferUnderrunEventCount++;
-	}
-}
-
-void SdlSoundManager::WriteToBuffer(uint8_t* input, uint32_t len)
-{
-	if(_writePosition + len < _bufferSize) {
-		memcpy(_buffer+_writePosition, input, len);
-		_writePosition += len;
-	} else {
-		int remainingBytes = _bufferSize - _writePosition;
-		memcpy(_buffer+_writePosition, input, remainingBytes);
-		memcpy(_buffer, ((uint8_t*)input)+remainingBytes, len - remainingBytes);
-		_writePosition = len - remainingBytes;
-	}
-}
-
 void SdlSoundManager::UpdateSoundSettings()
 {
 	uint32_t sampleRate = _console->GetSettings()->GetSampleRate();
@@ -159,18 +136,11 @@ void SdlSoundManager::UpdateSoundSettings()
 
 void SdlSoundManager::PlayBuffer(int16_t *soundBuffer, uint32_t sampleCount, uint32_t sampleRate, bool isStereo)
 {
-	uint32_t bytesPerSample = (SoundMixer::BitsPerSample / 8) * (isStereo ? 2 : 1);
 	UpdateSoundSettings();
 
-	WriteToBuffer((uint8_t*)soundBuffer, sampleCount * bytesPerSample);
+	_buffer.Write(soundBuffer, sampleCount);
 
-	int32_t byteLatency = (int32_t)((float)(sampleRate * _previousLatency) / 1000.0f * bytesPerSample);
-	int32_t playWriteByteLatency = _writePosition - _readPosition;
-	if(playWriteByteLatency < 0) {
-		playWriteByteLatency = _bufferSize - _readPosition + _writePosition;
-	}
-
-	if(playWriteByteLatency > byteLatency) {
+	if(_buffer.GetFillLevel() >= _latencyFrames) {
 		//Start playing
 		SDL_PauseAudioDevice(_audioDeviceID, 0);
 	}
@@ -183,16 +153,16 @@ void SdlSoundManager::Pause()
 
 void SdlSoundManager::Stop()
 {
+	//Once paused, SDL no longer runs the callback, so the buffer can be cleared safely
 	Pause();
 
-	_readPosition = 0;
-	_writePosition = 0;
+	_buffer.Clear();
 	ResetStats();
 }
 
 void SdlSoundManager::ProcessEndOfFrame()
 {
-	ProcessLatency(_readPosition, _writePosition);
+	ProcessFillLevel(_buffer.GetFillLevel() * GetFrameSize());
 
 	uint32_t emulationSpeed = _console->GetSettings()->GetEmulationSpeed();
 	if(_averageLatency > 0 && emulationSpeed <= 100 && emulationSpeed > 0 && std::abs(_averageLatency - _console->GetSettings()->GetAudioLatency()) > 50) {
@@ -200,3 +170,14 @@ void SdlSoundManager::ProcessEndOfFrame()
 		Stop();
 	}
 }
+
+AudioStatistics SdlSoundManager::GetStatistics()
+{
+	AudioStatistics stats = BaseSoundManager::GetStatistics();
+	stats.BufferUnderrunEventCount = _buffer.GetUnderrunCount();
+	if(_sampleRate > 0) {
+		stats.HasFillLevel = true;
+		stats.FillLevel = _buffer.GetFillLevel() * 1000.0 / _sampleRate;
+	}
+	return stats;
+}
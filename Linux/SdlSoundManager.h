@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include <SDL2/SDL.h>
 #include "../Core/BaseSoundManager.h"
+#include "../Utilities/AudioRingBuffer.h"
 
 class Console;
 
@@ -20,6 +21,8 @@ public:
 	string GetAvailableDevices() override;
 	void SetAudioDevice(string deviceName) override;
 
+	AudioStatistics GetStatistics() override;
+
 private:
 	vector<string> GetAvailableDeviceInfo();
 	bool InitializeAudio(uint32_t sampleRate, bool isStereo);
@@ -27,8 +30,6 @@ private:
 
 	static void FillAudioBuffer(void *userData, uint8_t *stream, int len);
 
-	void ReadFromBuffer(uint8_t* output, uint32_t len);
-	void WriteToBuffer(uint8_t* output, uint32_t len);
 
 private:
 	shared_ptr<Console> _console;
@@ -38,7 +39,10 @@ private:
 
 	uint16_t _previousLatency = 0;
 
-	uint8_t* _buffer = nullptr;
-	uint32_t _writePosition = 0;
-	uint32_t _readPosition = 0;
+	//Written by the emulation thread, read by SDL's audio callback
+	AudioRingBuffer _buffer;
+	uint32_t _latencyFrames = 0;
+	uint32_t _periodFrames = 0;
+
+	uint32_t GetFrameSize();
 };
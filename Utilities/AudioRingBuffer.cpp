@@ -0,0 +1,90 @@
+#include "stdafx.h"
+#include "AudioRingBuffer.h"
+
+AudioRingBuffer::AudioRingBuffer()
+{
+	Reset(1, 1);
+}
+
+void AudioRingBuffer::Reset(uint32_t minCapacity, uint32_t channelCount)
+{
+	_capacity = 1;
+	while(_capacity < minCapacity) {
+		_capacity <<= 1;
+	}
+	_channelCount = channelCount;
+	_buffer = vector<int16_t>(_capacity * channelCount, 0);
+	Clear();
+}
+
+void AudioRingBuffer::Clear()
+{
+	_writePosition = 0;
+	_readPosition = 0;
+	_underrunCount = 0;
+	_overflowCount = 0;
+}
+
+uint32_t AudioRingBuffer::Write(const int16_t* samples, uint32_t frameCount)
+{
+	uint32_t writePosition = _writePosition.load(std::memory_order_relaxed);
+	uint32_t readPosition = _readPosition.load(std::memory_order_acquire);
+
+	uint32_t freeFrames = _capacity - (writePosition - readPosition);
+	if(frameCount > freeFrames) {
+		_overflowCount.store(_overflowCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		frameCount = freeFrames;
+	}
+
+	uint32_t start = writePosition & (_capacity - 1);
+	uint32_t firstPart = std::min(frameCount, _capacity - start);
+	memcpy(_buffer.data() + start * _channelCount, samples, firstPart * _channelCount * sizeof(int16_t));
+	memcpy(_buffer.data(), samples + firstPart * _channelCount, (frameCount - firstPart) * _channelCount * sizeof(int16_t));
+
+	//Release: the consumer sees the samples before it sees the new position
+	_writePosition.store(writePosition + frameCount, std::memory_order_release);
+	return frameCount;
+}
+
+uint32_t AudioRingBuffer::Read(int16_t* output, uint32_t frameCount)
+{
+	uint32_t readPosition = _readPosition.load(std::memory_order_relaxed);
+	uint32_t writePosition = _writePosition.load(std::memory_order_acquire);
+
+	uint32_t readFrames = std::min(frameCount, writePosition - readPosition);
+	uint32_t start = readPosition & (_capacity - 1);
+	uint32_t firstPart = std::min(readFrames, _capacity - start);
+	memcpy(output, _buffer.data() + start * _channelCount, firstPart * _channelCount * sizeof(int16_t));
+	memcpy(output + firstPart * _channelCount, _buffer.data(), (readFrames - firstPart) * _channelCount * sizeof(int16_t));
+
+	//Release: the producer can only overwrite these frames once they have been copied
+	_readPosition.store(readPosition + readFrames, std::memory_order_release);
+
+	if(readFrames < frameCount) {
+		memset(output + readFrames * _channelCount, 0, (frameCount - readFrames) * _channelCount * sizeof(int16_t));
+		_underrunCount.store(_underrunCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+	return readFrames;
+}
+
+uint32_t AudioRingBuffer::GetFillLevel()
+{
+	uint32_t readPosition = _readPosition.load(std::memory_order_acquire);
+	uint32_t writePosition = _writePosition.load(std::memory_order_acquire);
+	return std::min(writePosition - readPosition, _capacity);
+}
+
+uint32_t AudioRingBuffer::GetCapacity()
+{
+	return _capacity;
+}
+
+uint32_t AudioRingBuffer::GetUnderrunCount()
+{
+	return _underrunCount.load(std::memory_order_relaxed);
+}
+
+uint32_t AudioRingBuffer::GetOverflowCount()
+{
+	return _overflowCount.load(std::memory_order_relaxed);
+}
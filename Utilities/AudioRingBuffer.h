@@ -0,0 +1,42 @@
+#pragma once
+#include "stdafx.h"
+
+//Wait-free single-producer/single-consumer ring buffer of audio sample frames (one sample per channel)
+//One thread can call Write() while another calls Read() and neither ever blocks - Reset()/Clear() must only be called while neither side is running.
+class AudioRingBuffer
+{
+private:
+	static constexpr uint32_t CacheLineSize = 64;
+
+	//Only modified by Reset(), read by both sides
+	vector<int16_t> _buffer;
+	uint32_t _capacity = 0;
+	uint32_t _channelCount = 1;
+
+	//Each position is only modified by one side - they are aligned to separate cache lines to avoid false sharing between the 2 threads.
+	//Positions count frames since the last reset and wrap around at 2^32, so (write - read) is always the number of queued frames.
+	alignas(CacheLineSize) atomic<uint32_t> _writePosition;
+	atomic<uint32_t> _overflowCount;
+
+	alignas(CacheLineSize) atomic<uint32_t> _readPosition;
+	atomic<uint32_t> _underrunCount;
+
+public:
+	AudioRingBuffer();
+
+	//Capacity is rounded up to a power of 2 frames
+	void Reset(uint32_t minCapacity, uint32_t channelCount);
+	void Clear();
+
+	//Producer: queues up to frameCount frames and returns the number of frames written (frames that do not fit are dropped)
+	uint32_t Write(const int16_t* samples, uint32_t frameCount);
+
+	//Consumer: reads up to frameCount frames and returns the number of frames read - the rest of the output is filled with silence (underrun)
+	uint32_t Read(int16_t* output, uint32_t frameCount);
+
+	//Telemetry, can be called from any thread
+	uint32_t GetFillLevel();
+	uint32_t GetCapacity();
+	uint32_t GetUnderrunCount();
+	uint32_t GetOverflowCount();
+};
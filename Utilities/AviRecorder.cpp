@@ -1,15 +1,13 @@
 #include "stdafx.h"
 #include "AviRecorder.h"
 
-AviRecorder::AviRecorder(VideoCodec codec, uint32_t compressionLevel)
+AviRecorder::AviRecorder(VideoCodec codec, uint32_t compressionLevel, bool allowFrameDrops)
 {
 	_recording = false;
-	_stopFlag = false;
-	_frameBuffer = nullptr;
-	_frameBufferLength = 0;
 	_sampleRate = 0;
 	_codec = codec;
 	_compressionLevel = compressionLevel;
+	_allowFrameDrops = allowFrameDrops;
 }
 
 AviRecorder::~AviRecorder()
@@ -17,11 +15,6 @@ AviRecorder::~AviRecorder()
 	if(_recording) {
 		StopRecording();
 	}
-
-	if(_frameBuffer) {
-		delete[] _frameBuffer;
-		_frameBuffer = nullptr;
-	}
 }
 
 bool AviRecorder::StartRecording(string filename, uint32_t width, uint32_t height, uint32_t bpp, uint32_t audioSampleRate, double fps)
@@ -32,27 +25,15 @@ bool AviRecorder::StartRecording(string filename, uint32_t width, uint32_t heigh
 		_width = width;
 		_height = height;
 		_fps = fps;
-		_frameBufferLength = height * width * bpp;
-		_frameBuffer = new uint8_t[_frameBufferLength];
 
+		//The writer compresses the frames on its own threads, AddFrame only queues them
 		_aviWriter.reset(new AviWriter());
-		if(!_aviWriter->StartWrite(filename, _codec, width, height, bpp, (uint32_t)(_fps * 1000000), audioSampleRate, _compressionLevel)) {
+		if(!_aviWriter->StartWrite(filename, _codec, width, height, bpp, (uint32_t)(_fps * 1000000), audioSampleRate, _compressionLevel, _allowFrameDrops)) {
 			_aviWriter.reset();
 			return false;
 		}
 
-		_aviWriterThread = std::thread([=]() {
-			while(!_stopFlag) {
-				_waitFrame.Wait();
-				if(_stopFlag) {
-					break;
-				}
-
-				auto lock = _lock.AcquireSafe();
-				_aviWriter->AddFrame(_frameBuffer);
-			}
-		});
-
+		_stats = {};
 		_recording = true;
 	}
 	return true;
@@ -60,14 +41,12 @@ bool AviRecorder::StartRecording(string filename, uint32_t width, uint32_t heigh
 
 void AviRecorder::StopRecording()
 {
+	auto lock = _lock.AcquireSafe();
 	if(_recording) {
 		_recording = false;
 
-		_stopFlag = true;
-		_waitFrame.Signal();
-		_aviWriterThread.join();
-
 		_aviWriter->EndWrite();
+		_stats = _aviWriter->GetStats();
 		_aviWriter.reset();
 	}
 }
@@ -79,8 +58,9 @@ void AviRecorder::AddFrame(void* frameBuffer, uint32_t width, uint32_t height, d
 			StopRecording();
 		} else {
 			auto lock = _lock.AcquireSafe();
-			memcpy(_frameBuffer, frameBuffer, _frameBufferLength);
-			_waitFrame.Signal();
+			if(_recording) {
+				_aviWriter->AddFrame((uint8_t*)frameBuffer);
+			}
 		}
 	}
 }
@@ -89,10 +69,12 @@ void AviRecorder::AddSound(int16_t* soundBuffer, uint32_t sampleCount, uint32_t
 {
 	if(_recording) {
 		if(_sampleRate != sampleRate) {
-			auto lock = _lock.AcquireSafe();
 			StopRecording();
 		} else {
-			_aviWriter->AddSound(soundBuffer, sampleCount);
+			auto lock = _lock.AcquireSafe();
+			if(_recording) {
+				_aviWriter->AddSound(soundBuffer, sampleCount);
+			}
 		}
 	}
 }
@@ -105,4 +87,10 @@ bool AviRecorder::IsRecording()
 string AviRecorder::GetOutputFile()
 {
 	return _outputFile;
-}
\ No newline at end of file
+}
+
+VideoRecorderStats AviRecorder::GetStats()
+{
+	auto lock = _lock.AcquireSafe();
+	return _recording ? _aviWriter->GetStats() : _stats;
+}
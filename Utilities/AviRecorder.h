@@ -1,7 +1,5 @@
 #pragma once
 #include "stdafx.h"
-#include <thread>
-#include "AutoResetEvent.h"
 #include "AviWriter.h"
 #include "SimpleLock.h"
 #include "IVideoRecorder.h"
@@ -11,19 +9,14 @@ class Console;
 class AviRecorder : public IVideoRecorder
 {
 private:
-	std::thread _aviWriterThread;
-	
 	unique_ptr<AviWriter> _aviWriter;
 
 	string _outputFile;
 	SimpleLock _lock;
-	AutoResetEvent _waitFrame;
 
-	atomic<bool> _stopFlag;	
 	bool _recording;
-	uint8_t* _frameBuffer;
-	uint32_t _frameBufferLength;
 	uint32_t _sampleRate;
+	VideoRecorderStats _stats = {};
 
 	double _fps;
 	uint32_t _width;
@@ -31,9 +24,10 @@ private:
 
 	VideoCodec _codec;
 	uint32_t _compressionLevel;
+	bool _allowFrameDrops;
 
 public:
-	AviRecorder(VideoCodec codec, uint32_t compressionLevel);
+	AviRecorder(VideoCodec codec, uint32_t compressionLevel, bool allowFrameDrops);
 	virtual ~AviRecorder();
 
 	bool StartRecording(string filename, uint32_t width, uint32_t height, uint32_t bpp, uint32_t audioSampleRate, double fps) override;
@@ -44,4 +38,5 @@ public:
 
 	bool IsRecording() override;
 	string GetOutputFile() override;
+	VideoRecorderStats GetStats() override;
 };
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include "stdafx.h"
 #include <fstream>
 #include <cstring>
+#include <algorithm>
 #include "AviWriter.h"
 #include "BaseCodec.h"
 #include "RawCodec.h"
@@ -34,8 +35,12 @@ void AviWriter::WriteAviChunk(const char *tag, uint32_t size, void *data, uint32
 	host_writed(&chunk[4], size);
 	_file.write((char*)chunk, 8);
 	
+	//Chunks are padded to an even size
 	uint32_t writesize = (size + 1)&~1;
-	_file.write((char*)data, writesize);
+	_file.write((char*)data, size);
+	if(writesize != size) {
+		_file.put(0);
+	}
 	
 	uint32_t pos = _written + 4;
 	_written += writesize + 8;
@@ -64,26 +69,33 @@ void AviWriter::host_writed(uint8_t* buffer, uint32_t value)
 	buffer[3] = value >> 24;
 }
 
-bool AviWriter::StartWrite(string filename, VideoCodec codec, uint32_t width, uint32_t height, uint32_t bpp, uint32_t fps, uint32_t audioSampleRate, uint32_t compressionLevel)
+bool AviWriter::StartWrite(string filename, VideoCodec codec, uint32_t width, uint32_t height, uint32_t bpp, uint32_t fps, uint32_t audioSampleRate, uint32_t compressionLevel, bool allowFrameDrops)
 {
 	_codecType = codec;
+	_allowFrameDrops = allowFrameDrops;
 	_file.open(filename, std::ios::out | std::ios::binary);
 	if(!_file) {
 		return false;
 	}
 	
-	switch(_codecType) {
-		default:
-		case VideoCodec::None: _codec.reset(new RawCodec()); break;
-		case VideoCodec::ZMBV: _codec.reset(new ZmbvCodec()); break;
-		case VideoCodec::CSCD: _codec.reset(new CamstudioCodec()); break;
-	}
-
-	if(!_codec->SetupCompress(width, height, compressionLevel)) {
-		return false;
+	uint32_t encoderCount = std::max(1u, std::min(MaxEncoderCount, std::thread::hardware_concurrency()));
+	for(uint32_t i = 0; i < encoderCount; i++) {
+		unique_ptr<AviEncoder> encoder(new AviEncoder());
+		encoder->Codec.reset(CreateCodec());
+		if(!encoder->Codec->SetupCompress(width, height, compressionLevel)) {
+			_encoders.clear();
+			_file.close();
+			return false;
+		}
+		_encoders.push_back(std::move(encoder));
 	}
 
-	_frameBuffer = new uint8_t[width*height*bpp];
+	//Keep up to 2 keyframe intervals worth of frames waiting to be encoded, as long as they fit in the memory budget
+	_maxQueuedFrames = std::max(encoderCount * 2, std::min(KeyFrameInterval * 2, MaxQueueMemory / (width * height * bpp)));
+	_queuedFrames = 0;
+	_droppedFrames = 0;
+	_frameIndex = 0;
+	_stopEncoders = false;
 
 	_aviIndex.clear();
 	_aviIndex.insert(_aviIndex.end(), 8, 0);
@@ -100,14 +112,36 @@ bool AviWriter::StartWrite(string filename, VideoCodec codec, uint32_t width, ui
 	}
 	_frames = 0;
 	_written = 0;
-	_audioPos = 0;
+	_audioBuffer.clear();
 	_audiowritten = 0;
 
+	for(unique_ptr<AviEncoder> &encoder : _encoders) {
+		encoder->Thread = std::thread(&AviWriter::EncoderThread, this, encoder.get());
+	}
+
 	return true;
 }
 
+BaseCodec* AviWriter::CreateCodec()
+{
+	switch(_codecType) {
+		default:
+		case VideoCodec::None: return new RawCodec();
+		case VideoCodec::ZMBV: return new ZmbvCodec();
+		case VideoCodec::CSCD: return new CamstudioCodec();
+	}
+}
+
 void AviWriter::EndWrite()
 {
+	//Let the encoders process the frames that are still queued, and then write them
+	_stopEncoders = true;
+	for(unique_ptr<AviEncoder> &encoder : _encoders) {
+		encoder->WaitFrame.Signal();
+		encoder->Thread.join();
+	}
+	WriteEncodedFrames();
+
 	/* Close the video */
 	uint8_t avi_header[AviWriter::AviHeaderSize];
 	uint32_t main_list;
@@ -149,7 +183,7 @@ void AviWriter::EndWrite()
 	AVIOUT4("strh");
 	AVIOUTd(56);                        /* # of bytes to follow */
 	AVIOUT4("vids");                    /* Type */
-	AVIOUT4(_codec->GetFourCC());		            /* Handler */
+	AVIOUT4(_encoders[0]->Codec->GetFourCC());		            /* Handler */
 	AVIOUTd(0);                         /* Flags */
 	AVIOUTd(0);                         /* Reserved, MS says: wPriority, wLanguage */
 	AVIOUTd(0);                         /* InitialFrames */
@@ -171,7 +205,7 @@ void AviWriter::EndWrite()
 														//		OUTSHRT(1); OUTSHRT(24);     /* Planes, Count */
 	AVIOUTw(1);  //number of planes
 	AVIOUTw(24); //bits for colors
-	AVIOUT4(_codec->GetFourCC());          /* Compression */
+	AVIOUT4(_encoders[0]->Codec->GetFourCC());          /* Compression */
 	AVIOUTd(_width * _height * 4);  /* SizeImage (in bytes?) */
 	AVIOUTd(0);                  /* XPelsPerMeter */
 	AVIOUTd(0);                  /* YPelsPerMeter */
@@ -231,36 +265,152 @@ void AviWriter::EndWrite()
 	_file.seekp(std::ios::beg);
 	_file.write((char*)avi_header, AviWriter::AviHeaderSize);
 	_file.close();
+
+	_encoders.clear();
+	_freeFrameBuffers.clear();
+	_freeFrames.clear();
 }
 
-void AviWriter::AddFrame(uint8_t *frameData)
+bool AviWriter::AddFrame(uint8_t *frameData)
 {
 	if(!_file) {
-		return;
+		return false;
 	}
 
-	bool isKeyFrame = (_frames % 120 == 0) ? 1 : 0;
+	uint32_t frameSize = _width * _height * _bpp;
+	shared_ptr<AviFrame> frame;
+	AviEncoder* encoder;
+	while(true) {
+		{
+			auto lock = _queueLock.AcquireSafe();
+			if(_queuedFrames < _maxQueuedFrames) {
+				//Reuse the frames (and their buffers) that have already been written to the file
+				if(_freeFrames.empty()) {
+					frame.reset(new AviFrame());
+				} else {
+					frame = _freeFrames.back();
+					_freeFrames.pop_back();
+				}
 
-	uint8_t* compressedData = nullptr;
-	int written = _codec->CompressFrame(isKeyFrame, frameData, &compressedData);
-	if(written < 0) {
-		return;
-	}
+				if(!_freeFrameBuffers.empty()) {
+					frame->FrameData = std::move(_freeFrameBuffers.back());
+					_freeFrameBuffers.pop_back();
+				}
+
+				frame->IsKeyFrame = _codecType == VideoCodec::None || (_frameIndex % KeyFrameInterval) == 0;
+				frame->Encoded = false;
+				encoder = _encoders[(_frameIndex / KeyFrameInterval) % _encoders.size()].get();
+				_frameIndex++;
+				_queuedFrames++;
+				break;
+			} else if(_allowFrameDrops) {
+				//The encoders can't keep up, drop the frame (its sound samples are kept and written along with the next frame)
+				_droppedFrames++;
+				return false;
+			}
+		}
 
-	if(_codecType == VideoCodec::None) {
-		isKeyFrame = true;
+		//Offline recordings never drop frames, wait for an encoder to finish a frame instead
+		_frameEncoded.Wait();
 	}
-	WriteAviChunk(_codecType == VideoCodec::None ? "00db" : "00dc", written, compressedData, isKeyFrame ? 0x10 : 0);
-	_frames++;
 
-	if(_audioPos) {
+	frame->FrameData.assign(frameData, frameData + frameSize);
+	{
 		auto lock = _audioLock.AcquireSafe();
-		WriteAviChunk("01wb", _audioPos, _audiobuf, 0);
-		_audiowritten += _audioPos;
-		_audioPos = 0;
+		frame->Audio.swap(_audioBuffer);
+	}
+
+	{
+		auto lock = _queueLock.AcquireSafe();
+		_pendingFrames.push_back(frame);
+		encoder->Frames.push_back(frame);
+	}
+	encoder->WaitFrame.Signal();
+	return true;
+}
+
+void AviWriter::EncoderThread(AviEncoder* encoder)
+{
+	while(true) {
+		shared_ptr<AviFrame> frame;
+		{
+			auto lock = _queueLock.AcquireSafe();
+			if(!encoder->Frames.empty()) {
+				frame = encoder->Frames.front();
+				encoder->Frames.pop_front();
+			}
+		}
+
+		if(!frame) {
+			if(_stopEncoders) {
+				break;
+			}
+			encoder->WaitFrame.Wait();
+			continue;
+		}
+
+		uint8_t* compressedData = nullptr;
+		int written = encoder->Codec->CompressFrame(frame->IsKeyFrame, frame->FrameData.data(), &compressedData);
+
+		if(written >= 0) {
+			frame->EncodedData.assign(compressedData, compressedData + written);
+		} else {
+			frame->EncodedData.clear();
+		}
+
+		{
+			auto lock = _queueLock.AcquireSafe();
+			_freeFrameBuffers.push_back(std::move(frame->FrameData));
+			frame->FrameData.clear();
+			_queuedFrames--;
+			frame->Encoded = true;
+		}
+		_frameEncoded.Signal();
+
+		WriteEncodedFrames();
 	}
 }
 
+void AviWriter::WriteEncodedFrames()
+{
+	//Frames are encoded out of order when several encoders are running, write all the frames that are ready, in order
+	auto writeLock = _writeLock.AcquireSafe();
+	while(true) {
+		shared_ptr<AviFrame> frame;
+		{
+			auto lock = _queueLock.AcquireSafe();
+			if(_pendingFrames.empty() || !_pendingFrames.front()->Encoded) {
+				break;
+			}
+			frame = _pendingFrames.front();
+			_pendingFrames.pop_front();
+		}
+
+		if(!frame->EncodedData.empty()) {
+			WriteAviChunk(_codecType == VideoCodec::None ? "00db" : "00dc", (uint32_t)frame->EncodedData.size(), frame->EncodedData.data(), frame->IsKeyFrame ? 0x10 : 0);
+			_frames++;
+		}
+
+		if(!frame->Audio.empty()) {
+			uint32_t audioSize = (uint32_t)(frame->Audio.size() * sizeof(int16_t));
+			WriteAviChunk("01wb", audioSize, frame->Audio.data(), 0);
+			_audiowritten += audioSize;
+			frame->Audio.clear();
+		}
+
+		{
+			auto lock = _queueLock.AcquireSafe();
+			_freeFrames.push_back(frame);
+		}
+	}
+}
+
+VideoRecorderStats AviWriter::GetStats()
+{
+	auto lock = _queueLock.AcquireSafe();
+	return { _queuedFrames, _frames, _droppedFrames };
+}
+
 void AviWriter::AddSound(int16_t *data, uint32_t sampleCount)
 {
 	if(!_file) {
@@ -268,6 +418,5 @@ void AviWriter::AddSound(int16_t *data, uint32_t sampleCount)
 	}
 
 	auto lock = _audioLock.AcquireSafe();
-	memcpy(_audiobuf+_audioPos/2, data, sampleCount * 4);
-	_audioPos += sampleCount * 4;
-}
\ No newline at end of file
+	_audioBuffer.insert(_audioBuffer.end(), data, data + sampleCount * 2);
+}
@@ -3,8 +3,12 @@
 
 #pragma once
 #include "stdafx.h"
+#include <thread>
+#include <deque>
 #include "SimpleLock.h"
+#include "AutoResetEvent.h"
 #include "BaseCodec.h"
+#include "IVideoRecorder.h"
 
 enum class VideoCodec
 {
@@ -14,19 +18,59 @@ enum class VideoCodec
 	GIF = 3
 };
 
+struct AviFrame
+{
+	bool IsKeyFrame = false;
+	bool Encoded = false;
+
+	//Raw frame data (its buffer is given back to the free list once the frame is encoded)
+	vector<uint8_t> FrameData;
+
+	//Compressed frame data
+	vector<uint8_t> EncodedData;
+
+	//Sound samples received before the frame was added
+	vector<int16_t> Audio;
+};
+
+struct AviEncoder
+{
+	std::unique_ptr<BaseCodec> Codec;
+	std::thread Thread;
+	AutoResetEvent WaitFrame;
+	std::deque<shared_ptr<AviFrame>> Frames;
+};
+
 class AviWriter
 {
 private:
-	static constexpr int WaveBufferSize = 16 * 1024;
 	static constexpr int AviHeaderSize = 500;
+	static constexpr uint32_t KeyFrameInterval = 120;
+	static constexpr uint32_t MaxEncoderCount = 4;
+	static constexpr uint32_t MaxQueueMemory = 128 * 1024 * 1024;
+
+	//Each keyframe interval is compressed on its own by one of the encoders (with its own codec instance),
+	//so several intervals can be compressed in parallel - the frames are written to the file in order as they are done
+	vector<unique_ptr<AviEncoder>> _encoders;
+	std::deque<shared_ptr<AviFrame>> _pendingFrames;
+	vector<vector<uint8_t>> _freeFrameBuffers;
+	vector<shared_ptr<AviFrame>> _freeFrames;
+	SimpleLock _queueLock;
+	SimpleLock _writeLock;
+	AutoResetEvent _frameEncoded;
+	atomic<bool> _stopEncoders;
+	bool _allowFrameDrops = true;
+
+	uint32_t _maxQueuedFrames = 0;
+	uint32_t _queuedFrames = 0;
+	uint32_t _droppedFrames = 0;
+	uint32_t _frameIndex = 0;
 
-	std::unique_ptr<BaseCodec> _codec;
 	ofstream _file;
 
 	VideoCodec _codecType;
 
-	int16_t _audiobuf[WaveBufferSize];
-	uint32_t _audioPos = 0;
+	vector<int16_t> _audioBuffer;
 	uint32_t _audiorate = 0;
 	uint32_t _audiowritten = 0;
 
@@ -37,8 +81,6 @@ private:
 	uint32_t _written = 0;
 	uint32_t _fps = 0;
 
-	uint8_t* _frameBuffer = nullptr;
-
 	vector<uint8_t> _aviIndex;
 	
 	SimpleLock _audioLock;
@@ -48,10 +90,17 @@ private:
 	void host_writed(uint8_t* buffer, uint32_t value);
 	void WriteAviChunk(const char * tag, uint32_t size, void * data, uint32_t flags);
 
+	BaseCodec* CreateCodec();
+	void EncoderThread(AviEncoder* encoder);
+	void WriteEncodedFrames();
+
 public:
-	void AddFrame(uint8_t* frameData);
+	//Returns false if the frame was dropped because the encoders are too far behind (when frame drops are not allowed, waits for the encoders instead)
+	bool AddFrame(uint8_t* frameData);
 	void AddSound(int16_t * data, uint32_t sampleCount);
 
-	bool StartWrite(string filename, VideoCodec codec, uint32_t width, uint32_t height, uint32_t bpp, uint32_t fps, uint32_t audioSampleRate, uint32_t compressionLevel);
+	bool StartWrite(string filename, VideoCodec codec, uint32_t width, uint32_t height, uint32_t bpp, uint32_t fps, uint32_t audioSampleRate, uint32_t compressionLevel, bool allowFrameDrops);
 	void EndWrite();
+
+	VideoRecorderStats GetStats();
 };
\ No newline at end of file
@@ -130,6 +130,19 @@ void FolderUtilities::CreateFolder(string folder)
 	fs::create_directory(fs::u8path(folder), errorCode);
 }
 
+bool FolderUtilities::IsSameFile(string filepath1, string filepath2)
+{
+	std::error_code errorCode;
+	return fs::equivalent(fs::u8path(filepath1), fs::u8path(filepath2), errorCode);
+}
+
+bool FolderUtilities::RenameFile(string filepath, string newFilepath)
+{
+	std::error_code errorCode;
+	fs::rename(fs::u8path(filepath), fs::u8path(newFilepath), errorCode);
+	return !errorCode;
+}
+
 vector<string> FolderUtilities::GetFolders(string rootFolder)
 {
 	vector<string> folders;
@@ -227,6 +240,17 @@ void FolderUtilities::CreateFolder(string folder)
 {
 }
 
+bool FolderUtilities::IsSameFile(string filepath1, string filepath2)
+{
+	return filepath1 == filepath2;
+}
+
+bool FolderUtilities::RenameFile(string filepath, string newFilepath)
+{
+	std::remove(newFilepath.c_str());
+	return std::rename(filepath.c_str(), newFilepath.c_str()) == 0;
+}
+
 vector<string> FolderUtilities::GetFolders(string rootFolder)
 {
 	return vector<string>();
@@ -36,5 +36,9 @@ public:
 
 	static void CreateFolder(string folder);
 
+	static bool IsSameFile(string filepath1, string filepath2);
+	//Replaces the target file if it already exists
+	static bool RenameFile(string filepath, string newFilepath);
+
 	static string CombinePath(string folder, string filename);
 };
\ No newline at end of file
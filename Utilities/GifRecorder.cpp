@@ -1,10 +1,13 @@
 #include "stdafx.h"
+#include <algorithm>
 #include "GifRecorder.h"
 #include "gif.h"
 
-GifRecorder::GifRecorder()
+GifRecorder::GifRecorder(bool allowFrameDrops)
 {
 	_gif.reset(new GifWriter());
+	_allowFrameDrops = allowFrameDrops;
+	_stopFlag = false;
 }
 
 GifRecorder::~GifRecorder()
@@ -17,26 +20,197 @@ bool GifRecorder::StartRecording(string filename, uint32_t width, uint32_t heigh
 	_outputFile = filename;
 	_recording = GifBegin(_gif.get(), filename.c_str(), width, height, 2, 8, false);
 	_frameCounter = 0;
+	_writtenFrames = 0;
+	_droppedFrames = 0;
+	_width = width;
+	_height = height;
+
+	if(_recording) {
+		_maxQueuedFrames = std::max(2u, MaxQueueMemory / (width * height * 4));
+		_stopFlag = false;
+		_encoderThread = std::thread(&GifRecorder::EncoderThread, this);
+	}
 	return _recording;
 }
 
 void GifRecorder::StopRecording()
 {
+	auto lock = _lock.AcquireSafe();
 	if(_recording) {
+		_recording = false;
+
+		//The encoder thread writes the frames that are still queued before it stops
+		_stopFlag = true;
+		_waitFrame.Signal();
+		_encoderThread.join();
+
 		GifEnd(_gif.get());
 	}
 }
 
 void GifRecorder::AddFrame(void* frameBuffer, uint32_t width, uint32_t height, double fps)
 {
+	auto lock = _lock.AcquireSafe();
+	if(!_recording || width != _width || height != _height) {
+		return;
+	}
+
 	_frameCounter++;
-	
+
 	if(fps < 55 || (_frameCounter % 6) != 0) {
 		//At 60 FPS, skip 1 of every 6 frames (max FPS for GIFs is 50fps)
-		GifWriteFrame(_gif.get(), (uint8_t*)frameBuffer, width, height, 2, 8, false);
+		vector<uint32_t> frame;
+		while(true) {
+			{
+				auto queueLock = _queueLock.AcquireSafe();
+				if(_frames.size() < _maxQueuedFrames) {
+					if(!_freeFrameBuffers.empty()) {
+						frame = std::move(_freeFrameBuffers.back());
+						_freeFrameBuffers.pop_back();
+					}
+					break;
+				} else if(_allowFrameDrops) {
+					//The encoder can't keep up, drop the frame
+					_droppedFrames++;
+					return;
+				}
+			}
+
+			//Offline recordings never drop frames, wait for the encoder instead
+			_frameEncoded.Wait();
+		}
+
+		frame.assign((uint32_t*)frameBuffer, (uint32_t*)frameBuffer + width * height);
+
+		{
+			auto queueLock = _queueLock.AcquireSafe();
+			_frames.push_back(std::move(frame));
+		}
+		_waitFrame.Signal();
 	}
 }
 
+void GifRecorder::EncoderThread()
+{
+	while(true) {
+		vector<uint32_t> frame;
+		{
+			auto lock = _queueLock.AcquireSafe();
+			if(!_frames.empty()) {
+				frame = std::move(_frames.front());
+				_frames.pop_front();
+			}
+		}
+
+		if(frame.empty()) {
+			if(_stopFlag) {
+				break;
+			}
+			_waitFrame.Wait();
+			continue;
+		}
+
+		WriteFrame(frame.data());
+
+		{
+			auto lock = _queueLock.AcquireSafe();
+			_writtenFrames++;
+			_freeFrameBuffers.push_back(std::move(frame));
+		}
+		_frameEncoded.Signal();
+	}
+}
+
+void GifRecorder::WriteFrame(uint32_t* frame)
+{
+	if(!WriteFrameWithExactPalette(frame)) {
+		//Too many colors (e.g when using a filter that blends colors), build an approximate palette for the frame
+		GifWriteFrame(_gif.get(), (uint8_t*)frame, _width, _height, 2, 8, false);
+	}
+}
+
+bool GifRecorder::WriteFrameWithExactPalette(uint32_t* frame)
+{
+	//The NES can only display a limited number of colors, so unless a filter blends colors together, frames usually contain
+	//less than 256 colors: in this case, the frame can be written with its exact colors, without needing to build a palette.
+	//Only the area that changed since the previous frame is written, and pixels that did not change in that area are transparent.
+	uint32_t* canvas = (uint32_t*)_gif->oldImage;
+	bool firstFrame = _gif->firstFrame;
+
+	uint32_t left = _width, right = 0, top = _height, bottom = 0;
+	for(uint32_t y = 0; y < _height; y++) {
+		uint32_t* row = frame + y * _width;
+		uint32_t* canvasRow = canvas + y * _width;
+		for(uint32_t x = 0; x < _width; x++) {
+			if(firstFrame || ((row[x] ^ canvasRow[x]) & 0xFFFFFF)) {
+				left = std::min(left, x);
+				right = std::max(right, x);
+				top = std::min(top, y);
+				bottom = std::max(bottom, y);
+			}
+		}
+	}
+
+	if(left > right) {
+		//Nothing changed, write a single transparent pixel to keep the frame's delay
+		left = right = top = bottom = 0;
+	}
+
+	uint32_t width = right - left + 1;
+	uint32_t height = bottom - top + 1;
+	_indexedImage.resize(width * height * 4);
+
+	GifPalette palette = {};
+	memset(_colorKeys, 0xFF, sizeof(_colorKeys));
+	uint32_t colorCount = 1; //Index 0 is the transparent color
+
+	uint8_t* out = _indexedImage.data();
+	for(uint32_t y = top; y <= bottom; y++) {
+		for(uint32_t x = left; x <= right; x++) {
+			uint32_t color = frame[y * _width + x] & 0xFFFFFF;
+			uint8_t index = kGifTransIndex;
+			if(firstFrame || color != (canvas[y * _width + x] & 0xFFFFFF)) {
+				uint32_t slot = (color * 2654435761u) >> 22;
+				while(_colorKeys[slot] != color && _colorKeys[slot] != 0xFFFFFFFF) {
+					slot = (slot + 1) & (ColorTableSize - 1);
+				}
+
+				if(_colorKeys[slot] == 0xFFFFFFFF) {
+					if(colorCount == 256) {
+						return false;
+					}
+					_colorKeys[slot] = color;
+					_colorIndexes[slot] = (uint8_t)colorCount;
+
+					//gif.h writes the palette's b/g/r values as the file's r/g/b values (it expects BGRA data)
+					palette.r[colorCount] = color & 0xFF;
+					palette.g[colorCount] = (color >> 8) & 0xFF;
+					palette.b[colorCount] = (color >> 16) & 0xFF;
+					colorCount++;
+				}
+				index = _colorIndexes[slot];
+			}
+			out[3] = index;
+			out += 4;
+		}
+	}
+
+	//Use the smallest color table that fits the frame's colors (GIF requires at least 4 entries)
+	palette.bitDepth = 2;
+	while((1u << palette.bitDepth) < colorCount) {
+		palette.bitDepth++;
+	}
+
+	GifWriteLzwImage(_gif->f, _indexedImage.data(), left, top, width, height, 2, &palette);
+
+	for(uint32_t y = top; y <= bottom; y++) {
+		memcpy(canvas + y * _width + left, frame + y * _width + left, width * sizeof(uint32_t));
+	}
+	_gif->firstFrame = false;
+
+	return true;
+}
+
 void GifRecorder::AddSound(int16_t* soundBuffer, uint32_t sampleCount, uint32_t sampleRate)
 {
 }
@@ -49,4 +223,10 @@ bool GifRecorder::IsRecording()
 string GifRecorder::GetOutputFile()
 {
 	return _outputFile;
-}
\ No newline at end of file
+}
+
+VideoRecorderStats GifRecorder::GetStats()
+{
+	auto lock = _queueLock.AcquireSafe();
+	return { (uint32_t)_frames.size(), _writtenFrames, _droppedFrames };
+}
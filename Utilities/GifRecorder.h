@@ -1,19 +1,51 @@
 #pragma once
 #include "stdafx.h"
+#include <thread>
+#include <deque>
 #include "../Utilities/IVideoRecorder.h"
+#include "../Utilities/AutoResetEvent.h"
+#include "../Utilities/SimpleLock.h"
 
 struct GifWriter;
 
 class GifRecorder : public IVideoRecorder
 {
 private:
+	static constexpr uint32_t MaxQueueMemory = 64 * 1024 * 1024;
+	static constexpr uint32_t ColorTableSize = 1024;
+
 	std::unique_ptr<GifWriter> _gif;
+	SimpleLock _lock;
 	bool _recording = false;
+	bool _allowFrameDrops = true;
 	uint32_t _frameCounter = 0;
+	uint32_t _writtenFrames = 0;
+	uint32_t _droppedFrames = 0;
 	string _outputFile;
+	uint32_t _width = 0;
+	uint32_t _height = 0;
+
+	//Frames are encoded on a separate thread - AddFrame only copies them to the queue
+	std::thread _encoderThread;
+	AutoResetEvent _waitFrame;
+	AutoResetEvent _frameEncoded;
+	atomic<bool> _stopFlag;
+	SimpleLock _queueLock;
+	std::deque<vector<uint32_t>> _frames;
+	vector<vector<uint32_t>> _freeFrameBuffers;
+	uint32_t _maxQueuedFrames = 0;
+
+	//Open-addressing hash table used to build each frame's exact palette (colors are 24-bit, so 0xFFFFFFFF marks empty entries)
+	uint32_t _colorKeys[ColorTableSize];
+	uint8_t _colorIndexes[ColorTableSize];
+	vector<uint8_t> _indexedImage;
+
+	void EncoderThread();
+	void WriteFrame(uint32_t* frame);
+	bool WriteFrameWithExactPalette(uint32_t* frame);
 
 public:
-	GifRecorder();
+	GifRecorder(bool allowFrameDrops);
 	~GifRecorder();
 
 	bool StartRecording(string filename, uint32_t width, uint32_t height, uint32_t bpp, uint32_t audioSampleRate, double fps) override;
@@ -22,4 +54,5 @@ public:
 	void AddSound(int16_t* soundBuffer, uint32_t sampleCount, uint32_t sampleRate) override;
 	bool IsRecording() override;
 	string GetOutputFile() override;
-};
\ No newline at end of file
+	VideoRecorderStats GetStats() override;
+};
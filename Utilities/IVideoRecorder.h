@@ -1,6 +1,13 @@
 #pragma once
 #include "stdafx.h"
 
+struct VideoRecorderStats
+{
+	uint32_t QueuedFrames;
+	uint32_t WrittenFrames;
+	uint32_t DroppedFrames;
+};
+
 class IVideoRecorder
 {
 public:
@@ -12,4 +19,5 @@ public:
 
 	virtual bool IsRecording() = 0;
 	virtual string GetOutputFile() = 0;
+	virtual VideoRecorderStats GetStats() = 0;
 };
\ No newline at end of file
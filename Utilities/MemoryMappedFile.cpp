@@ -0,0 +1,239 @@
+#include "stdafx.h"
+#include "MemoryMappedFile.h"
+
+#if !defined(LIBRETRO) && defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#elif !defined(LIBRETRO)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+bool MemoryMappedFile::Open(string filename)
+{
+	Close();
+	return Map(filename) || Read(filename);
+}
+
+bool MemoryMappedFile::Map(string filename)
+{
+#if defined(LIBRETRO)
+	//Libretro: Avoid using platform-specific APIs
+	return false;
+#elif defined(_WIN32)
+	HANDLE file = CreateFileW(utf8::utf8::decode(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if(!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if(!data) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	_fileHandle = file;
+	_mappingHandle = mapping;
+	_data = (uint8_t*)data;
+	_size = (size_t)fileSize.QuadPart;
+	return true;
+#else
+	int file = open(filename.c_str(), O_RDONLY);
+	if(file < 0) {
+		return false;
+	}
+
+	struct stat fileInfo;
+	if(fstat(file, &fileInfo) != 0 || fileInfo.st_size == 0) {
+		close(file);
+		return false;
+	}
+
+	void* data = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+	//The mapping stays valid after the file is closed
+	close(file);
+
+	if(data == MAP_FAILED) {
+		return false;
+	}
+
+	_data = (uint8_t*)data;
+	_size = (size_t)fileInfo.st_size;
+	return true;
+#endif
+}
+
+bool MemoryMappedFile::OpenWritable(string filename, size_t size, bool &created)
+{
+	Close();
+	created = false;
+	if(size == 0) {
+		return false;
+	}
+
+#if defined(LIBRETRO)
+	//Libretro: Avoid using platform-specific APIs
+	return false;
+#elif defined(_WIN32)
+	HANDLE file = CreateFileW(utf8::utf8::decode(filename).c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	if(fileSize.QuadPart == 0) {
+		//New file, the mapping extends it to the given size (filled with zeros)
+		created = true;
+	} else if((size_t)fileSize.QuadPart != size) {
+		CloseHandle(file);
+		return false;
+	}
+
+	LARGE_INTEGER mappingSize;
+	mappingSize.QuadPart = (LONGLONG)size;
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READWRITE, mappingSize.HighPart, mappingSize.LowPart, nullptr);
+	if(!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+	if(!data) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	_fileHandle = file;
+	_mappingHandle = mapping;
+#else
+	int file = open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if(file < 0) {
+		return false;
+	}
+
+	struct stat fileInfo;
+	if(fstat(file, &fileInfo) != 0) {
+		close(file);
+		return false;
+	}
+
+	if(fileInfo.st_size == 0) {
+		//New file, extend it to the given size (filled with zeros)
+		if(ftruncate(file, (off_t)size) != 0) {
+			close(file);
+			return false;
+		}
+		created = true;
+	} else if((size_t)fileInfo.st_size != size) {
+		close(file);
+		return false;
+	}
+
+	void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+
+	//The mapping stays valid after the file is closed
+	close(file);
+
+	if(data == MAP_FAILED) {
+		return false;
+	}
+#endif
+
+	_data = (uint8_t*)data;
+	_size = size;
+	_writable = true;
+	return true;
+}
+
+void MemoryMappedFile::Flush()
+{
+	if(_writable) {
+#if !defined(LIBRETRO) && defined(_WIN32)
+		FlushViewOfFile(_data, _size);
+		FlushFileBuffers(_fileHandle);
+#elif !defined(LIBRETRO)
+		msync(_data, _size, MS_SYNC);
+#endif
+	}
+}
+
+bool MemoryMappedFile::Read(string filename)
+{
+	ifstream file(filename, std::ios::in | std::ios::binary);
+	if(!file.good()) {
+		return false;
+	}
+
+	file.seekg(0, std::ios::end);
+	size_t fileSize = (size_t)file.tellg();
+	file.seekg(0, std::ios::beg);
+
+	_fileData = vector<uint8_t>(fileSize, 0);
+	file.read((char*)_fileData.data(), fileSize);
+
+	_data = _fileData.data();
+	_size = _fileData.size();
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if(_data && _data != _fileData.data()) {
+#if !defined(LIBRETRO) && defined(_WIN32)
+		UnmapViewOfFile(_data);
+		CloseHandle(_mappingHandle);
+		CloseHandle(_fileHandle);
+		_mappingHandle = nullptr;
+		_fileHandle = nullptr;
+#elif !defined(LIBRETRO)
+		munmap(_data, _size);
+#endif
+	}
+
+	_data = nullptr;
+	_size = 0;
+	_writable = false;
+	_fileData = vector<uint8_t>();
+}
+
+const uint8_t* MemoryMappedFile::GetData()
+{
+	return _data;
+}
+
+uint8_t* MemoryMappedFile::GetWritableData()
+{
+	return _writable ? _data : nullptr;
+}
+
+size_t MemoryMappedFile::GetSize()
+{
+	return _size;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "stdafx.h"
+
+//View of a file's contents - the file is memory-mapped, so only the parts that are accessed are read from the disk
+//(on platforms where mapping is not available or fails, the whole file is read into memory instead)
+//Files are read-only, unless they are opened with OpenWritable (read/write mapping, without fallback): changes are written back to the file by the OS, even if the process crashes.
+class MemoryMappedFile
+{
+private:
+	uint8_t* _data = nullptr;
+	size_t _size = 0;
+	bool _writable = false;
+	vector<uint8_t> _fileData;
+
+#ifdef _WIN32
+	void* _fileHandle = nullptr;
+	void* _mappingHandle = nullptr;
+#endif
+
+	bool Map(string filename);
+	bool Read(string filename);
+
+public:
+	MemoryMappedFile() { }
+	~MemoryMappedFile();
+
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	bool Open(string filename);
+
+	//Maps the file in read/write mode - a new (or empty) file is created with the given size, filled with zeros (created is set to true).
+	//Existing files whose size doesn't match are left untouched, and false is returned. There is no fallback: returns false if the file can't be mapped.
+	bool OpenWritable(string filename, size_t size, bool &created);
+
+	//Writes the modified pages to the disk (this is otherwise done by the OS, at any time)
+	void Flush();
+	void Close();
+
+	const uint8_t* GetData();
+	uint8_t* GetWritableData();
+	size_t GetSize();
+};
@@ -0,0 +1,276 @@
+#include "stdafx.h"
+#include "PaletteExpander.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+	#define PALETTE_EXPANDER_X86
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define TARGET_SSSE3
+		#define TARGET_AVX2
+	#else
+		//The kernels are compiled for SSSE3/AVX2 even when the rest of the code isn't, and only used when the CPU supports them
+		#define TARGET_SSSE3 __attribute__((target("ssse3")))
+		#define TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
+
+#ifdef PALETTE_EXPANDER_X86
+static bool CheckCpuFeature(bool avx2)
+{
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	int maxLeaf = info[0];
+	__cpuid(info, 1);
+	if(!avx2) {
+		return (info[2] & (1 << 9)) != 0;
+	}
+
+	//AVX2 also needs AVX and an OS that saves the YMM registers (OSXSAVE + XCR0 bits 1-2)
+	if(maxLeaf < 7 || !(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 0x06) != 0x06) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	//__builtin_cpu_supports also checks that the OS supports AVX
+	__builtin_cpu_init();
+	return avx2 ? __builtin_cpu_supports("avx2") : __builtin_cpu_supports("ssse3");
+#endif
+}
+#endif
+
+PaletteExpander::PaletteExpander()
+{
+	memset(_palette, 0, sizeof(_palette));
+	memset(_shuffleTables, 0, sizeof(_shuffleTables));
+	_constantAlpha = true;
+	SetKernel(GetBestKernel());
+}
+
+bool PaletteExpander::IsSupported(Kernel kernel)
+{
+	switch(kernel) {
+		case Kernel::Scalar: return true;
+
+#ifdef PALETTE_EXPANDER_X86
+		case Kernel::Ssse3: {
+			static bool supported = CheckCpuFeature(false);
+			return supported;
+		}
+
+		case Kernel::Avx2: {
+			static bool supported = CheckCpuFeature(true);
+			return supported;
+		}
+#endif
+
+		default: return false;
+	}
+}
+
+PaletteExpander::Kernel PaletteExpander::GetBestKernel()
+{
+	//Both SIMD kernels are faster than the scalar kernel on real frames (see batchrunner -palettebenchmark)
+	for(Kernel kernel : { Kernel::Avx2, Kernel::Ssse3 }) {
+		if(IsSupported(kernel)) {
+			return kernel;
+		}
+	}
+	return Kernel::Scalar;
+}
+
+string PaletteExpander::GetKernelName(Kernel kernel)
+{
+	switch(kernel) {
+		default:
+		case Kernel::Scalar: return "Scalar";
+		case Kernel::Ssse3: return "SSSE3";
+		case Kernel::Avx2: return "AVX2";
+	}
+}
+
+void PaletteExpander::SetKernel(Kernel kernel)
+{
+	if(!IsSupported(kernel)) {
+		kernel = Kernel::Scalar;
+	}
+
+	_kernel = kernel;
+	switch(kernel) {
+		default:
+		case Kernel::Scalar: _expandRow = ExpandRowScalar; break;
+		case Kernel::Ssse3: _expandRow = ExpandRowSsse3; break;
+		case Kernel::Avx2: _expandRow = ExpandRowAvx2; break;
+	}
+}
+
+PaletteExpander::Kernel PaletteExpander::GetKernel()
+{
+	return _kernel;
+}
+
+void PaletteExpander::SetPalette(uint32_t* palette)
+{
+	memcpy(_palette, palette, sizeof(_palette));
+	_constantAlpha = true;
+	for(int emphasis = 0; emphasis < 8; emphasis++) {
+		for(int channel = 0; channel < 4; channel++) {
+			for(int color = 0; color < 64; color++) {
+				uint8_t value = (uint8_t)(palette[(emphasis << 6) | color] >> (channel * 8));
+				uint8_t previousSliceValue = color >= 16 ? (uint8_t)(palette[(emphasis << 6) | (color - 16)] >> (channel * 8)) : 0;
+				_shuffleTables[emphasis][channel][color >> 4][color & 0x0F] = value ^ previousSliceValue;
+			}
+		}
+	}
+
+	for(int i = 1; i < 512; i++) {
+		if((palette[i] ^ palette[0]) & 0xFF000000) {
+			_constantAlpha = false;
+			break;
+		}
+	}
+}
+
+void PaletteExpander::ExpandRowScalar(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width)
+{
+	uint32_t* palette = expander->_palette;
+	for(uint32_t i = 0; i < width; i++) {
+		out[i] = palette[in[i]];
+	}
+}
+
+#ifdef PALETTE_EXPANDER_X86
+TARGET_SSSE3 static inline __m128i LookupChannelSsse3(uint8_t slices[4][16], __m128i index0, __m128i index1, __m128i index2, __m128i index3)
+{
+	__m128i value = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)slices[0]), index0);
+	value = _mm_xor_si128(value, _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)slices[1]), index1));
+	value = _mm_xor_si128(value, _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)slices[2]), index2));
+	return _mm_xor_si128(value, _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)slices[3]), index3));
+}
+
+TARGET_SSSE3 void PaletteExpander::ExpandRowSsse3(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width)
+{
+	uint32_t* palette = expander->_palette;
+	const __m128i colorMask = _mm_set1_epi16(0x3F);
+	const __m128i sliceSize = _mm_set1_epi8(16);
+	const __m128i constantAlpha = _mm_set1_epi8((char)(palette[0] >> 24));
+
+	uint32_t i = 0;
+	for(; i + 16 <= width; i += 16) {
+		__m128i a = _mm_loadu_si128((__m128i*)(in + i));
+		__m128i b = _mm_loadu_si128((__m128i*)(in + i + 8));
+
+		uint16_t emphasis = in[i] >> 6;
+		__m128i emphasisBits = _mm_set1_epi16(emphasis);
+		__m128i sameEmphasis = _mm_and_si128(_mm_cmpeq_epi16(_mm_srli_epi16(a, 6), emphasisBits), _mm_cmpeq_epi16(_mm_srli_epi16(b, 6), emphasisBits));
+		if(_mm_movemask_epi8(sameEmphasis) != 0xFFFF) {
+			//Emphasis bits change within these pixels
+			for(uint32_t j = i; j < i + 16; j++) {
+				out[j] = palette[in[j]];
+			}
+			continue;
+		}
+
+		//Index of the pixel in each 16-byte slice - negative (shuffle returns 0) for the slices above the pixel's color
+		__m128i index0 = _mm_packus_epi16(_mm_and_si128(a, colorMask), _mm_and_si128(b, colorMask));
+		__m128i index1 = _mm_sub_epi8(index0, sliceSize);
+		__m128i index2 = _mm_sub_epi8(index1, sliceSize);
+		__m128i index3 = _mm_sub_epi8(index2, sliceSize);
+
+		uint8_t (*tables)[4][16] = expander->_shuffleTables[emphasis];
+		__m128i blue = LookupChannelSsse3(tables[0], index0, index1, index2, index3);
+		__m128i green = LookupChannelSsse3(tables[1], index0, index1, index2, index3);
+		__m128i red = LookupChannelSsse3(tables[2], index0, index1, index2, index3);
+		__m128i alpha = expander->_constantAlpha ? constantAlpha : LookupChannelSsse3(tables[3], index0, index1, index2, index3);
+
+		__m128i blueGreenLow = _mm_unpacklo_epi8(blue, green);
+		__m128i blueGreenHigh = _mm_unpackhi_epi8(blue, green);
+		__m128i redAlphaLow = _mm_unpacklo_epi8(red, alpha);
+		__m128i redAlphaHigh = _mm_unpackhi_epi8(red, alpha);
+		_mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(blueGreenLow, redAlphaLow));
+		_mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(blueGreenLow, redAlphaLow));
+		_mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpacklo_epi16(blueGreenHigh, redAlphaHigh));
+		_mm_storeu_si128((__m128i*)(out + i + 12), _mm_unpackhi_epi16(blueGreenHigh, redAlphaHigh));
+	}
+
+	for(; i < width; i++) {
+		out[i] = palette[in[i]];
+	}
+}
+
+TARGET_AVX2 static inline __m256i LookupChannelAvx2(uint8_t slices[4][16], __m256i index0, __m256i index1, __m256i index2, __m256i index3)
+{
+	//vpshufb shuffles each 128-bit lane separately, so each slice is copied to both lanes
+	__m256i value = _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)slices[0])), index0);
+	value = _mm256_xor_si256(value, _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)slices[1])), index1));
+	value = _mm256_xor_si256(value, _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)slices[2])), index2));
+	return _mm256_xor_si256(value, _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)slices[3])), index3));
+}
+
+TARGET_AVX2 void PaletteExpander::ExpandRowAvx2(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width)
+{
+	uint32_t* palette = expander->_palette;
+	const __m256i colorMask = _mm256_set1_epi16(0x3F);
+	const __m256i sliceSize = _mm256_set1_epi8(16);
+	const __m256i constantAlpha = _mm256_set1_epi8((char)(palette[0] >> 24));
+
+	uint32_t i = 0;
+	for(; i + 32 <= width; i += 32) {
+		__m256i a = _mm256_loadu_si256((__m256i*)(in + i));
+		__m256i b = _mm256_loadu_si256((__m256i*)(in + i + 16));
+
+		uint16_t emphasis = in[i] >> 6;
+		__m256i emphasisBits = _mm256_set1_epi16(emphasis);
+		__m256i sameEmphasis = _mm256_and_si256(_mm256_cmpeq_epi16(_mm256_srli_epi16(a, 6), emphasisBits), _mm256_cmpeq_epi16(_mm256_srli_epi16(b, 6), emphasisBits));
+		if(_mm256_movemask_epi8(sameEmphasis) != -1) {
+			//Emphasis bits change within these pixels
+			for(uint32_t j = i; j < i + 32; j++) {
+				out[j] = palette[in[j]];
+			}
+			continue;
+		}
+
+		//packus works on each 128-bit lane (pixels 0-7, 16-23 | 8-15, 24-31), the permute puts the pixels back in order
+		__m256i index0 = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a, colorMask), _mm256_and_si256(b, colorMask)), 0xD8);
+		__m256i index1 = _mm256_sub_epi8(index0, sliceSize);
+		__m256i index2 = _mm256_sub_epi8(index1, sliceSize);
+		__m256i index3 = _mm256_sub_epi8(index2, sliceSize);
+
+		uint8_t (*tables)[4][16] = expander->_shuffleTables[emphasis];
+		__m256i blue = LookupChannelAvx2(tables[0], index0, index1, index2, index3);
+		__m256i green = LookupChannelAvx2(tables[1], index0, index1, index2, index3);
+		__m256i red = LookupChannelAvx2(tables[2], index0, index1, index2, index3);
+		__m256i alpha = expander->_constantAlpha ? constantAlpha : LookupChannelAvx2(tables[3], index0, index1, index2, index3);
+
+		//The unpacks also work on each lane: pixels 0-3 & 16-19, 4-7 & 20-23, 8-11 & 24-27, 12-15 & 28-31
+		__m256i blueGreenLow = _mm256_unpacklo_epi8(blue, green);
+		__m256i blueGreenHigh = _mm256_unpackhi_epi8(blue, green);
+		__m256i redAlphaLow = _mm256_unpacklo_epi8(red, alpha);
+		__m256i redAlphaHigh = _mm256_unpackhi_epi8(red, alpha);
+		__m256i pixels0 = _mm256_unpacklo_epi16(blueGreenLow, redAlphaLow);
+		__m256i pixels4 = _mm256_unpackhi_epi16(blueGreenLow, redAlphaLow);
+		__m256i pixels8 = _mm256_unpacklo_epi16(blueGreenHigh, redAlphaHigh);
+		__m256i pixels12 = _mm256_unpackhi_epi16(blueGreenHigh, redAlphaHigh);
+		_mm256_storeu_si256((__m256i*)(out + i), _mm256_permute2x128_si256(pixels0, pixels4, 0x20));
+		_mm256_storeu_si256((__m256i*)(out + i + 8), _mm256_permute2x128_si256(pixels8, pixels12, 0x20));
+		_mm256_storeu_si256((__m256i*)(out + i + 16), _mm256_permute2x128_si256(pixels0, pixels4, 0x31));
+		_mm256_storeu_si256((__m256i*)(out + i + 24), _mm256_permute2x128_si256(pixels8, pixels12, 0x31));
+	}
+
+	for(; i < width; i++) {
+		out[i] = palette[in[i]];
+	}
+}
+#else
+void PaletteExpander::ExpandRowSsse3(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width)
+{
+	ExpandRowScalar(expander, in, out, width);
+}
+
+void PaletteExpander::ExpandRowAvx2(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width)
+{
+	ExpandRowScalar(expander, in, out, width);
+}
+#endif
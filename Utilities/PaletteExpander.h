@@ -0,0 +1,58 @@
+#pragma once
+#include "stdafx.h"
+
+//Converts rows of PPU pixels (6-bit color + 3 emphasis bits) to 32-bit colors using a 512-entry palette
+//The overscan crop is applied by expanding each row's visible window (in/width), and scanlines are expanded with a second
+//expander that holds the darkened palette - so the crop and scanline passes use the same kernels as the palette expansion.
+//The SIMD kernels don't use gathers, and return the same output as the scalar kernel:
+//-Each channel of the palette is split into one 64-byte table per emphasis value, and looked up with 4 byte shuffles (pshufb)
+// into XOR-chained 16-byte slices of it: slice N holds table[N*16..N*16+15] ^ table[(N-1)*16..], and the shuffles for the slices
+// above the pixel's color return 0 (negative index), so the XOR of the 4 results is the pixel's value.
+//-The channels are then interleaved with unpack instructions. Groups of pixels whose emphasis bits change are expanded with scalar lookups.
+class PaletteExpander
+{
+public:
+	enum class Kernel
+	{
+		Scalar = 0,
+		Ssse3 = 1,
+		Avx2 = 2
+	};
+
+private:
+	typedef void(*ExpandRowFunc)(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width);
+
+	uint32_t _palette[512];
+
+	//[emphasis][channel (memory order: B, G, R, A)][slice] - used by the SIMD kernels
+	uint8_t _shuffleTables[8][4][4][16];
+
+	//Every color has the same alpha value (e.g 0xFF): the alpha channel doesn't need to be looked up
+	bool _constantAlpha;
+
+	Kernel _kernel;
+	ExpandRowFunc _expandRow;
+
+	static void ExpandRowScalar(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width);
+	static void ExpandRowSsse3(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width);
+	static void ExpandRowAvx2(PaletteExpander* expander, uint16_t* in, uint32_t* out, uint32_t width);
+
+public:
+	PaletteExpander();
+
+	//Kernels available on the current CPU (checked at runtime)
+	static bool IsSupported(Kernel kernel);
+	static Kernel GetBestKernel();
+	static string GetKernelName(Kernel kernel);
+
+	//Used to compare the kernels (see GetBestKernel for the default kernel)
+	void SetKernel(Kernel kernel);
+	Kernel GetKernel();
+
+	void SetPalette(uint32_t* palette);
+
+	void ExpandRow(uint16_t* in, uint32_t* out, uint32_t width)
+	{
+		_expandRow(this, in, out, width);
+	}
+};
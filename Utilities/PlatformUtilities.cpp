@@ -3,6 +3,8 @@
 
 #if !defined(LIBRETRO) && defined(_WIN32)
 #include <Windows.h>
+#elif !defined(LIBRETRO)
+#include <unistd.h>
 #endif
 
 bool PlatformUtilities::_highResTimerEnabled = false;
@@ -42,4 +44,22 @@ void PlatformUtilities::RestoreTimerResolution()
 		_highResTimerEnabled = false;
 	}
 	#endif
-}
\ No newline at end of file
+}
+
+string PlatformUtilities::GetMachineName()
+{
+	string name;
+#if !defined(LIBRETRO) && defined(_WIN32)
+	char buffer[MAX_COMPUTERNAME_LENGTH + 1] = {};
+	DWORD size = MAX_COMPUTERNAME_LENGTH + 1;
+	if(GetComputerNameA(buffer, &size)) {
+		name = buffer;
+	}
+#elif !defined(LIBRETRO)
+	char buffer[256] = {};
+	if(gethostname(buffer, sizeof(buffer) - 1) == 0) {
+		name = buffer;
+	}
+#endif
+	return name;
+}
@@ -12,4 +12,7 @@ public:
 
 	static void EnableHighResolutionTimer();
 	static void RestoreTimerResolution();
+
+	//Name of the computer (e.g to keep settings/results that are specific to the current machine)
+	static string GetMachineName();
 };
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include "stdafx.h"
+#include <algorithm>
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool(int32_t threadCount)
+{
+	if(threadCount < 0) {
+		threadCount = std::max(1, (int32_t)std::thread::hardware_concurrency()) - 1;
+	}
+
+	_stopThreads = false;
+	_nextTask = 0;
+	_activeWorkers = 0;
+
+	for(int32_t i = 0; i < threadCount; i++) {
+		_startEvents.push_back(unique_ptr<AutoResetEvent>(new AutoResetEvent()));
+	}
+	for(int32_t i = 0; i < threadCount; i++) {
+		_threads.push_back(std::thread(&WorkerPool::WorkerThread, this, i));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	_stopThreads = true;
+	for(unique_ptr<AutoResetEvent> &startEvent : _startEvents) {
+		startEvent->Signal();
+	}
+	for(std::thread &thread : _threads) {
+		thread.join();
+	}
+}
+
+uint32_t WorkerPool::GetParallelism()
+{
+	return (uint32_t)_threads.size() + 1;
+}
+
+void WorkerPool::RunTasks()
+{
+	uint32_t taskIndex;
+	while((taskIndex = _nextTask++) < _taskCount) {
+		_task(taskIndex);
+	}
+}
+
+void WorkerPool::WorkerThread(uint32_t index)
+{
+	while(true) {
+		_startEvents[index]->Wait();
+		if(_stopThreads) {
+			break;
+		}
+
+		RunTasks();
+
+		if(--_activeWorkers == 0) {
+			_workDone.Signal();
+		}
+	}
+}
+
+void WorkerPool::Run(uint32_t taskCount, std::function<void(uint32_t)> task)
+{
+	if(_threads.empty() || taskCount <= 1) {
+		for(uint32_t i = 0; i < taskCount; i++) {
+			task(i);
+		}
+		return;
+	}
+
+	_task = task;
+	_taskCount = taskCount;
+	_nextTask = 0;
+	_activeWorkers = (uint32_t)_threads.size();
+	for(unique_ptr<AutoResetEvent> &startEvent : _startEvents) {
+		startEvent->Signal();
+	}
+
+	RunTasks();
+
+	//The event may still be signaled by the previous call, so check the counter again after each wakeup
+	while(_activeWorkers > 0) {
+		_workDone.Wait();
+	}
+	_task = nullptr;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "stdafx.h"
+#include <thread>
+#include <functional>
+#include "AutoResetEvent.h"
+
+//Persistent set of worker threads used to split a job into several tasks (e.g one task per band of a frame)
+//The calling thread also processes tasks, so a pool with N threads runs up to N+1 tasks at once
+class WorkerPool
+{
+private:
+	vector<std::thread> _threads;
+	vector<unique_ptr<AutoResetEvent>> _startEvents;
+	AutoResetEvent _workDone;
+	atomic<bool> _stopThreads;
+	atomic<uint32_t> _nextTask;
+	atomic<uint32_t> _activeWorkers;
+
+	uint32_t _taskCount = 0;
+	std::function<void(uint32_t)> _task;
+
+	void WorkerThread(uint32_t index);
+	void RunTasks();
+
+public:
+	//threadCount: number of extra threads to start, -1 = one per core (minus the calling thread's)
+	WorkerPool(int32_t threadCount = -1);
+	~WorkerPool();
+
+	//Number of tasks that can run in parallel (worker threads + calling thread)
+	uint32_t GetParallelism();
+
+	//Runs task(0) to task(taskCount - 1) and returns once they are all done - not reentrant
+	void Run(uint32_t taskCount, std::function<void(uint32_t)> task);
+};
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include <string.h>
 #include <sstream>
+#include <algorithm>
 #include "ZipReader.h"
 
 ZipReader::ZipReader()
@@ -26,6 +27,18 @@ bool ZipReader::InternalLoadArchive(void* buffer, size_t size)
 	return mz_zip_reader_init_mem(&_zipArchive, buffer, size, 0) != 0;
 }
 
+bool ZipReader::LoadArchiveFromFile(string filename)
+{
+	if(_initialized) {
+		mz_zip_reader_end(&_zipArchive);
+		memset(&_zipArchive, 0, sizeof(mz_zip_archive));
+		_initialized = false;
+	}
+
+	_initialized = mz_zip_reader_init_file(&_zipArchive, filename.c_str(), 0) != 0;
+	return _initialized;
+}
+
 vector<string> ZipReader::InternalGetFileList()
 {
 	vector<string> fileList;
@@ -63,4 +76,32 @@ bool ZipReader::ExtractFile(string filename, vector<uint8_t> &output)
 	}
 
 	return false;
-}
\ No newline at end of file
+}
+
+struct PartialExtractState
+{
+	vector<uint8_t>* Output;
+	size_t MaxSize;
+};
+
+static size_t PartialExtractCallback(void* opaque, mz_uint64 fileOffset, const void* buffer, size_t size)
+{
+	PartialExtractState* state = (PartialExtractState*)opaque;
+	size_t length = std::min(size, state->MaxSize - state->Output->size());
+	state->Output->insert(state->Output->end(), (uint8_t*)buffer, (uint8_t*)buffer + length);
+
+	//Returning less than size stops the extraction once enough data was read
+	return length;
+}
+
+bool ZipReader::ExtractFile(string filename, vector<uint8_t> &output, size_t maxSize)
+{
+	output.clear();
+	if(_initialized) {
+		PartialExtractState state = { &output, maxSize };
+		bool done = mz_zip_reader_extract_file_to_callback(&_zipArchive, filename.c_str(), PartialExtractCallback, &state, 0) != 0;
+		return done || output.size() == maxSize;
+	}
+
+	return false;
+}
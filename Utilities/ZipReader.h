@@ -16,5 +16,11 @@ public:
 	ZipReader();
 	virtual ~ZipReader();
 
+	//Only reads the archive's directory - the archive file stays open and files are read from the disk when they are extracted
+	bool LoadArchiveFromFile(string filename);
+
 	bool ExtractFile(string filename, vector<uint8_t> &output);
+
+	//Extracts the first maxSize bytes of a file (or the whole file if it is smaller)
+	bool ExtractFile(string filename, vector<uint8_t> &output, size_t maxSize);
 };
\ No newline at end of file
@@ -243,6 +243,50 @@ int blip_read_samples( blip_t* m, short out [], int count, int stereo )
 	return count;
 }
 
+int blip_read_samples_stereo( blip_t* left, blip_t* right, short out [], int count )
+{
+	assert( count >= 0 );
+	
+	if ( count > left->avail )
+		count = left->avail;
+	if ( count > right->avail )
+		count = right->avail;
+	
+	if ( count )
+	{
+		/* Same as blip_read_samples, but the two integrators don't depend on
+		each other, so interleaving them lets the CPU run both at once */
+		buf_t const* in_left  = SAMPLES( left );
+		buf_t const* in_right = SAMPLES( right );
+		int sum_left  = left->integrator;
+		int sum_right = right->integrator;
+		for ( int i = 0; i < count; i++ )
+		{
+			int s  = ARITH_SHIFT( sum_left, delta_bits );
+			int s2 = ARITH_SHIFT( sum_right, delta_bits );
+			
+			sum_left += in_left [i];
+			sum_right += in_right [i];
+			
+			CLAMP( s );
+			CLAMP( s2 );
+			
+			out [i * 2] = s;
+			out [i * 2 + 1] = s2;
+			
+			sum_left -= s << (delta_bits - bass_shift);
+			sum_right -= s2 << (delta_bits - bass_shift);
+		}
+		left->integrator = sum_left;
+		right->integrator = sum_right;
+		
+		remove_samples( left, count );
+		remove_samples( right, count );
+	}
+	
+	return count;
+}
+
 /* Things that didn't help performance on x86:
 	__attribute__((aligned(128)))
 	#define short int
@@ -329,6 +373,59 @@ void blip_add_delta( blip_t* m, unsigned time, int delta )
 	out [15] += in[0]*delta + in[0-half_width]*delta2;
 }
 
+/* bl_step rearranged so that blip_add_delta's 16 taps for a given phase can be
+applied with a single loop: taps [phase] [0] are multiplied by delta, and
+taps [phase] [1] by delta2 */
+typedef short blip_taps_t [phase_count] [2] [half_width * 2];
+
+static blip_taps_t const& get_taps( void )
+{
+	static blip_taps_t taps;
+	static bool initialized = [] {
+		for ( int phase = 0; phase < phase_count; phase++ )
+		{
+			for ( int i = 0; i < half_width; i++ )
+			{
+				taps [phase] [0] [i] = bl_step [phase] [i];
+				taps [phase] [1] [i] = bl_step [phase + 1] [i];
+				taps [phase] [0] [half_width * 2 - 1 - i] = bl_step [phase_count - phase] [i];
+				taps [phase] [1] [half_width * 2 - 1 - i] = bl_step [phase_count - phase - 1] [i];
+			}
+		}
+		return true;
+	}();
+	(void) initialized;
+	return taps;
+}
+
+void blip_add_deltas( blip_t* m, unsigned const times [], int const deltas [], int count )
+{
+	blip_taps_t const& taps = get_taps();
+	buf_t* samples = SAMPLES( m ) + m->avail;
+	int const phase_shift = frac_bits - phase_bits;
+	
+	for ( int n = 0; n < count; n++ )
+	{
+		unsigned fixed = (unsigned) ((times [n] * m->factor + m->offset) >> pre_shift);
+		buf_t* out = samples + (fixed >> frac_bits);
+		
+		int phase = fixed >> phase_shift & (phase_count - 1);
+		short const* in   = taps [phase] [0];
+		short const* next = taps [phase] [1];
+		
+		int delta = deltas [n];
+		int interp = fixed >> (phase_shift - delta_bits) & (delta_unit - 1);
+		int delta2 = (delta * interp) >> delta_bits;
+		delta -= delta2;
+		
+		/* Fails if buffer size was exceeded */
+		assert( out <= &SAMPLES( m ) [m->size + end_frame_extra] );
+		
+		for ( int i = 0; i < half_width * 2; i++ )
+			out [i] += in [i] * delta + next [i] * delta2;
+	}
+}
+
 void blip_add_delta_fast( blip_t* m, unsigned time, int delta )
 {
 	unsigned fixed = (unsigned) ((time * m->factor + m->offset) >> pre_shift);
@@ -44,6 +44,10 @@ EXPORT void blip_add_delta( blip_t*, unsigned int clock_time, int delta );
 /** Same as blip_add_delta(), but uses faster, lower-quality synthesis. */
 void blip_add_delta_fast( blip_t*, unsigned int clock_time, int delta );
 
+/** Same as calling blip_add_delta() for each of the 'count' deltas, but adds
+them in a single pass with a filter loop that can be vectorized. */
+EXPORT void blip_add_deltas( blip_t*, unsigned int const clock_times [], int const deltas [], int count );
+
 /** Length of time frame, in clocks, needed to make sample_count additional
 samples available. */
 int blip_clocks_needed( const blip_t*, int sample_count );
@@ -67,6 +71,12 @@ interleaving of two buffers into a stereo sample stream. Outputs 16-bit signed
 samples. Returns number of samples actually read.  */
 EXPORT int blip_read_samples( blip_t*, short out [], int count, int stereo );
 
+/** Same as calling blip_read_samples() in stereo mode on both buffers (left
+samples in even elements of 'out', right samples in odd elements), but both
+buffers are integrated in the same pass. Returns number of samples actually
+read from each buffer. */
+EXPORT int blip_read_samples_stereo( blip_t* left, blip_t* right, short out [], int count );
+
 /** Frees buffer. No effect if NULL is passed. */
 EXPORT void blip_delete( blip_t* );
 